@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -29,6 +30,10 @@
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define USE_MIXER_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace Audio {
 
@@ -42,7 +47,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, ResamplerType resampler, int id, bool permanent);
 	~Channel();
 
 	/**
@@ -54,12 +59,13 @@ public:
 	 *             16 bits, for a total of 40 bytes.
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(st_mix_t *data, uint len);
 
 	/**
-	 * Queries whether the channel is still playing or not.
+	 * Queries whether the channel is still playing or not. Only to be
+	 * called from the mixer callback.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && _converterDrained; }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -86,6 +92,23 @@ public:
 	 */
 	bool isPaused() const { return (_pauseLevel != 0); }
 
+	/**
+	 * Queries the effective left/right volumes computed from the channel
+	 * volume, balance and the global sound type settings.
+	 */
+	void getChannelVolumes(st_volume_t &volL, st_volume_t &volR) const { volL = _volL; volR = _volR; }
+
+	/**
+	 * Sets the volumes and pause state used by mix(). Only to be called
+	 * from the mixer callback.
+	 */
+	void setMixState(st_volume_t volL, st_volume_t volR, bool paused) { _mixVolL = volL; _mixVolR = volR; _mixPaused = paused; }
+
+	/**
+	 * Queries whether mix() currently treats the channel as paused.
+	 */
+	bool isMixPaused() const { return _mixPaused; }
+
 	/**
 	 * Sets the channel's own volume.
 	 *
@@ -155,13 +178,34 @@ private:
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
 
+	// The state used by mix(), which is only updated by the mixer callback.
+	st_volume_t _mixVolL, _mixVolR;
+	bool _mixPaused;
+
 	Mixer *_mixer;
 
-	uint32 _samplesConsumed;
+	/**
+	 * Reads the timing published by the last mix() call. Called from
+	 * the engine side.
+	 */
+	void getMixTime(uint32 &samplesConsumed, uint32 &mixerTimeStamp) const;
+
+	// Published by mix() for getElapsedTime(). The sequence number is odd
+	// while mix() updates the values.
+	volatile uint32 _mixTimeSeq;
+	volatile uint32 _samplesConsumed;
+	volatile uint32 _mixerTimeStamp;
 	uint32 _samplesDecoded;
-	uint32 _mixerTimeStamp;
+
+	// Set by mix() once the stream ran out of data and the converter did
+	// not produce a full buffer, i.e. it has no buffered input left.
+	bool _converterDrained;
+
+	// Pause bookkeeping, only touched by the engine side. _pauseTime is
+	// the time spent paused since the mix() call at _pauseTimeStamp.
 	uint32 _pauseStartTime;
 	uint32 _pauseTime;
+	uint32 _pauseTimeStamp;
 
 	DisposeAfterUse::Flag _autofreeStream;
 	RateConverter *_converter;
@@ -172,19 +216,40 @@ private:
 #pragma mark --- Mixer ---
 #pragma mark -
 
+/** The mixer whose mix pass the current thread is running, if any */
+static MIXER_THREAD_LOCAL const MixerImpl *s_mixPassOwner = 0;
 
 MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _syst(system), _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _syst(system), _mutex(), _sampleRate(sampleRate), _resampler(kResamplerLinear), _mixerReady(false), _handleSeed(0), _soundTypeSettings(),
+	  _inMixPass(false), _mixPassCount(0), _mixingChannel(0), _reclaimLater(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	// The "resampler" setting selects the converter used when the rates
+	// differ: "linear" (the default) or the higher quality "sinc".
+	if (ConfMan.get("resampler").equalsIgnoreCase("sinc"))
+		_resampler = kResamplerSinc;
+
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_mixChannels[i] = 0;
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// The backend has stopped calling mixCallback() by now, so we can
+	// take over its side of the queues. Every channel still alive is
+	// either pending in the command queue or owned by the mix side.
+	while (!_commands.empty()) {
+		processCommands();
+		reclaimChannels();
+	}
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		delete _channels[i];
+		delete _mixChannels[i];
+
+	reclaimChannels();
+	delete _reclaimLater;
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -218,6 +283,119 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	postCommand(Command::kCommandPlay, index, chan);
+}
+
+void MixerImpl::postCommand(Command::Type type, int index, Channel *chan) {
+	Command cmd;
+	cmd.type = type;
+	cmd.index = index;
+	cmd.chan = chan;
+	chan->getChannelVolumes(cmd.volL, cmd.volR);
+	cmd.paused = chan->isPaused();
+
+	while (!_commands.push(cmd)) {
+		// The callback drains the queue at the start of every mix pass,
+		// but it is not called while audio is suspended or before the
+		// device has been started. Unless a pass is running right now,
+		// drain the queue in its place.
+		reclaimChannels();
+		if (isMixPassOwner()) {
+			// A stream posted this from inside the mix pass
+			processCommands();
+		} else if (mixerTryAcquire(_inMixPass)) {
+			processCommands();
+			mixerMemoryBarrier();
+			_inMixPass = 0;
+			reclaimChannels();
+		} else {
+			_syst->delayMillis(1);
+		}
+	}
+}
+
+void MixerImpl::removeChannel(int index) {
+	Channel *chan = _channels[index];
+	_channels[index] = 0;
+	postCommand(Command::kCommandStop, index, chan);
+}
+
+void MixerImpl::updateChannel(int index) {
+	postCommand(Command::kCommandUpdate, index, _channels[index]);
+}
+
+void MixerImpl::reclaimChannels() {
+	if (_reclaimLater && _reclaimLater != _mixingChannel) {
+		delete _reclaimLater;
+		_reclaimLater = 0;
+	}
+
+	Channel *chan;
+	while (_retiredChannels.pop(chan)) {
+		// A finished channel is still in our table, a stopped one is not.
+		const int index = chan->getHandle()._val % NUM_CHANNELS;
+		if (_channels[index] == chan)
+			_channels[index] = 0;
+
+		if (chan == _mixingChannel)
+			_reclaimLater = chan;
+		else
+			delete chan;
+	}
+}
+
+bool MixerImpl::isMixPassOwner() const {
+	return s_mixPassOwner == this;
+}
+
+void MixerImpl::waitForMixPass() {
+	// A stream which stops channels from inside the mix pass would wait
+	// for itself. The callback processes the commands as soon as the
+	// stream returns, before it mixes any other channel.
+	if (isMixPassOwner())
+		return;
+
+	// This pairs with the flag updates in mixCallback(). If no mix pass
+	// is running, the next one will process our commands before mixing.
+	// Otherwise we wait for the running pass to end, since it might have
+	// checked the command queue before our commands were posted.
+	mixerMemoryBarrier();
+	const uint32 passCount = _mixPassCount;
+	mixerMemoryBarrier();
+
+	while (_inMixPass && _mixPassCount == passCount)
+		_syst->delayMillis(1);
+}
+
+void MixerImpl::processCommands() {
+	Command cmd;
+
+	// Stopping a channel needs room to hand it back. If the engine side
+	// did not reclaim channels in a while, the remaining commands are
+	// simply left for the next mix pass.
+	while (!_retiredChannels.full() && _commands.pop(cmd)) {
+		switch (cmd.type) {
+		case Command::kCommandPlay:
+			assert(_mixChannels[cmd.index] == 0);
+			_mixChannels[cmd.index] = cmd.chan;
+			cmd.chan->setMixState(cmd.volL, cmd.volR, cmd.paused);
+			break;
+
+		case Command::kCommandStop:
+			// The channel might have finished and been retired already
+			if (_mixChannels[cmd.index] == cmd.chan) {
+				_mixChannels[cmd.index] = 0;
+				_retiredChannels.push(cmd.chan);
+			}
+			break;
+
+		case Command::kCommandUpdate:
+			if (_mixChannels[cmd.index] == cmd.chan)
+				cmd.chan->setMixState(cmd.volL, cmd.volR, cmd.paused);
+			break;
+		}
+	}
 }
 
 void MixerImpl::playStream(
@@ -229,6 +407,7 @@ void MixerImpl::playStream(
 			bool permanent,
 			bool reverseStereo) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 
 	if (stream == 0) {
 		warning("stream is 0");
@@ -259,16 +438,56 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, _resampler, id, permanent);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
 }
 
+void MixerImpl::writeMixBuffer(int16 *buf, uint len) const {
+	const st_mix_t *src = _mixBuffer;
+	uint samples = 2 * len;
+
+#ifdef USE_MIXER_SSE2
+	// packs saturates to the int16 range, which is just the clipping we need
+	for (; samples >= 8; samples -= 8) {
+		const __m128i lo = _mm_loadu_si128((const __m128i *)src);
+		const __m128i hi = _mm_loadu_si128((const __m128i *)(src + 4));
+		__m128i out = _mm_packs_epi32(lo, hi);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		out = _mm_xor_si128(out, _mm_set1_epi16((int16)0x8000));
+#endif
+		_mm_storeu_si128((__m128i *)buf, out);
+		src += 8;
+		buf += 8;
+	}
+#endif
+
+	for (; samples > 0; --samples) {
+		const int16 val = (int16)CLIP<st_mix_t>(*src++, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*buf++ = val ^ 0x8000;
+#else
+		*buf++ = val;
+#endif
+	}
+}
+
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
+	// Announce the pass before looking at the command queue; see
+	// waitForMixPass() for the other half of this handshake. An engine
+	// thread might be processing the queue in our place; this only
+	// happens when the queue overflowed, so just output silence then.
+	if (!mixerTryAcquire(_inMixPass)) {
+		memset(samples, 0, len);
+		return 0;
+	}
+	mixerMemoryBarrier();
+	s_mixPassOwner = this;
+
+	processCommands();
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
@@ -278,66 +497,106 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
-
-	// mix all channels
-	int res = 0, tmp;
+	// Hand finished channels back to the engine side, which destroys
+	// them. Retry next pass if there is no room.
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
-			}
+		if (_mixChannels[i] && _mixChannels[i]->isFinished()) {
+			if (_retiredChannels.push(_mixChannels[i]))
+				_mixChannels[i] = 0;
 		}
 
+	// mix all channels, one bus sized block at a time
+	int res = 0;
+	while (len > 0) {
+		const uint blockLen = MIN<uint>(len, MIX_BLOCK_SIZE);
+		memset(_mixBuffer, 0, 2 * blockLen * sizeof(st_mix_t));
+
+		int blockRes = 0, tmp;
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			if (_mixChannels[i] && !_mixChannels[i]->isMixPaused()) {
+				_mixingChannel = _mixChannels[i];
+				mixerMemoryBarrier();
+				tmp = _mixingChannel->mix(_mixBuffer, blockLen);
+				mixerMemoryBarrier();
+				_mixingChannel = 0;
+
+				if (tmp > blockRes)
+					blockRes = tmp;
+
+				// The stream might have changed other channels
+				processCommands();
+			}
+
+		writeMixBuffer(buf, blockLen);
+		res += blockRes;
+		buf += 2 * blockLen;
+		len -= blockLen;
+	}
+
+	s_mixPassOwner = 0;
+	mixerMemoryBarrier();
+	_mixPassCount = _mixPassCount + 1;
+	mixerMemoryBarrier();
+	_inMixPass = 0;
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	{
+		Common::StackLock lock(_mutex);
+		reclaimChannels();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent())
+				removeChannel(i);
 		}
 	}
+
+	// Without the lock, so that a stream can call us meanwhile
+	waitForMixPass();
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	{
+		Common::StackLock lock(_mutex);
+		reclaimChannels();
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == id)
+				removeChannel(i);
 		}
 	}
+
+	waitForMixPass();
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	{
+		Common::StackLock lock(_mutex);
+		reclaimChannels();
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		// Simply ignore stop requests for handles of sounds that already terminated
+		const int index = handle._val % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+			return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+		removeChannel(index);
+	}
+
+	waitForMixPass();
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= type && type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channels[i] && _channels[i]->getType() == type) {
 			_channels[i]->notifyGlobalVolChange();
+			updateChannel(i);
+		}
 	}
 }
 
@@ -348,12 +607,14 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
 	_channels[index]->setVolume(volume);
+	updateChannel(index);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
@@ -366,12 +627,14 @@ byte MixerImpl::getChannelVolume(SoundHandle handle) {
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
 	_channels[index]->setBalance(balance);
+	updateChannel(index);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
@@ -388,6 +651,7 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -398,18 +662,22 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
+			updateChannel(i);
 		}
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
+			updateChannel(i);
 			return;
 		}
 	}
@@ -417,6 +685,7 @@ void MixerImpl::pauseID(int id, bool paused) {
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 
 	// Simply ignore (un)pause requests for sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
@@ -424,10 +693,12 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 		return;
 
 	_channels[index]->pause(paused);
+	updateChannel(index);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
@@ -436,6 +707,7 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
@@ -444,12 +716,14 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
@@ -469,11 +743,14 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// scaling? See also Player_V2::setMasterVolume
 
 	Common::StackLock lock(_mutex);
+	reclaimChannels();
 	_soundTypeSettings[type].volume = volume;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (_channels[i] && _channels[i]->getType() == type) {
 			_channels[i]->notifyGlobalVolChange();
+			updateChannel(i);
+		}
 	}
 }
 
@@ -489,16 +766,16 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, ResamplerType resampler, int id, bool permanent)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-      _pauseStartTime(0), _pauseTime(0), _autofreeStream(autofreeStream), _converter(0),
+      _balance(0), _mixVolL(0), _mixVolR(0), _mixPaused(false), _pauseLevel(0), _mixTimeSeq(0), _samplesConsumed(0), _mixerTimeStamp(0), _samplesDecoded(0),
+      _converterDrained(false), _pauseStartTime(0), _pauseTime(0), _pauseTimeStamp(0), _autofreeStream(autofreeStream), _converter(0),
       _stream(stream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, resampler);
 }
 
 Channel::~Channel() {
@@ -564,29 +841,53 @@ void Channel::pause(bool paused) {
 		_pauseLevel--;
 
 		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis() - _pauseStartTime);
+			// Pauses before the last mix() call do not count anymore
+			uint32 samplesConsumed, mixerTimeStamp;
+			getMixTime(samplesConsumed, mixerTimeStamp);
+			if (mixerTimeStamp != _pauseTimeStamp) {
+				_pauseTime = 0;
+				_pauseTimeStamp = mixerTimeStamp;
+			}
+			_pauseTime += g_system->getMillis() - _pauseStartTime;
 			_pauseStartTime = 0;
 		}
 	}
 }
 
+void Channel::getMixTime(uint32 &samplesConsumed, uint32 &mixerTimeStamp) const {
+	uint32 seq;
+	do {
+		seq = _mixTimeSeq;
+		mixerMemoryBarrier();
+		samplesConsumed = _samplesConsumed;
+		mixerTimeStamp = _mixerTimeStamp;
+		mixerMemoryBarrier();
+	} while ((seq & 1) || seq != _mixTimeSeq);
+}
+
 Timestamp Channel::getElapsedTime() {
 	const uint32 rate = _mixer->getOutputRate();
 	uint32 delta = 0;
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	uint32 samplesConsumed, mixerTimeStamp;
+	getMixTime(samplesConsumed, mixerTimeStamp);
+	if (mixerTimeStamp == 0)
 		return ts;
 
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis() - _mixerTimeStamp - _pauseTime;
+	if (isPaused()) {
+		// The callback may have mixed once more before it saw the pause
+		if ((int32)(_pauseStartTime - mixerTimeStamp) > 0)
+			delta = _pauseStartTime - mixerTimeStamp;
+	} else {
+		const uint32 pauseTime = (mixerTimeStamp == _pauseTimeStamp) ? _pauseTime : 0;
+		delta = g_system->getMillis() - mixerTimeStamp - pauseTime;
+	}
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -598,20 +899,27 @@ Timestamp Channel::getElapsedTime() {
 	return ts;
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(st_mix_t *data, uint len) {
 	assert(_stream);
 
 	int res = 0;
 
-	if (_stream->endOfData()) {
+	// Converters buffer some input, so keep them flowing after the stream
+	// ran out of data until they cannot fill the buffer anymore.
+	if (_stream->endOfData() && _converterDrained) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
+		_mixTimeSeq = _mixTimeSeq + 1;
+		mixerMemoryBarrier();
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis();
-		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+		mixerMemoryBarrier();
+		_mixTimeSeq = _mixTimeSeq + 1;
+
+		res = _converter->flowToBus(*_stream, data, len, _mixVolL, _mixVolR);
 		_samplesDecoded += res;
+		_converterDrained = _stream->endOfData() && res < (int)len;
 	}
 
 	return res;
@@ -26,9 +26,96 @@
 #include "common/scummsys.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace Audio {
 
+/**
+ * Full memory barrier used by the lock-free queues between engine threads
+ * and the mixer callback.
+ */
+inline void mixerMemoryBarrier() {
+#if defined(__GNUC__)
+	__sync_synchronize();
+#elif defined(_MSC_VER)
+	long barrier;
+	_InterlockedExchange(&barrier, 0);
+#else
+#error No memory barrier implementation available for this compiler
+#endif
+}
+
+/**
+ * Atomically sets the flag and returns whether it was clear before. The
+ * flag is cleared again by a memory barrier followed by a plain store.
+ */
+inline bool mixerTryAcquire(volatile long &flag) {
+#if defined(__GNUC__)
+	return __sync_lock_test_and_set(&flag, 1) == 0;
+#elif defined(_MSC_VER)
+	return _InterlockedExchange(&flag, 1) == 0;
+#else
+#error No atomic exchange implementation available for this compiler
+#endif
+}
+
+/**
+ * Storage class of variables which every thread has its own copy of.
+ */
+#if defined(__GNUC__)
+#define MIXER_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define MIXER_THREAD_LOCAL __declspec(thread)
+#else
+#error No thread local storage available for this compiler
+#endif
+
+/**
+ * Fixed size single producer/single consumer ring buffer.
+ *
+ * One thread may push while another one pops without any locking. If more
+ * than one thread wants to push (or pop), the callers have to serialize
+ * themselves. SIZE must be a power of two.
+ */
+template<class T, uint32 SIZE>
+class MixerRingBuffer {
+public:
+	MixerRingBuffer() : _readPos(0), _writePos(0) {}
+
+	bool empty() const { return _readPos == _writePos; }
+	bool full() const { return _writePos - _readPos == SIZE; }
+
+	bool push(const T &item) {
+		if (full())
+			return false;
+		_items[_writePos & (SIZE - 1)] = item;
+		// Make the item visible before publishing the new write position
+		mixerMemoryBarrier();
+		_writePos = _writePos + 1;
+		return true;
+	}
+
+	bool pop(T &item) {
+		if (empty())
+			return false;
+		mixerMemoryBarrier();
+		item = _items[_readPos & (SIZE - 1)];
+		// Make sure the item is read before the slot is handed back
+		mixerMemoryBarrier();
+		_readPos = _readPos + 1;
+		return true;
+	}
+
+private:
+	T _items[SIZE];
+	volatile uint32 _readPos;
+	volatile uint32 _writePos;
+};
+
 /**
  * The (default) implementation of the ScummVM audio mixing subsystem.
  *
@@ -42,6 +129,12 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * Engine threads never share a lock with mixCallback(). All channel changes
+ * are posted to a lock-free command queue, which the callback drains at the
+ * start of each mix pass. Finished and stopped channels are handed back to
+ * the engine side through a second queue and destroyed there. The engine
+ * side _mutex only serializes the engine threads among themselves.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -51,13 +144,39 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		NUM_COMMANDS = 256,
+		// The callback holds back commands while this queue is full, so
+		// its size only needs to cover a few mix passes worth of churn.
+		NUM_RETIRED = 512,
+		// Number of frames mixed into the bus per step
+		MIX_BLOCK_SIZE = 256
+	};
+
+	/**
+	 * A channel change posted by an engine thread to the mixer callback.
+	 */
+	struct Command {
+		enum Type {
+			kCommandPlay,	///< Start mixing the channel in slot index
+			kCommandStop,	///< Stop mixing the channel and retire it
+			kCommandUpdate	///< Apply new volumes/pause state
+		};
+
+		Type type;
+		int index;
+		Channel *chan;
+		st_volume_t volL, volR;
+		bool paused;
 	};
 
 	OSystem *_syst;
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
+
+	/** Resampler for new channels, read from the config at construction */
+	ResamplerType _resampler;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -69,8 +188,41 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	/** Channels as seen by the engine side; guarded by _mutex. */
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * Channels as seen by the mixer callback. Only touched by whoever
+	 * acquired _inMixPass.
+	 */
+	Channel *_mixChannels[NUM_CHANNELS];
+
+	MixerRingBuffer<Command, NUM_COMMANDS> _commands;
+	MixerRingBuffer<Channel *, NUM_RETIRED> _retiredChannels;
+
+	/**
+	 * Set by the callback for the duration of a mix pass. Engine threads
+	 * acquire it as well to process the command queue themselves when it
+	 * is full, since the callback might not be running at all.
+	 */
+	volatile long _inMixPass;
+	volatile uint32 _mixPassCount;
+
+	/**
+	 * The channel the callback is mixing right now. A stream which stops
+	 * channels from inside the mix pass might make the callback retire
+	 * it early; reclaimChannels() keeps it in _reclaimLater until the
+	 * callback is done with it.
+	 */
+	Channel *volatile _mixingChannel;
+	Channel *_reclaimLater;
+
+	/**
+	 * 32 bit mixing bus; channels are summed up in here without clipping,
+	 * which is only done once when the block is written out.
+	 */
+	st_mix_t _mixBuffer[2 * MIX_BLOCK_SIZE];
 
 public:
 
@@ -122,6 +274,39 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+private:
+	/**
+	 * Posts a command for the mixer callback. If the queue is full, the
+	 * commands are processed right away unless a mix pass is running.
+	 */
+	void postCommand(Command::Type type, int index, Channel *chan);
+
+	/** Removes the channel in the given slot and asks the callback to retire it. */
+	void removeChannel(int index);
+
+	/** Posts the current volume and pause state of a channel. */
+	void updateChannel(int index);
+
+	/** Destroys all channels the mixer callback has handed back. */
+	void reclaimChannels();
+
+	/** Returns whether the calling thread is running a mix pass. */
+	bool isMixPassOwner() const;
+
+	/**
+	 * Waits until the commands posted so far are seen by the callback
+	 * before it touches any stream again. Used after stopping channels,
+	 * since callers may free non-autofreed streams right afterwards.
+	 * Must be called without _mutex held.
+	 */
+	void waitForMixPass();
+
+	/** Drains the command queue; the caller must have acquired _inMixPass. */
+	void processCommands();
+
+	/** Clips the first len frames of the mixing bus into the output. */
+	void writeMixBuffer(int16 *buf, uint len) const;
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
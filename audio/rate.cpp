@@ -35,6 +35,11 @@
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define USE_RATE_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Audio {
 
 
@@ -47,6 +52,70 @@ namespace Audio {
 #define INTERMEDIATE_BUFFER_SIZE 512
 
 
+/**
+ * Adds a scaled sample to the output. That is either a final 16 bit buffer,
+ * in which case the result is clipped, or the 32 bit mixing bus.
+ */
+static inline void mixSample(st_sample_t &a, int b) {
+	clampedAdd(a, b);
+}
+
+static inline void mixSample(st_mix_t &a, int b) {
+	a += b;
+}
+
+#ifdef USE_RATE_SSE2
+
+/**
+ * Scales eight interleaved samples by the matching volumes, with the same
+ * rounding (towards zero) as the scalar code.
+ */
+static inline void scaleSamplesSSE2(__m128i samples, __m128i vol, __m128i &product0, __m128i &product1) {
+	const __m128i productLo = _mm_mullo_epi16(samples, vol);
+	const __m128i productHi = _mm_mulhi_epi16(samples, vol);
+	product0 = _mm_unpacklo_epi16(productLo, productHi);
+	product1 = _mm_unpackhi_epi16(productLo, productHi);
+
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+	product0 = _mm_add_epi32(product0, _mm_and_si128(_mm_srai_epi32(product0, 31), bias));
+	product1 = _mm_add_epi32(product1, _mm_and_si128(_mm_srai_epi32(product1, 31), bias));
+	product0 = _mm_srai_epi32(product0, 8);
+	product1 = _mm_srai_epi32(product1, 8);
+}
+
+/**
+ * Scales eight interleaved samples and adds them to the output.
+ */
+static inline void mixSamplesSSE2(st_mix_t *obuf, __m128i samples, __m128i vol) {
+	__m128i product0, product1;
+	scaleSamplesSSE2(samples, vol, product0, product1);
+
+	__m128i *dst = (__m128i *)obuf;
+	_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), product0));
+	_mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), product1));
+}
+
+static inline void mixSamplesSSE2(st_sample_t *obuf, __m128i samples, __m128i vol) {
+	__m128i product0, product1;
+	scaleSamplesSSE2(samples, vol, product0, product1);
+
+	__m128i *dst = (__m128i *)obuf;
+	_mm_storeu_si128(dst, _mm_adds_epi16(_mm_loadu_si128(dst), _mm_packs_epi32(product0, product1)));
+}
+
+/**
+ * Returns the volumes for eight interleaved output samples.
+ */
+template<bool reverseStereo>
+static inline __m128i makeVolumeSSE2(st_volume_t vol_l, st_volume_t vol_r) {
+	const int16 volFirst = reverseStereo ? vol_r : vol_l;
+	const int16 volSecond = reverseStereo ? vol_l : vol_r;
+	return _mm_setr_epi16(volFirst, volSecond, volFirst, volSecond, volFirst, volSecond, volFirst, volSecond);
+}
+
+#endif
+
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -69,7 +138,14 @@ protected:
 
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowToBus(AudioStream &input, st_mix_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	template<class T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -102,8 +178,9 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<class T>
+int SimpleRateConverter<stereo, reverseStereo>::flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
@@ -134,10 +211,10 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 		opos += opos_inc;
 
 		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		mixSample(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
 		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		mixSample(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
 
 		obuf += 2;
 	}
@@ -175,7 +252,14 @@ protected:
 
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowToBus(AudioStream &input, st_mix_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	template<class T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return ST_SUCCESS;
 	}
@@ -211,8 +295,9 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
+template<class T>
+int LinearRateConverter<stereo, reverseStereo>::flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
@@ -249,10 +334,10 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 						  out0);
 
 			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			mixSample(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
 			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			mixSample(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
 
 			obuf += 2;
 
@@ -267,6 +352,298 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 #pragma mark -
 
 
+/** Number of filter taps of each phase of the sinc converter. */
+#define SINC_TAPS 16
+
+/** Number of polyphase filters, i.e. fractional positions, as power of 2. */
+#define SINC_PHASE_BITS 8
+#define SINC_PHASES (1 << SINC_PHASE_BITS)
+
+/** Fixed point precision of the filter coefficients. */
+#define SINC_COEF_BITS 14
+
+/** Per channel size of the input history of the sinc converter. */
+#define SINC_HISTORY_SIZE (INTERMEDIATE_BUFFER_SIZE + SINC_TAPS)
+
+static inline int convolveSinc(const st_sample_t *hist, const int16 *coefs) {
+	int acc = 1 << (SINC_COEF_BITS - 1);
+	for (int i = 0; i < SINC_TAPS; ++i)
+		acc += hist[i] * coefs[i];
+	return acc >> SINC_COEF_BITS;
+}
+
+#ifdef USE_RATE_SSE2
+
+/** Returns the partial sums of the SINC_TAPS products of one output sample. */
+static inline __m128i convolveSincSSE2(const st_sample_t *hist, const int16 *coefs) {
+	const __m128i lo = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)hist), _mm_loadu_si128((const __m128i *)coefs));
+	const __m128i hi = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(hist + 8)), _mm_loadu_si128((const __m128i *)(coefs + 8)));
+	return _mm_add_epi32(lo, hi);
+}
+
+/** Sums up the lanes of four accumulators, returning one sum per lane. */
+static inline __m128i reduceSincSSE2(__m128i acc0, __m128i acc1, __m128i acc2, __m128i acc3) {
+	const __m128i sum01 = _mm_add_epi32(_mm_unpacklo_epi32(acc0, acc1), _mm_unpackhi_epi32(acc0, acc1));
+	const __m128i sum23 = _mm_add_epi32(_mm_unpacklo_epi32(acc2, acc3), _mm_unpackhi_epi32(acc2, acc3));
+	const __m128i sum = _mm_add_epi32(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+	return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << (SINC_COEF_BITS - 1))), SINC_COEF_BITS);
+}
+
+#endif
+
+/**
+ * Audio rate converter based on windowed sinc interpolation.
+ *
+ * A bank of SINC_PHASES Blackman windowed sinc filters with SINC_TAPS taps
+ * each is computed when the converter is created. Every output sample is
+ * the dot product of the input history with the filter for its fractional
+ * position. This avoids most of the aliasing and the treble loss of linear
+ * interpolation, at the cost of a delay of SINC_TAPS / 2 input samples.
+ *
+ * Limited to sampling frequency <= 65535 Hz.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public RateConverter {
+protected:
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** input history, one buffer per channel */
+	st_sample_t history[stereo ? 2 : 1][SINC_HISTORY_SIZE];
+	int histPos;
+	int histLen;
+
+	/** whether silence was appended to the history at the end of the input */
+	bool tailFlushed;
+
+	/** fractional position of the output stream in input stream unit */
+	frac_t opos;
+
+	/** fractional position increment in the output stream */
+	frac_t opos_inc;
+
+	/** SINC_PHASES filters of SINC_TAPS coefficients each */
+	int16 *coefs;
+
+	bool refill(AudioStream &input);
+
+#ifdef USE_RATE_SSE2
+	template<class T>
+	void flowBlock(T *obuf, __m128i vol);
+#endif
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter() {
+		delete[] coefs;
+	}
+
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowToBus(AudioStream &input, st_mix_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+	template<class T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+/*
+ * Prepare processing.
+ */
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 65536 || outrate >= 65536) {
+		error("rate effect can only handle rates < 65536");
+	}
+
+	opos = 0;
+	opos_inc = (inrate << FRAC_BITS) / outrate;
+
+	// Cut off a bit below the lower of the two Nyquist frequencies, since
+	// the transition band of such a short filter is rather wide.
+	const double cutoff = 0.95 * (outrate < inrate ? (double)outrate / inrate : 1.0);
+
+	coefs = new int16[SINC_PHASES * SINC_TAPS];
+	for (int phase = 0; phase < SINC_PHASES; ++phase) {
+		double filter[SINC_TAPS];
+		double sum = 0;
+
+		for (int i = 0; i < SINC_TAPS; ++i) {
+			// Distance of the tap from the output position. The output
+			// position lies between taps SINC_TAPS / 2 - 1 and SINC_TAPS / 2.
+			const double x = i - (SINC_TAPS / 2 - 1) - (double)phase / SINC_PHASES;
+			const double sinc = (x == 0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+			const double window = 0.42 + 0.5 * cos(2 * M_PI * x / SINC_TAPS) + 0.08 * cos(4 * M_PI * x / SINC_TAPS);
+
+			filter[i] = sinc * window;
+			sum += filter[i];
+		}
+
+		// Normalize every phase to unity gain, so that a constant input
+		// signal results in a constant output signal.
+		for (int i = 0; i < SINC_TAPS; ++i)
+			coefs[phase * SINC_TAPS + i] = (int16)floor(filter[i] / sum * (1 << SINC_COEF_BITS) + 0.5);
+	}
+
+	// Pre-fill the history with silence, so that the first input sample
+	// lies at the output position of phase 0.
+	memset(history, 0, sizeof(history));
+	histPos = 0;
+	histLen = SINC_TAPS / 2 - 1;
+	tailFlushed = false;
+}
+
+/*
+ * Read more input into the history. Returns false at the end of the input.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	// Drop the samples the filter is done with
+	if (histPos >= histLen) {
+		histPos -= histLen;
+		histLen = 0;
+	} else if (histPos > 0) {
+		for (int c = 0; c < (stereo ? 2 : 1); ++c)
+			memmove(history[c], history[c] + histPos, (histLen - histPos) * sizeof(st_sample_t));
+		histLen -= histPos;
+		histPos = 0;
+	}
+
+	const int space = MIN<int>(SINC_HISTORY_SIZE - histLen, ARRAYSIZE(inBuf) / (stereo ? 2 : 1));
+	const int len = input.readBuffer(inBuf, space * (stereo ? 2 : 1));
+	if (len <= 0) {
+		// The last input samples only reach the output position once
+		// SINC_TAPS / 2 more samples follow them. At the end of the
+		// stream, feed that much silence through the filter.
+		if (tailFlushed || !input.endOfStream())
+			return false;
+
+		for (int c = 0; c < (stereo ? 2 : 1); ++c)
+			memset(history[c] + histLen, 0, SINC_TAPS / 2 * sizeof(st_sample_t));
+		histLen += SINC_TAPS / 2;
+		tailFlushed = true;
+		return true;
+	}
+	tailFlushed = false;
+
+	const st_sample_t *inPtr = inBuf;
+	for (int i = 0; i < len; i += (stereo ? 2 : 1)) {
+		history[0][histLen] = *inPtr++;
+		if (stereo)
+			history[stereo ? 1 : 0][histLen] = *inPtr++;
+		histLen++;
+	}
+
+	return true;
+}
+
+#ifdef USE_RATE_SSE2
+
+/*
+ * Mix four output frames with SSE2. The caller makes sure the history holds
+ * all the input these need.
+ */
+template<bool stereo, bool reverseStereo>
+template<class T>
+void SincRateConverter<stereo, reverseStereo>::flowBlock(T *obuf, __m128i vol) {
+	__m128i acc0[4], acc1[4];
+
+	for (int i = 0; i < 4; ++i) {
+		const int16 *filter = coefs + (opos >> (FRAC_BITS - SINC_PHASE_BITS)) * SINC_TAPS;
+
+		acc0[i] = convolveSincSSE2(history[0] + histPos, filter);
+		if (stereo)
+			acc1[i] = convolveSincSSE2(history[stereo ? 1 : 0] + histPos, filter);
+
+		opos += opos_inc;
+		histPos += opos >> FRAC_BITS;
+		opos &= FRAC_LO_MASK;
+	}
+
+	// Four saturated samples per channel in the low half of the registers
+	__m128i out0 = reduceSincSSE2(acc0[0], acc0[1], acc0[2], acc0[3]);
+	out0 = _mm_packs_epi32(out0, out0);
+	__m128i out1 = out0;
+	if (stereo) {
+		out1 = reduceSincSSE2(acc1[0], acc1[1], acc1[2], acc1[3]);
+		out1 = _mm_packs_epi32(out1, out1);
+	}
+
+	// Interleave the channels and mix them
+	const __m128i samples = reverseStereo ? _mm_unpacklo_epi16(out1, out0) : _mm_unpacklo_epi16(out0, out1);
+	mixSamplesSSE2(obuf, samples, vol);
+}
+
+#endif
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+template<class T>
+int SincRateConverter<stereo, reverseStereo>::flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	T *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+#ifdef USE_RATE_SSE2
+	// How far the input position can advance for four output frames
+	const int blockStep = 4 * ((opos_inc >> FRAC_BITS) + 1);
+	const __m128i vol = makeVolumeSSE2<reverseStereo>(vol_l, vol_r);
+#endif
+
+	while (obuf < oend) {
+		// Make sure the filter has all the input it needs
+		if (histPos + SINC_TAPS > histLen) {
+			if (!refill(input))
+				break;
+			continue;
+		}
+
+		// Produce as many output samples as the history allows
+		while (obuf < oend && histPos + SINC_TAPS <= histLen) {
+#if defined(USE_RATE_SSE2) && !defined(OUTPUT_UNSIGNED_AUDIO)
+			if (oend - obuf >= 8 && histPos + blockStep + SINC_TAPS <= histLen) {
+				flowBlock(obuf, vol);
+				obuf += 8;
+				continue;
+			}
+#endif
+
+			const int16 *filter = coefs + (opos >> (FRAC_BITS - SINC_PHASE_BITS)) * SINC_TAPS;
+
+			st_sample_t out0, out1;
+			out0 = (st_sample_t)CLIP<int>(convolveSinc(history[0] + histPos, filter), ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+			out1 = (stereo ?
+			              (st_sample_t)CLIP<int>(convolveSinc(history[stereo ? 1 : 0] + histPos, filter), ST_SAMPLE_MIN, ST_SAMPLE_MAX) :
+			              out0);
+
+			// output left channel
+			mixSample(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+			// output right channel
+			mixSample(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+			obuf += 2;
+
+			// Increment output position
+			opos += opos_inc;
+			histPos += opos >> FRAC_BITS;
+			opos &= FRAC_LO_MASK;
+		}
+	}
+	return (obuf - ostart) / 2;
+}
+
+
+#pragma mark -
+
+
 /**
  * Simple audio rate converter for the case that the inrate equals the outrate.
  */
@@ -281,12 +658,21 @@ public:
 	}
 
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+
+	virtual int flowToBus(AudioStream &input, st_mix_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return flowImpl(input, obuf, osamp, vol_l, vol_r);
+	}
+
+	template<class T>
+	int flowImpl(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
 		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
+		T *ostart = obuf;
 
 		if (stereo)
 			osamp *= 2;
@@ -306,16 +692,39 @@ public:
 
 		// Mix the data into the output buffer
 		ptr = _buffer;
+
+#if defined(USE_RATE_SSE2) && !defined(OUTPUT_UNSIGNED_AUDIO)
+		// Eight output samples per step. For mono input that are four
+		// input samples, which are duplicated into both channels.
+		const __m128i vol = makeVolumeSSE2<reverseStereo>(vol_l, vol_r);
+		for (; len >= (stereo ? 8u : 4u); len -= (stereo ? 8 : 4)) {
+			__m128i samples;
+			if (stereo) {
+				samples = _mm_loadu_si128((const __m128i *)ptr);
+				if (reverseStereo)
+					samples = _mm_shufflehi_epi16(_mm_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+				ptr += 8;
+			} else {
+				samples = _mm_loadl_epi64((const __m128i *)ptr);
+				samples = _mm_unpacklo_epi16(samples, samples);
+				ptr += 4;
+			}
+
+			mixSamplesSSE2(obuf, samples, vol);
+			obuf += 8;
+		}
+#endif
+
 		for (; len > 0; len -= (stereo ? 2 : 1)) {
 			st_sample_t out0, out1;
 			out0 = *ptr++;
 			out1 = (stereo ? *ptr++ : out0);
 
 			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			mixSample(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
 			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			mixSample(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
 
 			obuf += 2;
 		}
@@ -331,9 +740,11 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool sinc) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0) {
+		if (sinc) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -346,14 +757,16 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType resampler) {
+	const bool sinc = (resampler == kResamplerSinc);
+
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, sinc);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, sinc);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, sinc);
 }
 
 } // End of namespace Audio
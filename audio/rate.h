@@ -24,12 +24,14 @@
 #define SOUND_RATE_H
 
 #include "common/scummsys.h"
+#include "common/util.h"
 
 namespace Audio {
 
 class AudioStream;
 
 typedef int16 st_sample_t;
+typedef int32 st_mix_t;
 typedef uint16 st_volume_t;
 typedef uint32 st_size_t;
 typedef uint32 st_rate_t;
@@ -75,10 +77,61 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Like flow(), but adds the samples to a 32 bit mixing bus without
+	 * clipping them. The mixer uses this, so that clipping only happens
+	 * once after all channels have been mixed.
+	 *
+	 * The default implementation goes through flow() and a temporary
+	 * buffer; converters should override it with a direct version.
+	 *
+	 * @return Number of sample pairs added to the buffer.
+	 */
+	virtual int flowToBus(AudioStream &input, st_mix_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		st_sample_t tmp[2 * 256];
+		int res = 0;
+
+		while (osamp > 0) {
+			const st_size_t len = MIN<st_size_t>(osamp, ARRAYSIZE(tmp) / 2);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+			for (st_size_t i = 0; i < len * 2; ++i)
+				tmp[i] = (st_sample_t)0x8000;
+#else
+			memset(tmp, 0, len * 2 * sizeof(st_sample_t));
+#endif
+
+			const int done = flow(input, tmp, len, vol_l, vol_r);
+			for (int i = 0; i < done * 2; ++i) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+				obuf[i] += (st_sample_t)(tmp[i] ^ 0x8000);
+#else
+				obuf[i] += tmp[i];
+#endif
+			}
+
+			res += done;
+			obuf += done * 2;
+			osamp -= len;
+			if (done < (int)len)
+				break;
+		}
+
+		return res;
+	}
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * The converters used when the input and output rates differ. The mixer
+ * picks one according to the "resampler" setting.
+ */
+enum ResamplerType {
+	kResamplerLinear,	///< Linear interpolation
+	kResamplerSinc	///< Windowed sinc filter, higher quality but slower
+};
+
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, ResamplerType resampler = kResamplerLinear);
 
 } // End of namespace Audio
 
@@ -436,7 +436,7 @@ public:
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerType resampler) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0) {
 			if (stereo) {
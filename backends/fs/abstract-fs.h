@@ -158,6 +158,17 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Queries the size and the modification time of the file referred by
+	 * this path, without opening it.
+	 *
+	 * The default implementation returns false, i.e. the information is
+	 * not available.
+	 *
+	 * @return true if the file exists and its information is available
+	 */
+	virtual bool getFileInfo(uint32 &size, uint32 &timestamp) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -51,6 +51,16 @@ void POSIXFilesystemNode::setFlags() {
 	_isDirectory = _isValid ? S_ISDIR(st.st_mode) : false;
 }
 
+bool POSIXFilesystemNode::getFileInfo(uint32 &size, uint32 &timestamp) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	size = (uint32)st.st_size;
+	timestamp = (uint32)st.st_mtime;
+	return true;
+}
+
 POSIXFilesystemNode::POSIXFilesystemNode(const Common::String &p) {
 	assert(p.size() > 0);
 
@@ -0,0 +1,380 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(USE_BENCH_DRIVER)
+
+#include "backends/graphics/bench/bench-graphics.h"
+#include "common/textconsole.h"
+#include "common/translation.h"
+#include "common/util.h"
+#include "graphics/scaler.h"
+
+static const OSystem::GraphicsMode s_benchGraphicsModes[] = {
+	{"1x", _s("Normal (no scaling)"), 0},
+#ifdef USE_SCALERS
+	{"2x", "2x", 1},
+	{"3x", "3x", 2},
+	{"2xsai", "2xSAI", 3},
+	{"super2xsai", "Super2xSAI", 4},
+	{"supereagle", "SuperEagle", 5},
+	{"advmame2x", "AdvMAME2x", 6},
+	{"advmame3x", "AdvMAME3x", 7},
+#ifdef USE_HQ_SCALERS
+	{"hq2x", "HQ2x", 8},
+	{"hq3x", "HQ3x", 9},
+#endif
+	{"tv2x", "TV2x", 10},
+	{"dotmatrix", "DotMatrix", 11},
+#endif
+	{0, 0, 0}
+};
+
+// Scaler procs and factors of the graphics modes, indexed by mode id
+static const struct {
+	ScalerProc *proc;
+	int factor;
+} s_benchScalers[] = {
+	{ Normal1x, 1 },
+#ifdef USE_SCALERS
+	{ Normal2x, 2 },
+	{ Normal3x, 3 },
+	{ _2xSaI, 2 },
+	{ Super2xSaI, 2 },
+	{ SuperEagle, 2 },
+	{ AdvMame2x, 2 },
+	{ AdvMame3x, 3 },
+#ifdef USE_HQ_SCALERS
+	{ HQ2x, 2 },
+	{ HQ3x, 3 },
+#else
+	{ 0, 0 },
+	{ 0, 0 },
+#endif
+	{ TV2x, 2 },
+	{ DotMatrix, 2 },
+#endif
+};
+
+BenchGraphicsManager::BenchGraphicsManager()
+	: _transactionActive(false), _screenChangeCount(0), _overlayVisible(false),
+	_format565(2, 5, 6, 5, 0, 11, 5, 0, 0), _cursorVisible(false), _shakePos(0) {
+
+	_videoState.mode = 0;
+	_videoState.width = 320;
+	_videoState.height = 200;
+	_videoState.format = Graphics::PixelFormat::createFormatCLUT8();
+	_oldVideoState = _videoState;
+
+	memset(_palette, 0, sizeof(_palette));
+	memset(_palette565, 0, sizeof(_palette565));
+
+	InitScalers(565);
+	loadGFXMode();
+}
+
+BenchGraphicsManager::~BenchGraphicsManager() {
+	unloadGFXMode();
+	_cursor.free();
+	DestroyScalers();
+}
+
+bool BenchGraphicsManager::hasFeature(OSystem::Feature f) {
+	return (f == OSystem::kFeatureCursorPalette);
+}
+
+void BenchGraphicsManager::setFeatureState(OSystem::Feature f, bool enable) {
+}
+
+bool BenchGraphicsManager::getFeatureState(OSystem::Feature f) {
+	return false;
+}
+
+const OSystem::GraphicsMode *BenchGraphicsManager::getSupportedGraphicsModes() const {
+	return s_benchGraphicsModes;
+}
+
+int BenchGraphicsManager::getDefaultGraphicsMode() const {
+	return 0;
+}
+
+bool BenchGraphicsManager::setGraphicsMode(int mode) {
+	if (mode < 0 || mode >= ARRAYSIZE(s_benchScalers) || !s_benchScalers[mode].proc) {
+		warning("BenchGraphicsManager::setGraphicsMode: unknown mode %d", mode);
+		return false;
+	}
+
+	_videoState.mode = mode;
+	if (!_transactionActive)
+		loadGFXMode();
+	return true;
+}
+
+void BenchGraphicsManager::resetGraphicsScale() {
+	setGraphicsMode(0);
+}
+
+int BenchGraphicsManager::getGraphicsMode() const {
+	return _videoState.mode;
+}
+
+#ifdef USE_RGB_COLOR
+Graphics::PixelFormat BenchGraphicsManager::getScreenFormat() const {
+	return _screen.format;
+}
+
+Common::List<Graphics::PixelFormat> BenchGraphicsManager::getSupportedFormats() const {
+	Common::List<Graphics::PixelFormat> list;
+	list.push_back(_format565);
+	list.push_back(Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
+	list.push_back(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+	list.push_back(Graphics::PixelFormat::createFormatCLUT8());
+	return list;
+}
+#endif
+
+void BenchGraphicsManager::initSize(uint width, uint height, const Graphics::PixelFormat *format) {
+	_videoState.width = width;
+	_videoState.height = height;
+	_videoState.format = format ? *format : Graphics::PixelFormat::createFormatCLUT8();
+
+	if (!_transactionActive)
+		loadGFXMode();
+}
+
+void BenchGraphicsManager::beginGFXTransaction() {
+	assert(!_transactionActive);
+	_transactionActive = true;
+	_oldVideoState = _videoState;
+}
+
+OSystem::TransactionError BenchGraphicsManager::endGFXTransaction() {
+	assert(_transactionActive);
+	_transactionActive = false;
+
+	int errors = OSystem::kTransactionSuccess;
+
+	const int bytesPerPixel = _videoState.format.bytesPerPixel;
+	if (bytesPerPixel != 1 && bytesPerPixel != 2 && bytesPerPixel != 4) {
+		errors |= OSystem::kTransactionFormatNotSupported;
+		_videoState.format = _oldVideoState.format;
+	}
+
+	if (_videoState.mode != _oldVideoState.mode || _videoState.width != _oldVideoState.width ||
+	    _videoState.height != _oldVideoState.height || _videoState.format != _oldVideoState.format)
+		loadGFXMode();
+
+	return (OSystem::TransactionError)errors;
+}
+
+void BenchGraphicsManager::loadGFXMode() {
+	unloadGFXMode();
+
+	const int factor = s_benchScalers[_videoState.mode].factor;
+	const uint width = _videoState.width, height = _videoState.height;
+
+	_screen.create(width, height, _videoState.format);
+	_overlay.create(width * factor, height * factor, _format565);
+
+	// The scalers read one pixel left of and above each source pixel,
+	// and two pixels right of and below it.
+	_source.create(width + 3, height + 3, _format565);
+	_output.create(width * factor, height * factor, _format565);
+
+	_screenChangeCount++;
+}
+
+void BenchGraphicsManager::unloadGFXMode() {
+	_screen.free();
+	_overlay.free();
+	_source.free();
+	_output.free();
+}
+
+int16 BenchGraphicsManager::getHeight() {
+	return _screen.h;
+}
+
+int16 BenchGraphicsManager::getWidth() {
+	return _screen.w;
+}
+
+void BenchGraphicsManager::setPalette(const byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(_palette + 3 * start, colors, 3 * num);
+
+	for (uint i = start; i < start + num; ++i, colors += 3)
+		_palette565[i] = (uint16)_format565.RGBToColor(colors[0], colors[1], colors[2]);
+}
+
+void BenchGraphicsManager::grabPalette(byte *colors, uint start, uint num) {
+	assert(start + num <= 256);
+	memcpy(colors, _palette + 3 * start, 3 * num);
+}
+
+void BenchGraphicsManager::copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {
+	assert(x >= 0 && x + w <= _screen.w);
+	assert(y >= 0 && y + h <= _screen.h);
+
+	const int lineSize = w * _screen.format.bytesPerPixel;
+	byte *dst = (byte *)_screen.getBasePtr(x, y);
+	for (int i = 0; i < h; ++i, buf += pitch, dst += _screen.pitch)
+		memcpy(dst, buf, lineSize);
+}
+
+Graphics::Surface *BenchGraphicsManager::lockScreen() {
+	return &_screen;
+}
+
+void BenchGraphicsManager::unlockScreen() {
+}
+
+void BenchGraphicsManager::fillScreen(uint32 col) {
+	_screen.fillRect(Common::Rect(_screen.w, _screen.h), col);
+}
+
+void BenchGraphicsManager::convertScreen() {
+	const int width = _screen.w;
+
+	for (int y = 0; y < _screen.h; ++y) {
+		const byte *src = (const byte *)_screen.getBasePtr(0, y);
+		uint16 *dst = (uint16 *)_source.getBasePtr(1, y + 1);
+
+		if (_screen.format.bytesPerPixel == 1) {
+			for (int x = 0; x < width; ++x)
+				dst[x] = _palette565[src[x]];
+		} else if (_screen.format == _format565) {
+			memcpy(dst, src, width * 2);
+		} else {
+			for (int x = 0; x < width; ++x) {
+				uint32 color;
+				if (_screen.format.bytesPerPixel == 2)
+					color = ((const uint16 *)src)[x];
+				else
+					color = ((const uint32 *)src)[x];
+
+				uint8 r, g, b;
+				_screen.format.colorToRGB(color, r, g, b);
+				dst[x] = (uint16)_format565.RGBToColor(r, g, b);
+			}
+		}
+	}
+}
+
+void BenchGraphicsManager::updateScreen() {
+	if (_overlayVisible) {
+		_output.copyFrom(_overlay);
+		return;
+	}
+
+	convertScreen();
+	s_benchScalers[_videoState.mode].proc((const uint8 *)_source.getBasePtr(1, 1), _source.pitch,
+		(uint8 *)_output.pixels, _output.pitch, _screen.w, _screen.h);
+}
+
+void BenchGraphicsManager::setShakePos(int shakeOffset) {
+	_shakePos = shakeOffset;
+}
+
+void BenchGraphicsManager::showOverlay() {
+	_overlayVisible = true;
+}
+
+void BenchGraphicsManager::hideOverlay() {
+	_overlayVisible = false;
+}
+
+Graphics::PixelFormat BenchGraphicsManager::getOverlayFormat() const {
+	return _format565;
+}
+
+void BenchGraphicsManager::clearOverlay() {
+	// Like the SDL backend, start out with the current game screen
+	convertScreen();
+
+	for (int y = 0; y < _overlay.h; ++y) {
+		const int factor = s_benchScalers[_videoState.mode].factor;
+		const uint16 *src = (const uint16 *)_source.getBasePtr(1, y / factor + 1);
+		uint16 *dst = (uint16 *)_overlay.getBasePtr(0, y);
+		for (int x = 0; x < _overlay.w; ++x)
+			dst[x] = src[x / factor];
+	}
+}
+
+void BenchGraphicsManager::grabOverlay(OverlayColor *buf, int pitch) {
+	const byte *src = (const byte *)_overlay.pixels;
+	for (int y = 0; y < _overlay.h; ++y, src += _overlay.pitch, buf += pitch)
+		memcpy(buf, src, _overlay.w * sizeof(OverlayColor));
+}
+
+void BenchGraphicsManager::copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {
+	// Clip the coordinates, the GUI relies on the backend to do that
+	if (x < 0) {
+		w += x;
+		buf -= x;
+		x = 0;
+	}
+
+	if (y < 0) {
+		h += y;
+		buf -= y * pitch;
+		y = 0;
+	}
+
+	w = MIN<int>(w, _overlay.w - x);
+	h = MIN<int>(h, _overlay.h - y);
+	if (w <= 0 || h <= 0)
+		return;
+
+	byte *dst = (byte *)_overlay.getBasePtr(x, y);
+	for (int i = 0; i < h; ++i, buf += pitch, dst += _overlay.pitch)
+		memcpy(dst, buf, w * sizeof(OverlayColor));
+}
+
+int16 BenchGraphicsManager::getOverlayHeight() {
+	return _overlay.h;
+}
+
+int16 BenchGraphicsManager::getOverlayWidth() {
+	return _overlay.w;
+}
+
+bool BenchGraphicsManager::showMouse(bool visible) {
+	const bool last = _cursorVisible;
+	_cursorVisible = visible;
+	return last;
+}
+
+void BenchGraphicsManager::warpMouse(int x, int y) {
+	_mousePos = Common::Point(x, y);
+}
+
+void BenchGraphicsManager::setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale, const Graphics::PixelFormat *format) {
+	_cursor.create(w, h, format ? *format : Graphics::PixelFormat::createFormatCLUT8());
+	memcpy(_cursor.pixels, buf, h * _cursor.pitch);
+}
+
+void BenchGraphicsManager::setCursorPalette(const byte *colors, uint start, uint num) {
+}
+
+#endif
@@ -0,0 +1,138 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_BENCH_H
+#define BACKENDS_GRAPHICS_BENCH_H
+
+#include "backends/graphics/graphics.h"
+#include "common/rect.h"
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+
+/**
+ * Graphics manager for the headless bench backend.
+ *
+ * The game screen, the overlay and the cursor only live in memory.
+ * updateScreen() does the same work as the SDL backend does for a full
+ * redraw: it converts the game screen (or the overlay) to RGB565 and
+ * runs the selected graphics mode over it. The result is never shown,
+ * but can be inspected through getOutput().
+ */
+class BenchGraphicsManager : public GraphicsManager {
+public:
+	BenchGraphicsManager();
+	virtual ~BenchGraphicsManager();
+
+	virtual bool hasFeature(OSystem::Feature f);
+	virtual void setFeatureState(OSystem::Feature f, bool enable);
+	virtual bool getFeatureState(OSystem::Feature f);
+
+	virtual const OSystem::GraphicsMode *getSupportedGraphicsModes() const;
+	virtual int getDefaultGraphicsMode() const;
+	virtual bool setGraphicsMode(int mode);
+	virtual void resetGraphicsScale();
+	virtual int getGraphicsMode() const;
+#ifdef USE_RGB_COLOR
+	virtual Graphics::PixelFormat getScreenFormat() const;
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const;
+#endif
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL);
+	virtual int getScreenChangeID() const { return _screenChangeCount; }
+
+	virtual void beginGFXTransaction();
+	virtual OSystem::TransactionError endGFXTransaction();
+
+	virtual int16 getHeight();
+	virtual int16 getWidth();
+	virtual void setPalette(const byte *colors, uint start, uint num);
+	virtual void grabPalette(byte *colors, uint start, uint num);
+	virtual void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h);
+	virtual Graphics::Surface *lockScreen();
+	virtual void unlockScreen();
+	virtual void fillScreen(uint32 col);
+	virtual void updateScreen();
+	virtual void setShakePos(int shakeOffset);
+	virtual void setFocusRectangle(const Common::Rect& rect) {}
+	virtual void clearFocusRectangle() {}
+
+	virtual void showOverlay();
+	virtual void hideOverlay();
+	virtual Graphics::PixelFormat getOverlayFormat() const;
+	virtual void clearOverlay();
+	virtual void grabOverlay(OverlayColor *buf, int pitch);
+	virtual void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h);
+	virtual int16 getOverlayHeight();
+	virtual int16 getOverlayWidth();
+
+	virtual bool showMouse(bool visible);
+	virtual void warpMouse(int x, int y);
+	virtual void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale = 1, const Graphics::PixelFormat *format = NULL);
+	virtual void setCursorPalette(const byte *colors, uint start, uint num);
+
+	/**
+	 * Returns the RGB565 frame produced by the last call to
+	 * updateScreen(). It is empty until the first update.
+	 */
+	const Graphics::Surface &getOutput() const { return _output; }
+
+	/** Returns the current mouse position, in game screen coordinates. */
+	Common::Point getMousePosition() const { return _mousePos; }
+
+private:
+	struct VideoState {
+		int mode;
+		uint width, height;
+		Graphics::PixelFormat format;
+	};
+
+	void loadGFXMode();
+	void unloadGFXMode();
+
+	/**
+	 * Converts the game screen into the RGB565 source buffer of the
+	 * scaler, using the current palette for CLUT8 screens.
+	 */
+	void convertScreen();
+
+	VideoState _videoState, _oldVideoState;
+	bool _transactionActive;
+	int _screenChangeCount;
+
+	Graphics::Surface _screen;
+	Graphics::Surface _overlay;
+	bool _overlayVisible;
+
+	/** RGB565 copy of the visible screen, with a border around it for the scalers. */
+	Graphics::Surface _source;
+	Graphics::Surface _output;
+
+	byte _palette[3 * 256];
+	uint16 _palette565[256];
+	Graphics::PixelFormat _format565;
+
+	Graphics::Surface _cursor;
+	bool _cursorVisible;
+	Common::Point _mousePos;
+	int _shakePos;
+};
+
+#endif
@@ -319,6 +319,9 @@ void GPHGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	// Merge the dirty tiles into the list of rects to scale
+	buildDirtyRectList();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -331,6 +331,9 @@ void LinuxmotoSdlGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	// Merge the dirty tiles into the list of rects to scale
+	buildDirtyRectList();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
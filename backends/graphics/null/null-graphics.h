@@ -27,7 +27,7 @@
 
 static const OSystem::GraphicsMode s_noGraphicsModes[] = { {0, 0, 0} };
 
-class NullGraphicsManager : GraphicsManager {
+class NullGraphicsManager : public GraphicsManager {
 public:
 	virtual ~NullGraphicsManager() {}
 
@@ -39,6 +39,7 @@ public:
 	int getDefaultGraphicsMode() const { return 0; }
 	bool setGraphicsMode(int mode) { return true; }
 	int getGraphicsMode() const { return 0; }
+	void resetGraphicsScale() {}
 	inline Graphics::PixelFormat getScreenFormat() const {
 		return Graphics::PixelFormat::createFormatCLUT8();
 	}
@@ -25,9 +25,11 @@
 #if defined(SDL_BACKEND)
 
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerthreads.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -100,6 +102,13 @@ AspectRatio::AspectRatio(int w, int h) {
 }
 
 #if !defined(_WIN32_WCE) && !defined(__SYMBIAN32__) && defined(USE_SCALERS)
+static void setSdlRect(SDL_Rect &r, int x, int y, int w, int h) {
+	r.x = x;
+	r.y = y;
+	r.w = w;
+	r.h = h;
+}
+
 static AspectRatio getDesiredAspectRatio() {
 	const size_t AR_COUNT = 4;
 	const char *desiredAspectRatioAsStrings[AR_COUNT] = {	"auto",				"4/3",				"16/9",				"16/10" };
@@ -139,7 +148,9 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_currentShakePos(0), _newShakePos(0),
 	_paletteDirtyStart(0), _paletteDirtyEnd(0),
 	_screenIsLocked(false),
-	_graphicsMutex(0),
+	_dirtyTiles(0), _dirtyTilesWidth(0), _dirtyTilesHeight(0), _hasDirtyTiles(false),
+	_statsPixels(0), _statsFrames(0),
+	_graphicsMutex(0), _scalerThreads(0),
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	_enableFocusRectDebugCode(false), _enableFocusRect(false), _focusRect(),
 #endif
@@ -163,6 +174,9 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 
 	_graphicsMutex = g_system->createMutex();
 
+	if (ConfMan.getBool("threaded_scaler"))
+		_scalerThreads = new SdlScalerThreadPool(ConfMan.getInt("scaler_threads"));
+
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	if (ConfMan.hasKey("use_sdl_debug_focusrect"))
 		_enableFocusRectDebugCode = ConfMan.getBool("use_sdl_debug_focusrect");
@@ -208,10 +222,12 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 		SDL_FreeSurface(_mouseOrigSurface);
 	_mouseOrigSurface = 0;
 	g_system->deleteMutex(_graphicsMutex);
+	delete _scalerThreads;
 
 	free(_currentPalette);
 	free(_cursorPalette);
 	free(_mouseData);
+	free(_dirtyTiles);
 }
 
 void SurfaceSdlGraphicsManager::initEventObserver() {
@@ -1035,6 +1051,9 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	// Merge the dirty tiles into the list of rects to scale
+	buildDirtyRectList();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -1084,8 +1103,14 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				if (_scalerThreads)
+					_scalerThreads->scale(scalerProc, scale1, (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				else
+					scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+						(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+
+				_statsPixels += r->w * dst_h;
 			}
 
 			r->x = rx1;
@@ -1190,6 +1215,13 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 		// Finally, blit all our changes to the screen
 		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
+
+		if (++_statsFrames == 300) {
+			debug(2, "SDL: %d pixels scaled per frame on average (%d%% of the screen)",
+				_statsPixels / _statsFrames, _statsPixels / _statsFrames * 100 / (width * height));
+			_statsPixels = 0;
+			_statsFrames = 0;
+		}
 	}
 
 	_numDirtyRects = 0;
@@ -1376,24 +1408,202 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		h = height - y;
 	}
 
-#ifdef USE_SCALERS
-	if (_videoMode.aspectRatioCorrection && !_overlayVisible && !realCoordinates) {
-		makeRectStretchable(x, y, w, h);
-	}
-#endif
-
 	if (w == width && h == height) {
 		_forceFull = true;
 		return;
 	}
 
-	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+	if (w <= 0 || h <= 0)
+		return;
+
+	// Rects in virtual coordinates are scaled later on, so they only mark
+	// tiles which buildDirtyRectList() merges. Rects in real coordinates
+	// (the mouse cursor, drawn after scaling) go straight into the list.
+	if (!realCoordinates) {
+		markDirtyTiles(x, y, w, h, width, height);
+		return;
+	}
+
+	SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+
+	r->x = x;
+	r->y = y;
+	r->w = w;
+	r->h = h;
+}
+
+void SurfaceSdlGraphicsManager::markDirtyTiles(int x, int y, int w, int h, int width, int height) {
+	const int tilesWidth = (width + (1 << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+	const int tilesHeight = (height + (1 << DIRTY_TILE_SHIFT) - 1) >> DIRTY_TILE_SHIFT;
+
+	if (tilesWidth != _dirtyTilesWidth || tilesHeight != _dirtyTilesHeight) {
+		free(_dirtyTiles);
+		_dirtyTiles = (byte *)calloc(tilesWidth * tilesHeight, 1);
+		_dirtyTilesWidth = tilesWidth;
+		_dirtyTilesHeight = tilesHeight;
+	}
+
+	const int x1 = x >> DIRTY_TILE_SHIFT;
+	const int x2 = (x + w - 1) >> DIRTY_TILE_SHIFT;
+	const int y1 = y >> DIRTY_TILE_SHIFT;
+	const int y2 = (y + h - 1) >> DIRTY_TILE_SHIFT;
+
+	for (int ty = y1; ty <= y2; ++ty)
+		memset(_dirtyTiles + ty * _dirtyTilesWidth + x1, 1, x2 - x1 + 1);
+
+	const Common::Rect rect(x, y, x + w, y + h);
+	if (_hasDirtyTiles)
+		_dirtyTilesBounds.extend(rect);
+	else
+		_dirtyTilesBounds = rect;
+
+	_hasDirtyTiles = true;
+}
+
+void SurfaceSdlGraphicsManager::buildDirtyRectList() {
+	if (!_hasDirtyTiles)
+		return;
+
+	_hasDirtyTiles = false;
 
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+	if (_forceFull) {
+		memset(_dirtyTiles, 0, _dirtyTilesWidth * _dirtyTilesHeight);
+		return;
+	}
+
+	// Any rects already in the list (from undrawMouse()) are left alone.
+	const int firstRect = _numDirtyRects;
+	const int height = _overlayVisible ? _videoMode.overlayHeight : _videoMode.screenHeight;
+
+	const int lastRow = (_dirtyTilesBounds.bottom - 1) >> DIRTY_TILE_SHIFT;
+	for (int ty = _dirtyTilesBounds.top >> DIRTY_TILE_SHIFT; ty <= lastRow; ++ty) {
+		byte *row = _dirtyTiles + ty * _dirtyTilesWidth;
+		int tx = 0;
+
+		while (tx < _dirtyTilesWidth) {
+			if (!row[tx]) {
+				++tx;
+				continue;
+			}
+
+			// Each run of dirty tiles in a row becomes one span
+			const int start = tx;
+			while (tx < _dirtyTilesWidth && row[tx])
+				row[tx++] = 0;
+
+			const int x = MAX<int>(start << DIRTY_TILE_SHIFT, _dirtyTilesBounds.left);
+			const int w = MIN<int>(tx << DIRTY_TILE_SHIFT, _dirtyTilesBounds.right) - x;
+			int y = MAX<int>(ty << DIRTY_TILE_SHIFT, _dirtyTilesBounds.top);
+			int h = MIN<int>((ty + 1) << DIRTY_TILE_SHIFT, _dirtyTilesBounds.bottom) - y;
+
+			// Clipping can leave a single row where a rect just reaches
+			// into this tile row, but some scalers need at least two. Add
+			// a row outside the bounds, which no other span covers.
+			if (h < 2) {
+				if (y + h == _dirtyTilesBounds.bottom && y + h < height) {
+					h++;
+				} else if (y > 0) {
+					y--;
+					h++;
+				}
+			}
+
+			// Extend a span of the row above if it has the same extent
+			SDL_Rect *r = _dirtyRectList + firstRect;
+			SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
+			while (r != lastRect && !(r->x == x && r->w == w && r->y + r->h == y))
+				++r;
+
+			if (r != lastRect) {
+				r->h += h;
+				continue;
+			}
+
+			if (_numDirtyRects == NUM_DIRTY_RECT) {
+				memset(_dirtyTiles, 0, _dirtyTilesWidth * _dirtyTilesHeight);
+				_forceFull = true;
+				return;
+			}
+
+			r->x = x;
+			r->y = y;
+			r->w = w;
+			r->h = h;
+			++_numDirtyRects;
+		}
+	}
+
+#ifdef USE_SCALERS
+	if (_videoMode.aspectRatioCorrection && !_overlayVisible) {
+		for (SDL_Rect *r = _dirtyRectList + firstRect; r != _dirtyRectList + _numDirtyRects; ++r) {
+			int x = r->x, y = r->y, w = r->w, h = r->h;
+			makeRectStretchable(x, y, w, h);
+
+			// Stretching interpolates between neighbouring rows, except
+			// at every fifth row. Start and end the rect on such rows, so
+			// that none of its stretched lines depends on rows outside it.
+			const int bottom = MIN<int>((y + h + 4) / 5 * 5, _videoMode.screenHeight);
+			y = y / 5 * 5;
+			h = bottom - y;
+
+			r->x = x;
+			r->y = y;
+			r->w = w;
+			r->h = h;
+		}
+
+		// The aligned rects reach into the tile rows around them, where
+		// they can overlap the spans of those rows
+		removeDirtyRectOverlaps(firstRect);
+	}
+#endif
+}
+
+/**
+ * Cuts the parts which an earlier rect covers off the rects from firstRect
+ * on, so that no pixel is scaled twice. What is left of a rect takes up to
+ * four rects. Their edges are edges of the original rects, so they stay
+ * aligned like those. If the list has no room for them, the overlap stays.
+ */
+void SurfaceSdlGraphicsManager::removeDirtyRectOverlaps(int firstRect) {
+	for (int j = firstRect + 1; j < _numDirtyRects; ++j) {
+		for (int i = firstRect; i < j; ++i) {
+			const SDL_Rect a = _dirtyRectList[i];
+			const SDL_Rect b = _dirtyRectList[j];
+
+			const int top = MAX<int>(a.y, b.y);
+			const int bottom = MIN<int>(a.y + a.h, b.y + b.h);
+			const int left = MAX<int>(a.x, b.x);
+			const int right = MIN<int>(a.x + a.w, b.x + b.w);
+			if (top >= bottom || left >= right)
+				continue;
+
+			// The parts of b above and below a, and left and right of it
+			SDL_Rect parts[4];
+			int numParts = 0;
+			if (b.y < top)
+				setSdlRect(parts[numParts++], b.x, b.y, b.w, top - b.y);
+			if (bottom < b.y + b.h)
+				setSdlRect(parts[numParts++], b.x, bottom, b.w, b.y + b.h - bottom);
+			if (b.x < left)
+				setSdlRect(parts[numParts++], b.x, top, left - b.x, bottom - top);
+			if (right < b.x + b.w)
+				setSdlRect(parts[numParts++], right, top, b.x + b.w - right, bottom - top);
+
+			if (numParts == 0) {
+				// Check the last rect in its place next
+				_dirtyRectList[j--] = _dirtyRectList[--_numDirtyRects];
+				break;
+			}
+
+			if (_numDirtyRects + numParts - 1 > NUM_DIRTY_RECT)
+				continue;
+
+			// The parts are checked against the remaining earlier rects
+			_dirtyRectList[j] = parts[0];
+			for (int p = 1; p < numParts; ++p)
+				_dirtyRectList[_numDirtyRects++] = parts[p];
+		}
 	}
 }
 
@@ -33,6 +33,8 @@
 
 #include "backends/platform/sdl/sdl-sys.h"
 
+class SdlScalerThreadPool;
+
 #ifndef RELEASE_BUILD
 // Define this to allow for focus rectangle debugging
 #define USE_SDL_DEBUG_FOCUSRECT
@@ -235,13 +237,35 @@ protected:
 
 	enum {
 		NUM_DIRTY_RECT = 100,
-		MAX_SCALING = 3
+		MAX_SCALING = 3,
+		DIRTY_TILE_SHIFT = 4
 	};
 
 	// Dirty rect management
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	/**
+	 * Bitmap of dirty 16x16 tiles (one byte each) of the game screen resp.
+	 * the overlay. addDirtyRect() marks the tiles, and buildDirtyRectList()
+	 * merges them into _dirtyRectList right before scaling, so that no
+	 * pixel gets scaled twice even if it was updated many times.
+	 * _dirtyTilesBounds is the exact bounding box of the marked rects, which
+	 * the merged rects are clipped to, so that a single small update (like
+	 * the mouse cursor) is not rounded up to whole tiles.
+	 */
+	byte *_dirtyTiles;
+	int _dirtyTilesWidth, _dirtyTilesHeight;
+	bool _hasDirtyTiles;
+	Common::Rect _dirtyTilesBounds;
+
+	/**
+	 * Pixels scaled by internUpdateScreen() and frames it drew since the
+	 * last report. The average is printed at debug level 2.
+	 */
+	uint32 _statsPixels;
+	uint32 _statsFrames;
+
 	struct MousePos {
 		// The mouse position, using either virtual (game) or real
 		// (overlay) coordinates.
@@ -302,6 +326,9 @@ protected:
 	 */
 	OSystem::MutexRef _graphicsMutex;
 
+	/** Threads used for scaling, if enabled via the "threaded_scaler" option */
+	SdlScalerThreadPool *_scalerThreads;
+
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	bool _enableFocusRectDebugCode;
 	bool _enableFocusRect;
@@ -309,6 +336,9 @@ protected:
 #endif
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool realCoordinates = false);
+	void markDirtyTiles(int x, int y, int w, int h, int width, int height);
+	void buildDirtyRectList();
+	void removeDirtyRectOverlaps(int firstRect);
 
 	virtual void drawMouse();
 	virtual void undrawMouse();
@@ -0,0 +1,136 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerthreads.h"
+#include "common/util.h"
+
+SdlScalerThreadPool::SdlScalerThreadPool(int numThreads)
+	:
+	_numThreads(CLIP(numThreads, 1, (int)MAX_THREADS)),
+	_scalerProc(0), _scaleFactor(1), _srcPtr(0), _srcPitch(0), _dstPtr(0), _dstPitch(0),
+	_width(0), _height(0), _numBands(0), _nextBand(0), _bandsLeft(0) {
+
+	// The first "thread" is the one calling scale()
+	_numThreads = 1 + _threads.start(workerThreadProc, this, _numThreads - 1);
+}
+
+SdlScalerThreadPool::~SdlScalerThreadPool() {
+	_threads.stop();
+}
+
+bool SdlScalerThreadPool::isReentrant(ScalerProc *scalerProc) {
+#if defined(USE_NASM) && defined(USE_HQ_SCALERS)
+	// The NASM versions of the HQ scalers keep their state in global
+	// variables.
+	if (scalerProc == HQ2x || scalerProc == HQ3x)
+		return false;
+#endif
+	return true;
+}
+
+void SdlScalerThreadPool::scale(ScalerProc *scalerProc, int scaleFactor, const uint8 *srcPtr, uint32 srcPitch,
+                                uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	const int numBands = MIN(_numThreads, height / MIN_BAND_HEIGHT);
+
+	if (numBands < 2 || !isReentrant(scalerProc)) {
+		scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	_threads.lock();
+	_scalerProc = scalerProc;
+	_scaleFactor = scaleFactor;
+	_srcPtr = srcPtr;
+	_srcPitch = srcPitch;
+	_dstPtr = dstPtr;
+	_dstPitch = dstPitch;
+	_width = width;
+	_height = height;
+	_numBands = numBands;
+	_nextBand = 0;
+	_bandsLeft = numBands;
+	_threads.unlock();
+	_threads.wakeUp();
+
+	runBands();
+
+	_threads.lock();
+	while (_bandsLeft > 0)
+		_threads.waitForThreads();
+	_threads.unlock();
+}
+
+void SdlScalerThreadPool::runBands() {
+	while (true) {
+		_threads.lock();
+		if (_nextBand >= _numBands) {
+			_threads.unlock();
+			return;
+		}
+
+		const int band = _nextBand++;
+		const int numBands = _numBands;
+		ScalerProc *scalerProc = _scalerProc;
+		_threads.unlock();
+
+		// Bands start on even rows, since TV2x and DotMatrix output
+		// alternates with every source row.
+		const int y1 = (band * _height / numBands) & ~1;
+		const int y2 = (band + 1 == numBands) ? _height : (((band + 1) * _height / numBands) & ~1);
+
+		scalerProc(_srcPtr + y1 * _srcPitch, _srcPitch,
+			_dstPtr + y1 * _scaleFactor * _dstPitch, _dstPitch, _width, y2 - y1);
+
+		_threads.lock();
+		const bool done = (--_bandsLeft == 0);
+		_threads.unlock();
+
+		if (done)
+			_threads.notify();
+	}
+}
+
+void SdlScalerThreadPool::workerThread() {
+	_threads.lock();
+	while (true) {
+		if (_nextBand < _numBands) {
+			_threads.unlock();
+			runBands();
+			_threads.lock();
+		} else if (!_threads.wait()) {
+			break;
+		}
+	}
+	_threads.unlock();
+}
+
+void SdlScalerThreadPool::workerThreadProc(void *param) {
+	SdlScalerThreadPool *pool = (SdlScalerThreadPool *)param;
+	assert(pool);
+	pool->workerThread();
+}
+
+#endif
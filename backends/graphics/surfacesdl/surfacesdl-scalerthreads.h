@@ -0,0 +1,94 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERTHREADS_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERTHREADS_H
+
+#include "backends/threads/sdl/sdl-threads.h"
+#include "graphics/scaler.h"
+
+/**
+ * Small pool of persistent threads, which scale a rect in horizontal bands.
+ *
+ * The scalers only read from the source surface and only write the
+ * destination rows belonging to the source rows they are passed. The
+ * neighbourhood scalers (2xSaI, AdvMame, HQ) additionally read the source
+ * rows right above and below. These guard rows are simply shared read-only
+ * by the adjacent bands, so the result is identical to scaling the whole
+ * rect at once.
+ */
+class SdlScalerThreadPool {
+public:
+	enum {
+		MAX_THREADS = 16
+	};
+
+	/**
+	 * Starts numThreads - 1 worker threads. The thread calling scale() works
+	 * on the bands as well.
+	 */
+	SdlScalerThreadPool(int numThreads);
+	~SdlScalerThreadPool();
+
+	/**
+	 * Returns whether the scaler can be run by several threads at once.
+	 */
+	static bool isReentrant(ScalerProc *scalerProc);
+
+	/**
+	 * Scales a rect just like calling scalerProc directly does. Returns
+	 * after all bands are done.
+	 */
+	void scale(ScalerProc *scalerProc, int scaleFactor, const uint8 *srcPtr, uint32 srcPitch,
+	           uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
+private:
+	enum {
+		/** Bands are never smaller than this many rows */
+		MIN_BAND_HEIGHT = 16
+	};
+
+	int _numThreads;
+	SdlWorkerThreads _threads;
+
+	// The current job, protected by the lock of _threads
+	ScalerProc *_scalerProc;
+	int _scaleFactor;
+	const uint8 *_srcPtr;
+	uint32 _srcPitch;
+	uint8 *_dstPtr;
+	uint32 _dstPitch;
+	int _width, _height;
+	int _numBands;
+	int _nextBand;
+	int _bandsLeft;
+
+	/**
+	 * Scales bands of the current job until none are left to be picked up.
+	 */
+	void runBands();
+
+	void workerThread();
+	static void workerThreadProc(void *param);
+};
+
+#endif
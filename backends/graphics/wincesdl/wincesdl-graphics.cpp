@@ -531,6 +531,9 @@ void WINCESdlGraphicsManager::internUpdateScreen() {
 		update_scalers();
 	}
 
+	// Merge the dirty tiles into the list of rects to scale
+	buildDirtyRectList();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -28,6 +28,7 @@
 #include "backends/mutex/mutex.h"
 
 #include "audio/mixer.h"
+#include "common/EventRecorder.h"
 #include "graphics/pixelformat.h"
 
 ModularBackend::ModularBackend()
@@ -141,6 +142,7 @@ void ModularBackend::fillScreen(uint32 col) {
 }
 
 void ModularBackend::updateScreen() {
+	g_eventRec.processScreenUpdate();
 	_graphicsManager->updateScreen();
 }
 
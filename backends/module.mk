@@ -62,10 +62,13 @@ ifdef SDL_BACKEND
 MODULE_OBJS += \
 	events/sdl/sdl-events.o \
 	graphics/surfacesdl/surfacesdl-graphics.o \
+	graphics/surfacesdl/surfacesdl-scalerthreads.o \
 	mixer/doublebuffersdl/doublebuffersdl-mixer.o \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
+	saves/sdl/sdl-saves.o \
+	threads/sdl/sdl-threads.o \
 	timer/sdl/sdl-timer.o
 	
 # SDL 1.3 removed audio CD support
@@ -115,6 +118,11 @@ MODULE_OBJS += \
 	mixer/sdl13/sdl13-mixer.o
 endif
 
+ifeq ($(BACKEND),bench)
+MODULE_OBJS += \
+	graphics/bench/bench-graphics.o
+endif
+
 ifeq ($(BACKEND),ds)
 MODULE_OBJS += \
 	fs/ds/ds-fs.o \
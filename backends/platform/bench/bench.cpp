@@ -0,0 +1,439 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_stdout
+#define FORBIDDEN_SYMBOL_EXCEPTION_stderr
+#define FORBIDDEN_SYMBOL_EXCEPTION_fputs
+#define FORBIDDEN_SYMBOL_EXCEPTION_exit
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_clock
+
+#include "backends/modular-backend.h"
+#include "base/main.h"
+
+#if defined(USE_BENCH_DRIVER)
+#include "backends/audiocd/audiocd.h"
+#include "backends/events/default/default-events.h"
+#include "backends/graphics/bench/bench-graphics.h"
+#include "backends/mutex/null/null-mutex.h"
+#include "backends/saves/default/default-saves.h"
+#include "backends/timer/default/default-timer.h"
+#include "audio/mixer_intern.h"
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/EventRecorder.h"
+#include "common/file.h"
+#include "common/scummsys.h"
+
+#include <time.h>
+#ifdef POSIX
+#include <sys/time.h>
+#endif
+
+/*
+ * Include header files needed for the getFilesystemFactory() method.
+ */
+#if defined(__amigaos4__)
+	#include "backends/fs/amigaos4/amigaos4-fs-factory.h"
+#elif defined(POSIX)
+	#include "backends/fs/posix/posix-fs-factory.h"
+#elif defined(WIN32)
+	#include "backends/fs/windows/windows-fs-factory.h"
+#endif
+
+/**
+ * Headless backend for measuring the CPU time spent by engines.
+ *
+ * Nothing is displayed and no audio device is used, and there is no
+ * real time: the clock only advances when the engine waits through
+ * delayMillis(), which returns immediately. The audio for the elapsed
+ * virtual time is mixed and the timers are run at that point, all on
+ * the engine thread. Input comes from the event recorder (see the
+ * record_mode config key), so a recorded session is replayed as fast
+ * as the CPU allows.
+ *
+ * Each updateScreen() call ends a frame. For every frame, the time
+ * spent in the engine since the last frame ("update"), in converting
+ * and scaling the screen ("scale") and in mixing audio ("mix") is
+ * recorded, and written to the file given by the bench_log config key
+ * on exit, as CSV or, if the file name ends with ".json", as JSON.
+ */
+class OSystem_Bench : public ModularBackend, Common::EventSource {
+public:
+	OSystem_Bench();
+	virtual ~OSystem_Bench();
+
+	virtual void initBackend();
+
+	virtual bool pollEvent(Common::Event &event);
+
+	virtual uint32 getMillis();
+	virtual void delayMillis(uint msecs);
+	virtual void getTimeAndDate(TimeDate &t) const;
+
+	virtual void updateScreen();
+	virtual void quit();
+
+	virtual void logMessage(LogMessageType::Type type, const char *message);
+
+	/**
+	 * Writes the frame timings to the log file and prints a summary.
+	 * Only the first call has any effect.
+	 */
+	void writeResults();
+
+protected:
+	virtual Common::EventSource *getDefaultEventSource() { return this; }
+
+private:
+	struct FrameTiming {
+		uint32 millis;	///< virtual time at the end of the frame
+		uint32 update;	///< time spent in the engine, in microseconds
+		uint32 scale;	///< time spent in updateScreen(), in microseconds
+		uint32 mix;	///< time spent mixing audio, in microseconds
+	};
+
+	enum {
+		/** Number of sample frames mixed at once. */
+		kMixBufferFrames = 1024,
+
+		/**
+		 * Number of getMillis() calls without a delay after which the
+		 * clock is advanced anyway, so engines which busy wait still
+		 * get going.
+		 */
+		kMaxMillisPolls = 256,
+
+		/** Virtual time to keep running after the playback ended. */
+		kPlaybackTailMillis = 1000,
+
+		/** Virtual time to give the engine to react to the quit event. */
+		kQuitTimeoutMillis = 10000
+	};
+
+	/** Returns the wall clock time in microseconds. */
+	uint32 getMicros() const;
+
+	/** Advances the virtual clock, mixing audio and running timers. */
+	void advanceClock(uint msecs);
+
+	/** Checks whether the benchmark is done and should quit. */
+	void checkFinished();
+
+	uint32 _virtualMillis;
+	uint _millisPolls;
+	bool _inClockAdvance;
+	bool _inTimerHandler;
+
+	uint32 _mixRemainder;
+	byte *_mixBuffer;
+
+	uint32 _frameEnd;
+	uint32 _frameMix;
+	Common::Array<FrameTiming> _frames;
+
+	Common::String _logFileName;
+	uint _maxFrames;
+	uint32 _playbackEnd;
+	uint32 _quitTime;
+	bool _quitRequested;
+	bool _quitSent;
+	bool _resultsWritten;
+};
+
+OSystem_Bench::OSystem_Bench()
+	: _virtualMillis(0), _millisPolls(0), _inClockAdvance(false), _inTimerHandler(false),
+	_mixRemainder(0), _mixBuffer(0), _frameEnd(0), _frameMix(0), _maxFrames(0),
+	_playbackEnd(0), _quitTime(0), _quitRequested(false), _quitSent(false), _resultsWritten(false) {
+
+	#if defined(__amigaos4__)
+		_fsFactory = new AmigaOSFilesystemFactory();
+	#elif defined(POSIX)
+		_fsFactory = new POSIXFilesystemFactory();
+	#elif defined(WIN32)
+		_fsFactory = new WindowsFilesystemFactory();
+	#else
+		#error Unknown and unsupported FS backend
+	#endif
+}
+
+OSystem_Bench::~OSystem_Bench() {
+	// The managers may still call back into the backend while they are
+	// destroyed, so get rid of them before our part of it is gone.
+	delete _savefileManager;
+	_savefileManager = 0;
+	delete _graphicsManager;
+	_graphicsManager = 0;
+	delete _eventManager;
+	_eventManager = 0;
+	delete _audiocdManager;
+	_audiocdManager = 0;
+	delete _mixer;
+	_mixer = 0;
+	delete _timerManager;
+	_timerManager = 0;
+	delete _mutexManager;
+	_mutexManager = 0;
+
+	delete[] _mixBuffer;
+}
+
+void OSystem_Bench::initBackend() {
+	_mutexManager = new NullMutexManager();
+	_timerManager = new DefaultTimerManager();
+	_savefileManager = new DefaultSaveFileManager();
+	_graphicsManager = new BenchGraphicsManager();
+
+	uint outputRate = 44100;
+	if (ConfMan.hasKey("output_rate") && ConfMan.getInt("output_rate") > 0)
+		outputRate = ConfMan.getInt("output_rate");
+
+	_mixBuffer = new byte[kMixBufferFrames * 4];
+	_mixer = new Audio::MixerImpl(this, outputRate);
+	((Audio::MixerImpl *)_mixer)->setReady(true);
+
+	// The game is started only after this, so read the settings now
+	_logFileName = ConfMan.get("bench_log");
+	_maxFrames = ConfMan.getInt("bench_frames");
+
+	ModularBackend::initBackend();
+
+	_frameEnd = getMicros();
+}
+
+bool OSystem_Bench::pollEvent(Common::Event &event) {
+	if (_quitRequested && !_quitSent) {
+		_quitSent = true;
+		event.type = Common::EVENT_QUIT;
+		return true;
+	}
+
+	return false;
+}
+
+uint32 OSystem_Bench::getMillis() {
+	if (!_inClockAdvance && ++_millisPolls >= kMaxMillisPolls)
+		advanceClock(1);
+
+	uint32 millis = _virtualMillis;
+	g_eventRec.processMillis(millis);
+	return millis;
+}
+
+void OSystem_Bench::delayMillis(uint msecs) {
+	// There is no sleeping here anyway, but fast playback needs to know
+	// about the delay to advance its clock.
+	g_eventRec.processDelayMillis(msecs);
+	advanceClock(msecs);
+}
+
+void OSystem_Bench::getTimeAndDate(TimeDate &t) const {
+	// Use a fixed date, so that runs are reproducible
+	const uint32 seconds = _virtualMillis / 1000;
+	t.tm_sec = seconds % 60;
+	t.tm_min = (seconds / 60) % 60;
+	t.tm_hour = (12 + seconds / 3600) % 24;
+	t.tm_mday = 1;
+	t.tm_mon = 0;
+	t.tm_year = 111;
+}
+
+uint32 OSystem_Bench::getMicros() const {
+#ifdef POSIX
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (uint32)(tv.tv_sec * 1000000 + tv.tv_usec);
+#else
+	return (uint32)((double)clock() * 1000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+void OSystem_Bench::advanceClock(uint msecs) {
+	_virtualMillis += msecs;
+	_millisPolls = 0;
+
+	const bool nested = _inClockAdvance;
+	_inClockAdvance = true;
+
+	// Mix all audio which would have been played in the meantime
+	const uint32 mixStart = getMicros();
+	_mixRemainder += msecs * _mixer->getOutputRate();
+	uint frames = _mixRemainder / 1000;
+	_mixRemainder %= 1000;
+
+	while (frames > 0) {
+		const uint count = MIN<uint>(frames, kMixBufferFrames);
+		((Audio::MixerImpl *)_mixer)->mixCallback(_mixBuffer, count * 4);
+		frames -= count;
+	}
+	_frameMix += getMicros() - mixStart;
+
+	// Timer procs may wait for the mixer, but must not run recursively
+	if (!_inTimerHandler) {
+		_inTimerHandler = true;
+		((DefaultTimerManager *)_timerManager)->handler();
+		_inTimerHandler = false;
+	}
+
+	_inClockAdvance = nested;
+}
+
+void OSystem_Bench::updateScreen() {
+	const uint32 start = getMicros();
+	ModularBackend::updateScreen();
+	const uint32 end = getMicros();
+
+	FrameTiming frame;
+	frame.millis = _virtualMillis;
+	frame.scale = end - start;
+	frame.mix = _frameMix;
+	// Mixing happens while the engine waits, don't count it twice
+	frame.update = start - _frameEnd - MIN(_frameMix, start - _frameEnd);
+	_frames.push_back(frame);
+
+	_frameEnd = end;
+	_frameMix = 0;
+
+	checkFinished();
+}
+
+void OSystem_Bench::checkFinished() {
+	if (_quitRequested) {
+		// Give up when the engine does not react to the quit event
+		if (_virtualMillis - _quitTime > kQuitTimeoutMillis) {
+			warning("Engine did not quit, stopping the benchmark");
+			quit();
+		}
+		return;
+	}
+
+	bool done = (_maxFrames > 0 && _frames.size() >= _maxFrames);
+
+	if (g_eventRec.isPlaybackFinished()) {
+		if (!_playbackEnd)
+			_playbackEnd = _virtualMillis + kPlaybackTailMillis;
+		else if (_virtualMillis >= _playbackEnd)
+			done = true;
+	}
+
+	if (done) {
+		_quitRequested = true;
+		_quitTime = _virtualMillis;
+	}
+}
+
+void OSystem_Bench::quit() {
+	writeResults();
+	ModularBackend::quit();
+}
+
+void OSystem_Bench::writeResults() {
+	if (_resultsWritten)
+		return;
+	_resultsWritten = true;
+
+	if (_frames.empty())
+		return;
+
+	const bool json = _logFileName.hasSuffix(".json");
+	Common::DumpFile log;
+	if (!_logFileName.empty() && !log.open(_logFileName))
+		warning("Could not open benchmark log file '%s'", _logFileName.c_str());
+
+	if (log.isOpen())
+		log.writeString(json ? "{\"frames\": [\n" : "frame,millis,update_us,scale_us,mix_us\n");
+
+	double update = 0, scale = 0, mix = 0;
+	uint32 maxUpdate = 0, maxScale = 0, maxMix = 0;
+
+	for (uint i = 0; i < _frames.size(); ++i) {
+		const FrameTiming &frame = _frames[i];
+		update += frame.update;
+		scale += frame.scale;
+		mix += frame.mix;
+		maxUpdate = MAX(maxUpdate, frame.update);
+		maxScale = MAX(maxScale, frame.scale);
+		maxMix = MAX(maxMix, frame.mix);
+
+		if (!log.isOpen())
+			continue;
+
+		if (json)
+			log.writeString(Common::String::format("  {\"frame\": %u, \"millis\": %u, \"update_us\": %u, \"scale_us\": %u, \"mix_us\": %u}%s\n",
+				i, frame.millis, frame.update, frame.scale, frame.mix, (i + 1 < _frames.size()) ? "," : ""));
+		else
+			log.writeString(Common::String::format("%u,%u,%u,%u,%u\n", i, frame.millis, frame.update, frame.scale, frame.mix));
+	}
+
+	const uint count = _frames.size();
+	if (log.isOpen()) {
+		if (json)
+			log.writeString(Common::String::format("],\n\"summary\": {\"frames\": %u, \"millis\": %u, "
+				"\"update_us\": %.1f, \"scale_us\": %.1f, \"mix_us\": %.1f, "
+				"\"max_update_us\": %u, \"max_scale_us\": %u, \"max_mix_us\": %u}}\n",
+				count, _virtualMillis, update / count, scale / count, mix / count,
+				maxUpdate, maxScale, maxMix));
+		log.finalize();
+		log.close();
+	}
+
+	logMessage(LogMessageType::kInfo, Common::String::format("%u frames, %u ms of game time, %.3f s of CPU time\n",
+		count, _virtualMillis, (update + scale + mix) / 1000000).c_str());
+	logMessage(LogMessageType::kInfo, Common::String::format("per frame: update %.1f us (max %u), scale %.1f us (max %u), mix %.1f us (max %u)\n",
+		update / count, maxUpdate, scale / count, maxScale, mix / count, maxMix).c_str());
+}
+
+void OSystem_Bench::logMessage(LogMessageType::Type type, const char *message) {
+	FILE *output = 0;
+
+	if (type == LogMessageType::kInfo || type == LogMessageType::kDebug)
+		output = stdout;
+	else
+		output = stderr;
+
+	fputs(message, output);
+	fflush(output);
+}
+
+OSystem *OSystem_Bench_create() {
+	return new OSystem_Bench();
+}
+
+int main(int argc, char *argv[]) {
+	g_system = OSystem_Bench_create();
+	assert(g_system);
+
+	// Invoke the actual ScummVM main entry point:
+	int res = scummvm_main(argc, argv);
+	((OSystem_Bench *)g_system)->writeResults();
+	delete (OSystem_Bench *)g_system;
+	return res;
+}
+
+#else /* USE_BENCH_DRIVER */
+
+OSystem *OSystem_Bench_create() {
+	return NULL;
+}
+
+#endif
@@ -20,10 +20,18 @@
  *
  */
 
+#define FORBIDDEN_SYMBOL_EXCEPTION_FILE
+#define FORBIDDEN_SYMBOL_EXCEPTION_stdout
+#define FORBIDDEN_SYMBOL_EXCEPTION_stderr
+#define FORBIDDEN_SYMBOL_EXCEPTION_fputs
+
 #include "backends/modular-backend.h"
 #include "base/main.h"
 
 #if defined(USE_NULL_DRIVER)
+#include "backends/events/default/default-events.h"
+#include "backends/graphics/null/null-graphics.h"
+#include "backends/mutex/null/null-mutex.h"
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "audio/mixer_intern.h"
@@ -40,7 +48,7 @@
 	#include "backends/fs/windows/windows-fs-factory.h"
 #endif
 
-class OSystem_NULL : public ModularBackend {
+class OSystem_NULL : public ModularBackend, Common::EventSource {
 public:
 	OSystem_NULL();
 	virtual ~OSystem_NULL();
@@ -54,6 +62,9 @@ public:
 	virtual void getTimeAndDate(TimeDate &t) const {}
 
 	virtual void logMessage(LogMessageType::Type type, const char *message);
+
+protected:
+	virtual Common::EventSource *getDefaultEventSource() { return this; }
 };
 
 OSystem_NULL::OSystem_NULL() {
@@ -74,7 +85,6 @@ OSystem_NULL::~OSystem_NULL() {
 void OSystem_NULL::initBackend() {
 	_mutexManager = new NullMutexManager();
 	_timerManager = new DefaultTimerManager();
-	_eventManager = new DefaultEventManager(this);
 	_savefileManager = new DefaultSaveFileManager();
 	_graphicsManager = new NullGraphicsManager();
 	_mixer = new Audio::MixerImpl(this, 22050);
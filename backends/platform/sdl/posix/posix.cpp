@@ -32,6 +32,7 @@
 
 #include "backends/platform/sdl/posix/posix.h"
 #include "backends/saves/posix/posix-saves.h"
+#include "backends/saves/sdl/sdl-saves.h"
 #include "backends/fs/posix/posix-fs-factory.h"
 #include "backends/taskbar/unity/unity-taskbar.h"
 
@@ -61,8 +62,11 @@ void OSystem_POSIX::init() {
 
 void OSystem_POSIX::initBackend() {
 	// Create the savefile manager
-	if (_savefileManager == 0)
-		_savefileManager = new POSIXSaveFileManager();
+	if (_savefileManager == 0) {
+		POSIXSaveFileManager *saveFileManager = new POSIXSaveFileManager();
+		saveFileManager->setWriterThread(new SdlSaveWriterThread(saveFileManager));
+		_savefileManager = saveFileManager;
+	}
 
 	// Invoke parent implementation of this method
 	OSystem_SDL::initBackend();
@@ -35,6 +35,7 @@
 #include "common/textconsole.h"
 
 #include "backends/saves/default/default-saves.h"
+#include "backends/saves/sdl/sdl-saves.h"
 
 // Audio CD support was removed with SDL 1.3
 #if SDL_VERSION_ATLEAST(1, 3, 0)
@@ -185,8 +186,11 @@ void OSystem_SDL::initBackend() {
 		}
 	}
 
-	if (_savefileManager == 0)
-		_savefileManager = new DefaultSaveFileManager();
+	if (_savefileManager == 0) {
+		DefaultSaveFileManager *saveFileManager = new DefaultSaveFileManager();
+		saveFileManager->setWriterThread(new SdlSaveWriterThread(saveFileManager));
+		_savefileManager = saveFileManager;
+	}
 
 	if (_mixerManager == 0) {
 		_mixerManager = new SdlMixerManager();
@@ -472,7 +476,12 @@ uint32 OSystem_SDL::getMillis() {
 }
 
 void OSystem_SDL::delayMillis(uint msecs) {
-	SDL_Delay(msecs);
+	if (!g_eventRec.processDelayMillis(msecs))
+		SDL_Delay(msecs);
+
+	// See SdlTimerManager
+	if (g_eventRec.hasEngineThreadTimers())
+		((DefaultTimerManager *)_timerManager)->handler();
 }
 
 void OSystem_SDL::getTimeAndDate(TimeDate &td) const {
@@ -31,19 +31,243 @@
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/textconsole.h"
 #include "common/zlib.h"
 
 #ifndef _WIN32_WCE
 #include <errno.h>	// for removeSavefile()
 #endif
 
-DefaultSaveFileManager::DefaultSaveFileManager() {
+/**
+ * An OutSaveFile which collects the data in memory. When it is finalized,
+ * the data is queued to be written by the writer thread.
+ */
+class DefaultSaveFileManager::BufferedSaveFile : public Common::WriteStream {
+	DefaultSaveFileManager *_manager;
+	Common::String _fileName;
+	Common::String _savePath;
+	Common::MemoryWriteStreamDynamic _buffer;
+	bool _finalized;
+
+public:
+	BufferedSaveFile(DefaultSaveFileManager *manager, const Common::String &fileName, const Common::String &savePath)
+		: _manager(manager), _fileName(fileName), _savePath(savePath), _buffer(DisposeAfterUse::NO), _finalized(false) {
+	}
+
+	~BufferedSaveFile() {
+		finalize();
+	}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (_finalized)
+			return 0;
+		return _buffer.write(dataPtr, dataSize);
+	}
+
+	bool err() const {
+		// The background write may still be running, so this only knows
+		// about failures which already happened. All of them are reported
+		// by SaveFileManager::waitForPendingSaves() as well.
+		return _finalized && _manager->hasSaveFailed(_fileName);
+	}
+
+	void finalize() {
+		if (_finalized)
+			return;
+		_finalized = true;
+
+		PendingSave *save = new PendingSave;
+		save->fileName = _fileName;
+		save->savePath = _savePath;
+		save->data = _buffer.getData();
+		save->size = _buffer.size();
+		_manager->queueSave(save);
+	}
+};
+
+DefaultSaveFileManager::DefaultSaveFileManager() : _writerThread(0), _pendingMutex(0), _writeError(Common::kNoError) {
 }
 
-DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath) {
+DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSavepath) : _writerThread(0), _pendingMutex(0), _writeError(Common::kNoError) {
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	stopWriterThread();
+}
+
+void DefaultSaveFileManager::setWriterThread(SaveWriterThread *thread) {
+	assert(!_writerThread);
+	_pendingMutex = g_system->createMutex();
+	_writerThread = thread;
+}
+
+void DefaultSaveFileManager::stopWriterThread() {
+	if (!_writerThread)
+		return;
+
+	delete _writerThread;
+	_writerThread = 0;
+	assert(_pendingSaves.empty());
+
+	g_system->deleteMutex(_pendingMutex);
+	_pendingMutex = 0;
+}
+
+void DefaultSaveFileManager::queueSave(PendingSave *save) {
+	{
+		Common::StackLock lock(_pendingMutex);
+		_failedSaves.erase(save->fileName);
+		_pendingSaves.push_back(save);
+	}
+	_writerThread->wakeUp();
+}
+
+bool DefaultSaveFileManager::writeNextPendingSave() {
+	PendingSave *save;
+	{
+		Common::StackLock lock(_pendingMutex);
+		if (_pendingSaves.empty())
+			return false;
+		// The savefile stays in the queue while it is written, so that
+		// waitForSavefiles() still finds it
+		save = _pendingSaves.front();
+	}
+
+	const Common::Error error = writeSave(*save);
+	if (error.getCode() != Common::kNoError)
+		warning("%s", error.getDesc().c_str());
+
+	{
+		Common::StackLock lock(_pendingMutex);
+		if (error.getCode() != Common::kNoError) {
+			if (_writeError.getCode() == Common::kNoError)
+				_writeError = error;
+			// Unless the savefile was queued again in between
+			if (!isQueuedAgain(save))
+				_failedSaves[save->fileName] = true;
+		}
+		_pendingSaves.pop_front();
+	}
+
+	free(save->data);
+	delete save;
+	return true;
+}
+
+Common::Error DefaultSaveFileManager::writeSave(const PendingSave &save) {
+	Common::FSNode savePath(save.savePath);
+	Common::FSNode file = savePath.getChild(save.fileName);
+	Common::FSNode tempFile = savePath.getChild(save.fileName + ".tmp");
+
+	Common::WriteStream *sf = tempFile.createWriteStream();
+	if (!sf)
+		return Common::Error(Common::kCreatingFileFailed, tempFile.getPath());
+
+	// The compression runs here, on the writer thread, and streams the
+	// compressed data into the temporary file
+	Common::WriteStream *out = Common::wrapCompressedWriteStream(sf);
+	out->write(save.data, save.size);
+	out->finalize();
+	const bool failed = out->err();
+	delete out;
+
+	if (failed) {
+		remove(tempFile.getPath().c_str());
+		return Common::Error(Common::kWritingFailed, tempFile.getPath());
+	}
+
+	// Until here, the old savefile is still intact
+	if (!replaceSavefile(tempFile.getPath(), file.getPath())) {
+		remove(tempFile.getPath().c_str());
+		return Common::Error(Common::kWritingFailed, file.getPath());
+	}
+
+	return Common::kNoError;
+}
+
+bool DefaultSaveFileManager::replaceSavefile(const Common::String &tempPath, const Common::String &path) {
+	if (rename(tempPath.c_str(), path.c_str()) == 0)
+		return true;
+
+	// rename() does not replace files on all systems. Move the old savefile
+	// out of the way, so it can be restored if the rename still fails.
+	const Common::String backupPath = path + ".bak";
+	remove(backupPath.c_str());
+	if (rename(path.c_str(), backupPath.c_str()) != 0)
+		return false;
+
+	if (rename(tempPath.c_str(), path.c_str()) != 0) {
+		rename(backupPath.c_str(), path.c_str());
+		return false;
+	}
+
+	remove(backupPath.c_str());
+	return true;
+}
+
+void DefaultSaveFileManager::waitForSavefiles(const Common::String &pattern) {
+	if (!_writerThread)
+		return;
+
+	while (true) {
+		{
+			Common::StackLock lock(_pendingMutex);
+			bool pending = false;
+			for (Common::List<PendingSave *>::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+				if ((*i)->fileName == pattern || (*i)->fileName.matchString(pattern, true)) {
+					pending = true;
+					break;
+				}
+			}
+
+			if (!pending)
+				return;
+		}
+
+		_writerThread->waitForProgress();
+	}
+}
+
+bool DefaultSaveFileManager::isSavePending(const Common::String &filename) {
+	if (!_writerThread)
+		return false;
+
+	Common::StackLock lock(_pendingMutex);
+	for (Common::List<PendingSave *>::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+		if ((*i)->fileName == filename)
+			return true;
+	}
+	return false;
+}
+
+bool DefaultSaveFileManager::isQueuedAgain(const PendingSave *save) const {
+	for (Common::List<PendingSave *>::const_iterator i = _pendingSaves.begin(); i != _pendingSaves.end(); ++i) {
+		if (*i != save && (*i)->fileName == save->fileName)
+			return true;
+	}
+	return false;
+}
+
+bool DefaultSaveFileManager::hasSaveFailed(const Common::String &filename) {
+	Common::StackLock lock(_pendingMutex);
+	return _failedSaves.contains(filename);
+}
+
+Common::Error DefaultSaveFileManager::waitForPendingSaves() {
+	if (!_writerThread)
+		return Common::kNoError;
+
+	waitForSavefiles("*");
+
+	Common::StackLock lock(_pendingMutex);
+	const Common::Error error = _writeError;
+	_writeError = Common::kNoError;
+	return error;
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -55,6 +279,8 @@ void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 }
 
 Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &pattern) {
+	waitForSavefiles(pattern);
+
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
@@ -78,6 +304,8 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String &filename) {
+	waitForSavefiles(filename);
+
 	// Ensure that the savepath is valid. If not, generate an appropriate error.
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
@@ -107,6 +335,10 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 	// recreate FSNode since checkPath may have changed/created the directory
 	Common::FSNode savePath(savePathName);
 
+	// Buffer the data, the writer thread does the rest
+	if (_writerThread)
+		return new BufferedSaveFile(this, filename, savePathName);
+
 	Common::FSNode file = savePath.getChild(filename);
 
 	// Open the file for saving
@@ -116,6 +348,8 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 }
 
 bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
+	waitForSavefiles(filename);
+
 	Common::String savePathName = getSavePath();
 	checkPath(Common::FSNode(savePathName));
 	if (getError().getCode() != Common::kNoError)
@@ -27,21 +27,137 @@
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/fs.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
+#include "common/system.h"
+
+class DefaultSaveFileManager;
+
+/**
+ * A thread which stores the savefiles of a DefaultSaveFileManager in the
+ * background. Backends which support threads provide an implementation.
+ */
+class SaveWriterThread {
+public:
+	virtual ~SaveWriterThread() {}
+
+	/**
+	 * Wakes the thread up, after a savefile was queued. The thread then
+	 * calls DefaultSaveFileManager::writeNextPendingSave() until it
+	 * returns false.
+	 *
+	 * When the thread is deleted, it has to write all queued savefiles
+	 * before it quits.
+	 */
+	virtual void wakeUp() = 0;
+
+	/**
+	 * Blocks until the thread finished writing a savefile, or for a short
+	 * while. Used to wait for queued savefiles.
+	 */
+	virtual void waitForProgress() = 0;
+};
 
 /**
  * Provides a default savefile manager implementation for common platforms.
+ *
+ * If a SaveWriterThread is set, the data of an OutSaveFile is buffered in
+ * memory. When it is finalized, the thread compresses it into a temporary
+ * file, which then replaces the savefile. Operations on savefiles which
+ * are still being written wait for them.
  */
 class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::String &defaultSavepath);
+	virtual ~DefaultSaveFileManager();
 
 	virtual Common::StringArray listSavefiles(const Common::String &pattern);
 	virtual Common::InSaveFile *openForLoading(const Common::String &filename);
 	virtual Common::OutSaveFile *openForSaving(const Common::String &filename);
 	virtual bool removeSavefile(const Common::String &filename);
+	virtual bool isSavePending(const Common::String &filename);
+	virtual Common::Error waitForPendingSaves();
+
+	/**
+	 * Sets the thread which writes the savefiles in the background. The
+	 * manager takes ownership of it. Has to be called before any savefile
+	 * is opened.
+	 */
+	void setWriterThread(SaveWriterThread *thread);
+
+	/**
+	 * Writes the oldest savefile of the queue. Called by the writer thread.
+	 * @return false if the queue was empty
+	 */
+	bool writeNextPendingSave();
 
 protected:
+	/** A finalized savefile, which is waiting to be written. */
+	struct PendingSave {
+		Common::String fileName;
+		Common::String savePath;
+		byte *data;
+		uint32 size;
+	};
+
+	class BufferedSaveFile;
+	friend class BufferedSaveFile;
+
+	SaveWriterThread *_writerThread;
+	OSystem::MutexRef _pendingMutex;
+
+	/** The queued savefiles. The first one is the one being written. */
+	Common::List<PendingSave *> _pendingSaves;
+
+	/** The first error of a background write, or kNoError. */
+	Common::Error _writeError;
+
+	/** The savefiles whose last background write failed. */
+	Common::HashMap<Common::String, bool> _failedSaves;
+
+	/** Queues a finalized savefile, and wakes the writer thread up. */
+	void queueSave(PendingSave *save);
+
+	/**
+	 * Returns whether a newer version of the given savefile is queued.
+	 * The pending mutex has to be locked.
+	 */
+	bool isQueuedAgain(const PendingSave *save) const;
+
+	/** Returns whether the last background write of a savefile failed. */
+	bool hasSaveFailed(const Common::String &filename);
+
+	/**
+	 * Deletes the writer thread, after it wrote all queued savefiles.
+	 * Subclasses which override replaceSavefile() have to call this in
+	 * their destructor.
+	 */
+	void stopWriterThread();
+
+	/**
+	 * Waits until no savefile matching the given pattern is queued
+	 * anymore.
+	 */
+	void waitForSavefiles(const Common::String &pattern);
+
+	/**
+	 * Compresses a pending savefile into a temporary file and replaces the
+	 * savefile with it.
+	 * @return kNoError, or the error which occurred
+	 */
+	Common::Error writeSave(const PendingSave &save);
+
+	/**
+	 * Replaces a savefile with a completely written temporary file. As
+	 * rename() does not replace files on all systems, the default
+	 * implementation may have to rename the old savefile to a backup
+	 * first. It is restored if the replacement fails.
+	 * @return true if no error occurred
+	 */
+	virtual bool replaceSavefile(const Common::String &tempPath, const Common::String &path);
+
 	/**
 	 * Get the path to the savegame directory.
 	 * Should only be used internally since some platforms
@@ -21,9 +21,10 @@
  */
 
 
-// Enable getenv, mkdir and time.h stuff
+// Enable getenv, mkdir, open and time.h stuff
 #define FORBIDDEN_SYMBOL_EXCEPTION_getenv
 #define FORBIDDEN_SYMBOL_EXCEPTION_mkdir
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
 #define FORBIDDEN_SYMBOL_EXCEPTION_time_h	//On IRIX, sys/stat.h includes sys/time.h
 
 #include "common/scummsys.h"
@@ -40,6 +41,8 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 
 #ifdef MACOSX
@@ -84,6 +87,39 @@ POSIXSaveFileManager::POSIXSaveFileManager() {
 #endif
 }
 
+POSIXSaveFileManager::~POSIXSaveFileManager() {
+	// The queued savefiles have to be written through our replaceSavefile()
+	stopWriterThread();
+}
+
+bool POSIXSaveFileManager::getSavefileInfo(const Common::String &filename, uint32 &size, uint32 &timestamp) {
+	waitForSavefiles(filename);
+
+	const Common::String path = Common::FSNode(getSavePath()).getChild(filename).getPath();
+
+	struct stat sb;
+	if (stat(path.c_str(), &sb) == -1 || !S_ISREG(sb.st_mode))
+		return false;
+
+	size = (uint32)sb.st_size;
+	timestamp = (uint32)sb.st_mtime;
+	return true;
+}
+
+bool POSIXSaveFileManager::replaceSavefile(const Common::String &tempPath, const Common::String &path) {
+	// Make sure the data is on the disk before the old savefile is gone,
+	// so that a crash leaves either the old or the new one behind
+	const int fd = open(tempPath.c_str(), O_WRONLY);
+	if (fd == -1)
+		return false;
+	const bool synced = (fsync(fd) == 0);
+	close(fd);
+	if (!synced)
+		return false;
+
+	return rename(tempPath.c_str(), path.c_str()) == 0;
+}
+
 void POSIXSaveFileManager::checkPath(const Common::FSNode &dir) {
 	const Common::String path = dir.getPath();
 	clearError();
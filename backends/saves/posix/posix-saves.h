@@ -28,15 +28,27 @@
 #if defined(POSIX) && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
 /**
  * Customization of the DefaultSaveFileManager for POSIX platforms.
- * The only two differences are that the default constructor sets
- * up the savepath based on HOME, and that checkPath tries to
- * create the savedir, if missing, via the mkdir() syscall.
+ * The differences are that the default constructor sets up the
+ * savepath based on HOME, that checkPath tries to create the savedir,
+ * if missing, via the mkdir() syscall, and that getSavefileInfo uses
+ * stat() to provide the modification time as well. Savefiles written in
+ * the background are synced to the disk before they replace the old ones.
  */
 class POSIXSaveFileManager : public DefaultSaveFileManager {
 public:
 	POSIXSaveFileManager();
+	virtual ~POSIXSaveFileManager();
+
+	virtual bool getSavefileInfo(const Common::String &filename, uint32 &size, uint32 &timestamp);
+	virtual bool hasSavefileInfo() const { return true; }
 
 protected:
+	/**
+	 * Syncs the temporary file to the disk, and renames it, which
+	 * atomically replaces the old savefile.
+	 */
+	virtual bool replaceSavefile(const Common::String &tempPath, const Common::String &path);
+
 	/**
 	 * Checks the given path for read access, existence, etc.
 	 * In addition, tries to create a missing savedir, if possible.
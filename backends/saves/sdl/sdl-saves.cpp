@@ -0,0 +1,78 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND) && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+
+#include "backends/saves/sdl/sdl-saves.h"
+
+#include "common/textconsole.h"
+
+SdlSaveWriterThread::SdlSaveWriterThread(DefaultSaveFileManager *manager)
+	: _manager(manager) {
+	assert(_manager);
+}
+
+SdlSaveWriterThread::~SdlSaveWriterThread() {
+	// The thread writes the remaining savefiles before it quits
+	_thread.stop();
+}
+
+void SdlSaveWriterThread::wakeUp() {
+	// The thread is started with the first savefile, as the manager
+	// can only be used by it once setWriterThread() has returned
+	if (!_thread.isRunning() && !_thread.start(writerThreadProc, this))
+		error("Could not create savefile writer thread: %s", SDL_GetError());
+
+	_thread.wakeUp();
+}
+
+void SdlSaveWriterThread::waitForProgress() {
+	// The savefile might be written before we start waiting, so don't
+	// wait for the signal forever
+	_thread.lock();
+	_thread.waitForThreads(10);
+	_thread.unlock();
+}
+
+void SdlSaveWriterThread::writerThread() {
+	while (true) {
+		while (_manager->writeNextPendingSave())
+			_thread.notify();
+
+		_thread.lock();
+		const bool running = _thread.wait();
+		_thread.unlock();
+
+		if (!running)
+			break;
+	}
+}
+
+void SdlSaveWriterThread::writerThreadProc(void *param) {
+	SdlSaveWriterThread *thread = (SdlSaveWriterThread *)param;
+	assert(thread);
+	thread->writerThread();
+}
+
+#endif
@@ -0,0 +1,52 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKEND_SDL_SAVES_H
+#define BACKEND_SDL_SAVES_H
+
+#include "backends/saves/default/default-saves.h"
+
+#include "backends/threads/sdl/sdl-threads.h"
+
+/**
+ * SDL savefile writer thread. Writes the savefiles queued by a
+ * DefaultSaveFileManager, so that compressing and storing them does not
+ * stall the engine.
+ */
+class SdlSaveWriterThread : public SaveWriterThread {
+public:
+	SdlSaveWriterThread(DefaultSaveFileManager *manager);
+	virtual ~SdlSaveWriterThread();
+
+	virtual void wakeUp();
+	virtual void waitForProgress();
+
+protected:
+	DefaultSaveFileManager *_manager;
+
+	SdlWorkerThreads _thread;
+
+	void writerThread();
+	static void writerThreadProc(void *param);
+};
+
+#endif
@@ -0,0 +1,127 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/threads/sdl/sdl-threads.h"
+
+#include "common/textconsole.h"
+
+SdlWorkerThreads::SdlWorkerThreads()
+	: _numThreads(0), _proc(0), _param(0), _wakeUp(false), _quit(false) {
+	_mutex = SDL_CreateMutex();
+	_wakeCond = SDL_CreateCond();
+	_notifyCond = SDL_CreateCond();
+}
+
+SdlWorkerThreads::~SdlWorkerThreads() {
+	stop();
+
+	SDL_DestroyCond(_notifyCond);
+	SDL_DestroyCond(_wakeCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+int SdlWorkerThreads::start(ThreadProc proc, void *param, int numThreads) {
+	assert(proc);
+	assert(_numThreads == 0);
+	assert(numThreads <= MAX_THREADS);
+
+	_proc = proc;
+	_param = param;
+	_quit = false;
+
+	while (_numThreads < numThreads) {
+		_threads[_numThreads] = SDL_CreateThread(threadEntry, this);
+		if (!_threads[_numThreads]) {
+			warning("Could not create thread: %s", SDL_GetError());
+			break;
+		}
+		_numThreads++;
+	}
+
+	return _numThreads;
+}
+
+void SdlWorkerThreads::stop() {
+	SDL_LockMutex(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_wakeCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (int i = 0; i < _numThreads; ++i)
+		SDL_WaitThread(_threads[i], NULL);
+	_numThreads = 0;
+}
+
+void SdlWorkerThreads::lock() {
+	SDL_LockMutex(_mutex);
+}
+
+void SdlWorkerThreads::unlock() {
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlWorkerThreads::wakeUp() {
+	SDL_LockMutex(_mutex);
+	_wakeUp = true;
+	SDL_CondBroadcast(_wakeCond);
+	SDL_UnlockMutex(_mutex);
+}
+
+bool SdlWorkerThreads::wait(int32 timeout) {
+	if (!_wakeUp && !_quit) {
+		if (timeout >= 0)
+			SDL_CondWaitTimeout(_wakeCond, _mutex, timeout);
+		else
+			SDL_CondWait(_wakeCond, _mutex);
+	}
+
+	// Work the owner asked for right before stopping is still done
+	const bool wokenUp = _wakeUp;
+	_wakeUp = false;
+	return wokenUp || !_quit;
+}
+
+void SdlWorkerThreads::notify() {
+	SDL_LockMutex(_mutex);
+	SDL_CondBroadcast(_notifyCond);
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlWorkerThreads::waitForThreads(int32 timeout) {
+	if (timeout >= 0)
+		SDL_CondWaitTimeout(_notifyCond, _mutex, timeout);
+	else
+		SDL_CondWait(_notifyCond, _mutex);
+}
+
+int SDLCALL SdlWorkerThreads::threadEntry(void *arg) {
+	SdlWorkerThreads *threads = (SdlWorkerThreads *)arg;
+	assert(threads);
+	threads->_proc(threads->_param);
+	return 0;
+}
+
+#endif
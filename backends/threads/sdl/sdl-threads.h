@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_THREADS_SDL_H
+#define BACKENDS_THREADS_SDL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+
+/**
+ * Threads of the SDL backend, which sleep until their owner has work for
+ * them.
+ *
+ * Each thread runs the proc passed to start(). The proc loops on wait()
+ * and returns once wait() returns false. The owner wakes the threads up
+ * with wakeUp(). It can wait for them with waitForThreads(), which
+ * returns once a thread called notify(). Both sides hold the lock while
+ * they look at or change the state they share.
+ */
+class SdlWorkerThreads {
+public:
+	enum {
+		MAX_THREADS = 16
+	};
+
+	typedef void (*ThreadProc)(void *param);
+
+	SdlWorkerThreads();
+	/** Stops the threads, if the owner did not do so already. */
+	~SdlWorkerThreads();
+
+	/**
+	 * Starts numThreads threads, which call proc(param).
+	 * @return the number of threads which could be started
+	 */
+	int start(ThreadProc proc, void *param, int numThreads = 1);
+
+	/**
+	 * Makes wait() return false and waits until all threads returned. The
+	 * owner has to call this before the state the threads use goes away.
+	 */
+	void stop();
+
+	/** Returns whether start() started any threads which were not stopped. */
+	bool isRunning() const { return _numThreads > 0; }
+
+	void lock();
+	void unlock();
+
+	/**
+	 * Wakes up the threads in wait(). If none is waiting, the next call
+	 * of wait() returns right away. Must be called without the lock held.
+	 */
+	void wakeUp();
+
+	/**
+	 * Called by the threads with the lock held. Waits until wakeUp() or
+	 * stop() is called.
+	 * @param timeout	maximum time to wait in milliseconds, or -1 to
+	 *                  wait without a limit
+	 * @return false if the thread should return
+	 */
+	bool wait(int32 timeout = -1);
+
+	/**
+	 * Called by the threads to wake up the owner in waitForThreads(). Must
+	 * be called without the lock held.
+	 */
+	void notify();
+
+	/**
+	 * Called by the owner with the lock held. Waits until a thread calls
+	 * notify().
+	 * @param timeout	maximum time to wait in milliseconds, or -1 to
+	 *                  wait without a limit
+	 */
+	void waitForThreads(int32 timeout = -1);
+
+private:
+	SDL_Thread *_threads[MAX_THREADS];
+	int _numThreads;
+
+	ThreadProc _proc;
+	void *_param;
+
+	SDL_mutex *_mutex;
+	SDL_cond *_wakeCond;
+	SDL_cond *_notifyCond;
+	bool _wakeUp;
+	bool _quit;
+
+	static int SDLCALL threadEntry(void *arg);
+};
+
+#endif
@@ -21,6 +21,7 @@
 
 #include "common/scummsys.h"
 #include "backends/timer/default/default-timer.h"
+#include "common/debug.h"
 #include "common/util.h"
 #include "common/system.h"
 
@@ -30,83 +31,132 @@ struct TimerSlot {
 	void *refCon;
 	uint32 interval;	// in microseconds
 
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
+	uint32 nextFireTime;	// in microseconds
+	uint32 order;	// orders timers which are due at the same time
 
-	TimerSlot *next;
+	// Statistics, all times in microseconds
+	uint32 numCalls;
+	uint32 lastCallTime;
+	uint32 maxLateness;
+	uint32 maxJitter;
+	double totalLateness;
+	double totalJitter;
 };
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
-
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = 0;
+/**
+ * Returns whether slot a is due before slot b. Times are compared through
+ * their difference, so that wrapping of the microsecond clock (about every
+ * 71 minutes) does not matter.
+ */
+static bool isDueBefore(const TimerSlot *a, const TimerSlot *b) {
+	const int32 diff = (int32)(a->nextFireTime - b->nextFireTime);
+	if (diff != 0)
+		return diff < 0;
+	return (int32)(a->order - b->order) < 0;
+}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
-	while (true) {
-		assert(slot);
-		if (slot->next == 0 || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
+static void printTimerStats(const TimerSlot *slot) {
+	if (slot->numCalls == 0) {
+		debug(2, "Timer %p (interval %d us): never called", slot->refCon, slot->interval);
+		return;
 	}
+
+	debug(2, "Timer %p (interval %d us): %d calls, lateness avg %d us max %d us, jitter avg %d us max %d us",
+		slot->refCon, slot->interval, slot->numCalls,
+		(int)(slot->totalLateness / slot->numCalls), slot->maxLateness,
+		slot->numCalls > 1 ? (int)(slot->totalJitter / (slot->numCalls - 1)) : 0, slot->maxJitter);
 }
 
 
 DefaultTimerManager::DefaultTimerManager() :
 	_timerHandler(0),
-	_head(0) {
-
-	_head = new TimerSlot();
-	memset(_head, 0, sizeof(TimerSlot));
+	_nextOrder(0),
+	_numWakeups(0) {
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
+	debug(2, "Timer manager: %d wakeups", _numWakeups);
+	for (uint i = 0; i < _heap.size(); ++i) {
+		printTimerStats(_heap[i]);
+		delete _heap[i];
+	}
+	_heap.clear();
+}
+
+void DefaultTimerManager::pushSlot(TimerSlot *slot) {
+	slot->order = _nextOrder++;
+
+	uint pos = _heap.size();
+	_heap.push_back(slot);
+	while (pos > 0) {
+		const uint parent = (pos - 1) / 2;
+		if (!isDueBefore(slot, _heap[parent]))
+			break;
+		_heap[pos] = _heap[parent];
+		pos = parent;
+	}
+	_heap[pos] = slot;
+}
+
+void DefaultTimerManager::siftDown(uint pos) {
+	const uint size = _heap.size();
+	TimerSlot *slot = _heap[pos];
+
+	while (true) {
+		uint child = 2 * pos + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && isDueBefore(_heap[child + 1], _heap[child]))
+			++child;
+		if (!isDueBefore(_heap[child], slot))
+			break;
+		_heap[pos] = _heap[child];
+		pos = child;
 	}
-	_head = 0;
+	_heap[pos] = slot;
 }
 
 void DefaultTimerManager::handler() {
+	runDueTimers(g_system->getMillis() * 1000);
+}
+
+int32 DefaultTimerManager::runDueTimers(uint32 curTime) {
 	Common::StackLock lock(_mutex);
 
-	const uint32 curTime = g_system->getMillis();
+	++_numWakeups;
 
 	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
+	while (!_heap.empty()) {
+		TimerSlot *slot = _heap[0];
+		const int32 lateness = (int32)(curTime - slot->nextFireTime);
+		if (lateness < 0)
+			return -lateness;
+
+		// Update the statistics
+		if (slot->numCalls > 0) {
+			const uint32 jitter = ABS((int32)(curTime - slot->lastCallTime - slot->interval));
+			slot->totalJitter += jitter;
+			slot->maxJitter = MAX(slot->maxJitter, jitter);
+		}
+		slot->numCalls++;
+		slot->lastCallTime = curTime;
+		slot->totalLateness += lateness;
+		slot->maxLateness = MAX(slot->maxLateness, (uint32)lateness);
 
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
+		// Update the fire time and move the TimerSlot down the heap.
 		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
-		}
-		insertPrioQueue(_head, slot);
+		slot->nextFireTime += slot->interval;
+		slot->order = _nextOrder++;
+		siftDown(0);
 
 		// Invoke the timer callback
 		assert(slot->callback);
 		slot->callback(slot->refCon);
-
-		// Look at the next scheduled timer
-		slot = _head->next;
 	}
+
+	return -1;
 }
 
 bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, void *refCon) {
@@ -114,12 +164,11 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	Common::StackLock lock(_mutex);
 
 	TimerSlot *slot = new TimerSlot;
+	memset(slot, 0, sizeof(TimerSlot));
 	slot->callback = callback;
 	slot->refCon = refCon;
 	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = 0;
+	slot->nextFireTime = g_system->getMillis() * 1000 + interval;
 
 	// FIXME: It seems we do allow the client to add one callback multiple times over here,
 	// but "removeTimerProc" will remove *all* added instances. We should either prevent
@@ -127,7 +176,8 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	// a specific timer proc entry.
 	// Probably we can safely just allow a single addition of a specific function once
 	// and just update our Timer documentation accordingly.
-	insertPrioQueue(_head, slot);
+	pushSlot(slot);
+	timersChanged();
 
 	return true;
 }
@@ -135,15 +185,21 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
+	uint size = 0;
+	for (uint i = 0; i < _heap.size(); ++i) {
+		if (_heap[i]->callback == callback) {
+			printTimerStats(_heap[i]);
+			delete _heap[i];
 		} else {
-			slot = slot->next;
+			_heap[size++] = _heap[i];
 		}
 	}
+
+	if (size == _heap.size())
+		return;
+
+	// Restore the heap order of the remaining slots
+	_heap.resize(size);
+	for (uint i = size / 2; i-- > 0; )
+		siftDown(i);
 }
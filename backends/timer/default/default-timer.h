@@ -23,15 +23,39 @@
 #define BACKENDS_TIMER_DEFAULT_H
 
 #include "common/timer.h"
+#include "common/array.h"
 #include "common/mutex.h"
 
 struct TimerSlot;
 
+/**
+ * Timer manager which keeps the installed timer procs in a binary heap,
+ * ordered by the time they are due next. Backends either call handler()
+ * at regular intervals, or run runDueTimers() from a thread of their own
+ * which sleeps until the next timer is due.
+ *
+ * For every timer proc, the manager keeps track of how late and how
+ * irregular its calls are. These statistics are printed at debug level 2
+ * when the timer proc is removed.
+ */
 class DefaultTimerManager : public Common::TimerManager {
 private:
 	Common::Mutex _mutex;
 	void *_timerHandler;
-	TimerSlot *_head;
+	Common::Array<TimerSlot *> _heap;
+	uint32 _nextOrder;
+	uint32 _numWakeups;
+
+	void pushSlot(TimerSlot *slot);
+	void siftDown(uint pos);
+
+protected:
+	/**
+	 * Called whenever a timer proc has been installed, so that backends
+	 * which sleep until the next timer is due can wake up. The timer
+	 * mutex is held while this is called.
+	 */
+	virtual void timersChanged() {}
 
 public:
 	DefaultTimerManager();
@@ -43,6 +67,15 @@ public:
 	 * Timer callback, to be invoked at regular time intervals by the backend.
 	 */
 	void handler();
+
+	/**
+	 * Runs all timer procs which are due at the given time.
+	 *
+	 * @param curTime	the current time, in microseconds
+	 * @return the number of microseconds until the next timer proc is due,
+	 *         or -1 if no timer proc is installed
+	 */
+	int32 runDueTimers(uint32 curTime);
 };
 
 #endif
@@ -27,26 +27,58 @@
 
 #include "backends/timer/sdl/sdl-timer.h"
 
+#include "common/EventRecorder.h"
 #include "common/textconsole.h"
 
-static Uint32 timer_handler(Uint32 interval, void *param) {
-	((DefaultTimerManager *)param)->handler();
-	return interval;
-}
-
 SdlTimerManager::SdlTimerManager() {
 	// Initializes the SDL timer subsystem
 	if (SDL_InitSubSystem(SDL_INIT_TIMER) == -1) {
 		error("Could not initialize SDL: %s", SDL_GetError());
 	}
 
-	// Creates the timer callback
-	_timerID = SDL_AddTimer(10, &timer_handler, this);
+	// Creates the timer thread
+	if (!_timerThread.start(timerThreadProc, this))
+		error("Could not create timer thread: %s", SDL_GetError());
 }
 
 SdlTimerManager::~SdlTimerManager() {
-	// Removes the timer callback
-	SDL_RemoveTimer(_timerID);
+	// Stops the timer thread
+	_timerThread.stop();
+}
+
+void SdlTimerManager::timersChanged() {
+	// A new timer may be due before the one the thread is waiting for
+	_timerThread.wakeUp();
+}
+
+void SdlTimerManager::timerThread() {
+	while (true) {
+		// While recording or playing back, the timers are run from
+		// OSystem_SDL::delayMillis() instead, so that they always fire at
+		// the same points of the game.
+		//
+		// The heap is kept in microseconds, but SDL 1.2 has no clock finer
+		// than SDL_GetTicks(), so timers are only precise to 1 ms. The
+		// same clock has to be used as by handler() and installTimerProc(),
+		// which go through getMillis().
+		int32 delay = -1;
+		if (!g_eventRec.hasEngineThreadTimers())
+			delay = runDueTimers(SDL_GetTicks() * 1000);
+
+		// Round up, so that the timer is due when we wake up
+		_timerThread.lock();
+		const bool running = _timerThread.wait(delay >= 0 ? (delay + 999) / 1000 : -1);
+		_timerThread.unlock();
+
+		if (!running)
+			break;
+	}
+}
+
+void SdlTimerManager::timerThreadProc(void *param) {
+	SdlTimerManager *manager = (SdlTimerManager *)param;
+	assert(manager);
+	manager->timerThread();
 }
 
 #endif
@@ -25,11 +25,11 @@
 
 #include "backends/timer/default/default-timer.h"
 
-#include "backends/platform/sdl/sdl-sys.h"
+#include "backends/threads/sdl/sdl-threads.h"
 
 /**
- * SDL timer manager. Setups the timer callback for
- * DefaultTimerManager.
+ * SDL timer manager. Runs the timer procs of DefaultTimerManager from a
+ * thread of its own, which sleeps until the next timer proc is due.
  */
 class SdlTimerManager : public DefaultTimerManager {
 public:
@@ -37,7 +37,12 @@ public:
 	virtual ~SdlTimerManager();
 
 protected:
-	SDL_TimerID _timerID;
+	virtual void timersChanged();
+
+	SdlWorkerThreads _timerThread;
+
+	void timerThread();
+	static void timerThreadProc(void *param);
 };
 
 
@@ -27,6 +27,7 @@
 
 #include <limits.h>
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
 #include "base/plugins.h"
@@ -132,6 +133,12 @@ static const char HELP_STRING[] =
 	"  --dimuse-tempo=NUM       Set internal Digital iMuse tempo (10 - 100) per second\n"
 	"                           (default: 10)\n"
 #endif
+#endif
+#ifdef USE_BENCH_DRIVER
+	"  --bench-frames=NUM       Stop the benchmark after NUM frames (default: 0 =\n"
+	"                           when the played back recording ends)\n"
+	"  --bench-log=FILE         Write the frame timings to FILE, as JSON if its name\n"
+	"                           ends with .json and as CSV otherwise\n"
 #endif
 	"\n"
 	"The meaning of boolean long options can be inverted by prefixing them with\n"
@@ -169,6 +176,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("gfx_mode", "normal");
 	ConfMan.registerDefault("render_mode", "default");
 	ConfMan.registerDefault("desired_screen_aspect_ratio", "auto");
+	ConfMan.registerDefault("threaded_scaler", false);
+	ConfMan.registerDefault("scaler_threads", 2);
 
 	// Sound & Music
 	ConfMan.registerDefault("music_volume", 192);
@@ -185,6 +194,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
 
+	ConfMan.registerDefault("resampler", "linear");
+
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
 	ConfMan.registerDefault("gm_device", "null");
@@ -233,6 +244,13 @@ void registerDefaults() {
 	ConfMan.registerDefault("record_file_name", "record.bin");
 	ConfMan.registerDefault("record_temp_file_name", "record.tmp");
 	ConfMan.registerDefault("record_time_file_name", "record.time");
+	ConfMan.registerDefault("record_checksum_file_name", "record.check");
+	ConfMan.registerDefault("record_checksum_interval", 30);
+
+#ifdef USE_BENCH_DRIVER
+	ConfMan.registerDefault("bench_frames", 0);
+	ConfMan.registerDefault("bench_log", "bench.csv");
+#endif
 
 }
 
@@ -544,6 +562,20 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION("record-time-file-name")
 			END_OPTION
 
+			DO_LONG_OPTION("record-checksum-file-name")
+			END_OPTION
+
+			DO_LONG_OPTION_INT("record-checksum-interval")
+			END_OPTION
+
+#ifdef USE_BENCH_DRIVER
+			DO_LONG_OPTION_INT("bench-frames")
+			END_OPTION
+
+			DO_LONG_OPTION("bench-log")
+			END_OPTION
+#endif
+
 #ifdef IPHONE
 			// This is automatically set when launched from the Springboard.
 			DO_LONG_OPTION_OPT("launchedFromSB", 0)
@@ -700,6 +732,7 @@ static void runDetectorTest() {
 	const Common::ConfigManager::DomainMap &domains = ConfMan.getGameDomains();
 	Common::ConfigManager::DomainMap::const_iterator iter = domains.begin();
 	int success = 0, failure = 0;
+	uint32 hits = 0, misses = 0, totalTime = 0;
 	for (iter = domains.begin(); iter != domains.end(); ++iter) {
 		Common::String name(iter->_key);
 		Common::String gameid(iter->_value.getVal("gameid"));
@@ -721,7 +754,17 @@ static void runDetectorTest() {
 			continue;
 		}
 
+		DetectionCache::instance().resetStats();
+		const uint32 startTime = g_system->getMillis();
 		GameList candidates(EngineMan.detectGames(files));
+		const uint32 time = g_system->getMillis() - startTime;
+		hits += DetectionCache::instance().getHits();
+		misses += DetectionCache::instance().getMisses();
+		totalTime += time;
+		printf(" ... took %d ms, %d of %d file MD5s were cached\n", time,
+		       DetectionCache::instance().getHits(),
+		       DetectionCache::instance().getHits() + DetectionCache::instance().getMisses());
+
 		bool gameidDiffers = false;
 		GameList::iterator x;
 		for (x = candidates.begin(); x != candidates.end(); ++x) {
@@ -757,6 +800,8 @@ static void runDetectorTest() {
 	int total = domains.size();
 	printf("Detector test run: %d fail, %d success, %d skipped, out of %d\n",
 			failure, success, total - failure - success, total);
+	printf("Detection took %d ms, %d of %d file MD5s were cached (%d%%)\n",
+			totalTime, hits, hits + misses, (hits + misses) ? hits * 100 / (hits + misses) : 0);
 }
 #endif
 
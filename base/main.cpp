@@ -44,6 +44,7 @@
 #include "common/events.h"
 #include "common/EventRecorder.h"
 #include "common/fs.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "common/tokenizer.h"
@@ -212,6 +213,11 @@ static Common::Error runGame(const EnginePlugin *plugin, OSystem &system, const
 	// Free up memory
 	delete engine;
 
+	// Savefiles may still be written in the background, after the engine
+	// was told that saving succeeded. Report if this failed.
+	if (result.getCode() == Common::kNoError)
+		result = system.getSavefileManager()->waitForPendingSaves();
+
 	// We clear all debug levels again even though the engine should do it
 	DebugMan.clearAllDebugChannels();
 
@@ -460,6 +466,10 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		setupGraphics(system);
 		launcherDialog();
 	}
+
+	// Finish the recording, or print the playback statistics
+	Common::EventRecorder::destroy();
+
 	PluginManager::instance().unloadAllPlugins();
 	PluginManager::destroy();
 	GUI::GuiManager::destroy();
@@ -541,6 +541,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 
 namespace Common {
@@ -624,6 +625,9 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	// Keep the MD5s the plugins computed for the next detection run
+	DetectionCache::instance().flush();
 	return candidates;
 }
 
@@ -26,13 +26,17 @@
 #include "common/random.h"
 #include "common/savefile.h"
 #include "common/textconsole.h"
+#include "common/debug.h"
+
+#include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Common {
 
 DECLARE_SINGLETON(EventRecorder);
 
 #define RECORD_SIGNATURE 0x54455354
-#define RECORD_VERSION 1
+#define RECORD_VERSION 2
 
 void readRecord(SeekableReadStream *inFile, uint32 &diff, Event &event) {
 	diff = inFile->readUint32LE();
@@ -88,11 +92,46 @@ void writeRecord(WriteStream *outFile, uint32 diff, const Event &event) {
 	}
 }
 
+/**
+ * Computes an Adler-32 checksum of the game screen and, for paletted
+ * screens, of the palette.
+ */
+static uint32 computeScreenChecksum() {
+	uint32 a = 1, b = 0;
+
+	Graphics::Surface *screen = g_system->lockScreen();
+	const bool paletted = screen && screen->format.bytesPerPixel == 1;
+	if (screen && screen->pixels) {
+		const uint lineSize = screen->w * screen->format.bytesPerPixel;
+		for (int y = 0; y < screen->h; ++y) {
+			const byte *line = (const byte *)screen->getBasePtr(0, y);
+			for (uint x = 0; x < lineSize; ++x) {
+				a = (a + line[x]) % 65521;
+				b = (b + a) % 65521;
+			}
+		}
+	}
+	g_system->unlockScreen();
+
+	if (paletted) {
+		byte palette[3 * 256];
+		g_system->getPaletteManager()->grabPalette(palette, 0, 256);
+		for (uint i = 0; i < sizeof(palette); ++i) {
+			a = (a + palette[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+	}
+
+	return (b << 16) | a;
+}
+
 EventRecorder::EventRecorder() {
 	_recordFile = NULL;
 	_recordTimeFile = NULL;
+	_recordChecksumFile = NULL;
 	_playbackFile = NULL;
 	_playbackTimeFile = NULL;
+	_playbackChecksumFile = NULL;
 	_timeMutex = g_system->createMutex();
 	_recorderMutex = g_system->createMutex();
 
@@ -100,6 +139,15 @@ EventRecorder::EventRecorder() {
 	_lastEventCount = 0;
 	_lastMillis = 0;
 
+	_playbackVersion = RECORD_VERSION;
+	_fastPlayback = false;
+	_virtualDelay = 0;
+	_playbackStarted = false;
+	_checksumInterval = 0;
+	_frameCount = 0;
+	_checksumCount = 0;
+	_checksumMismatches = 0;
+
 	_recordMode = kPassthrough;
 }
 
@@ -114,6 +162,9 @@ void EventRecorder::init() {
 	} else {
 		if (recordModeString.compareToIgnoreCase("playback") == 0) {
 			_recordMode = kRecorderPlayback;
+		} else if (recordModeString.compareToIgnoreCase("fast_playback") == 0) {
+			_recordMode = kRecorderPlayback;
+			_fastPlayback = true;
 		} else {
 			_recordMode = kPassthrough;
 		}
@@ -131,6 +182,10 @@ void EventRecorder::init() {
 	if (_recordTimeFileName.empty()) {
 		_recordTimeFileName = "record.time";
 	}
+	_recordChecksumFileName = ConfMan.get("record_checksum_file_name");
+	if (_recordChecksumFileName.empty()) {
+		_recordChecksumFileName = "record.check";
+	}
 
 	// recorder stuff
 	if (_recordMode == kRecorderRecord) {
@@ -139,6 +194,15 @@ void EventRecorder::init() {
 		_recordFile = g_system->getSavefileManager()->openForSaving(_recordTempFileName);
 		_recordTimeFile = g_system->getSavefileManager()->openForSaving(_recordTimeFileName);
 		_recordSubtitles = ConfMan.getBool("subtitles");
+
+		_checksumInterval = ConfMan.getInt("record_checksum_interval");
+		if (_checksumInterval) {
+			_recordChecksumFile = g_system->getSavefileManager()->openForSaving(_recordChecksumFileName);
+			if (_recordChecksumFile)
+				_recordChecksumFile->writeUint32LE(_checksumInterval);
+			else
+				_checksumInterval = 0;
+		}
 	}
 
 	uint32 sign;
@@ -158,6 +222,13 @@ void EventRecorder::init() {
 			warning("Cannot open playback time file %s. Playback was switched off", _recordTimeFileName.c_str());
 			_recordMode = kPassthrough;
 		}
+
+		// Checksums are optional, older recordings don't have them
+		_playbackChecksumFile = g_system->getSavefileManager()->openForLoading(_recordChecksumFileName);
+		if (_playbackChecksumFile) {
+			_checksumInterval = _playbackChecksumFile->readUint32LE();
+			readNextChecksum();
+		}
 	}
 
 	if (_recordMode == kRecorderPlayback) {
@@ -166,7 +237,10 @@ void EventRecorder::init() {
 			error("Unknown record file signature");
 		}
 
-		_playbackFile->readUint32LE(); // version
+		_playbackVersion = _playbackFile->readUint32LE();
+		if (_playbackVersion < 1 || _playbackVersion > RECORD_VERSION) {
+			error("Unsupported record file version %u", _playbackVersion);
+		}
 
 		// conf vars
 		ConfMan.setBool("subtitles", _playbackFile->readByte() != 0);
@@ -197,6 +271,15 @@ void EventRecorder::deinit() {
 	g_system->getEventManager()->getEventDispatcher()->unregisterSource(this);
 	g_system->getEventManager()->getEventDispatcher()->unregisterObserver(this);
 
+	if (_recordMode == kRecorderPlayback && _playbackStarted) {
+		const double gameTime = (_lastMillis - _playbackStartMillis) / 1000.0;
+		const double realTime = (_lastRealMillis - _playbackStartRealMillis) / 1000.0;
+		debug(1, "Played back %.1f s of game time in %.1f s (%.1f game seconds per second)",
+			gameTime, realTime, realTime > 0 ? gameTime / realTime : 0.0);
+		if (_checksumCount)
+			debug(1, "%u of %u screen checksums matched the recording", _checksumCount - _checksumMismatches, _checksumCount);
+	}
+
 	g_system->lockMutex(_timeMutex);
 	g_system->lockMutex(_recorderMutex);
 	_recordMode = kPassthrough;
@@ -205,6 +288,14 @@ void EventRecorder::deinit() {
 
 	delete _playbackFile;
 	delete _playbackTimeFile;
+	delete _playbackChecksumFile;
+	_playbackChecksumFile = NULL;
+
+	if (_recordChecksumFile != NULL) {
+		_recordChecksumFile->finalize();
+		delete _recordChecksumFile;
+		_recordChecksumFile = NULL;
+	}
 
 	if (_recordFile != NULL) {
 		_recordFile->finalize();
@@ -290,6 +381,9 @@ void EventRecorder::processMillis(uint32 &millis) {
 	}
 
 	if (_recordMode == kRecorderPlayback) {
+		// The backend passes its own clock, which we use for statistics
+		_lastRealMillis = millis;
+
 		if (_recordTimeCount > _playbackTimeCount) {
 			d = _playbackTimeFile->readByte();
 			if (d == 0xff) {
@@ -297,6 +391,17 @@ void EventRecorder::processMillis(uint32 &millis) {
 			}
 			millis = _lastMillis + d;
 			_playbackTimeCount++;
+		} else if (_fastPlayback) {
+			// Beyond the recorded times, let the clock jump over all
+			// delays since the last call.
+			millis = _lastMillis + _virtualDelay;
+		}
+		_virtualDelay = 0;
+
+		if (!_playbackStarted) {
+			_playbackStarted = true;
+			_playbackStartMillis = millis;
+			_playbackStartRealMillis = _lastRealMillis;
 		}
 	}
 
@@ -304,13 +409,70 @@ void EventRecorder::processMillis(uint32 &millis) {
 	g_system->unlockMutex(_timeMutex);
 }
 
+bool EventRecorder::isPlaybackFinished() {
+	if (_recordMode != kRecorderPlayback)
+		return false;
+
+	StackLock lock(_recorderMutex);
+	return !_hasPlaybackEvent && _playbackCount >= _recordCount;
+}
+
+bool EventRecorder::processDelayMillis(uint msecs) {
+	if (_recordMode != kRecorderPlayback || !_fastPlayback)
+		return false;
+
+	g_system->lockMutex(_timeMutex);
+	_virtualDelay += msecs;
+	g_system->unlockMutex(_timeMutex);
+	return true;
+}
+
+void EventRecorder::processScreenUpdate() {
+	if (_recordMode == kPassthrough || !_checksumInterval)
+		return;
+
+	if (++_frameCount % _checksumInterval)
+		return;
+
+	const uint32 checksum = computeScreenChecksum();
+
+	if (_recordMode == kRecorderRecord) {
+		_recordChecksumFile->writeUint32LE(_frameCount);
+		_recordChecksumFile->writeUint32LE(checksum);
+		return;
+	}
+
+	if (!_playbackChecksumFile || _nextChecksumFrame != _frameCount)
+		return;
+
+	_checksumCount++;
+	if (checksum != _nextChecksum) {
+		// Once diverged, the rest will mismatch as well, so only report
+		// the first one.
+		if (!_checksumMismatches)
+			warning("Playback diverged from the recording: screen checksum of frame %u is %08x, expected %08x",
+				_frameCount, checksum, _nextChecksum);
+		_checksumMismatches++;
+	}
+
+	readNextChecksum();
+}
+
+void EventRecorder::readNextChecksum() {
+	_nextChecksumFrame = _playbackChecksumFile->readUint32LE();
+	_nextChecksum = _playbackChecksumFile->readUint32LE();
+	if (_playbackChecksumFile->eos() || _playbackChecksumFile->err())
+		_nextChecksumFrame = 0;
+}
+
 bool EventRecorder::notifyEvent(const Event &ev) {
 	if (_recordMode != kRecorderRecord)
 		return false;
 
 	StackLock lock(_recorderMutex);
-	++_eventCount;
 
+	// Events are stamped with the number of dispatch runs so far, which
+	// pollEvent() counts.
 	writeRecord(_recordFile, _eventCount - _lastEventCount, ev);
 
 	_recordCount++;
@@ -320,11 +482,22 @@ bool EventRecorder::notifyEvent(const Event &ev) {
 }
 
 bool EventRecorder::pollEvent(Event &ev) {
-	if (_recordMode != kRecorderPlayback)
+	if (_recordMode == kPassthrough)
 		return false;
 
 	StackLock lock(_recorderMutex);
-	++_eventCount;
+
+	// We are polled once per dispatch run, after the backend's event
+	// source. So all events of this run have already been recorded.
+	if (_recordMode == kRecorderRecord) {
+		++_eventCount;
+		return false;
+	}
+
+	// Version 1 recordings stamped events with the number of events
+	// recorded before them, which was replayed by counting polls.
+	if (_playbackVersion == 1)
+		++_eventCount;
 
 	if (!_hasPlaybackEvent) {
 		if (_recordCount > _playbackCount) {
@@ -356,6 +529,10 @@ bool EventRecorder::pollEvent(Event &ev) {
 		}
 	}
 
+	// No more events in this dispatch run, we are polled again only in
+	// the next one.
+	if (_playbackVersion != 1)
+		++_eventCount;
 	return false;
 }
 
@@ -56,6 +56,37 @@ public:
 	/** TODO: Add documentation, this is only used by the backend */
 	void processMillis(uint32 &millis);
 
+	/**
+	 * Returns whether all events of the recording have been played back.
+	 * This is always false unless a recording is being played back.
+	 */
+	bool isPlaybackFinished();
+
+	/**
+	 * To be called by backends from delayMillis(), before sleeping.
+	 *
+	 * @return true if the backend should not sleep at all. This is the
+	 *         case when a recording is played back in fast mode: the
+	 *         clock then jumps ahead instead, so that the recording is
+	 *         replayed as fast as possible.
+	 */
+	bool processDelayMillis(uint msecs);
+
+	/**
+	 * Returns whether backends have to run their timer procs from
+	 * delayMillis(), on the engine thread, instead of from a thread of
+	 * their own. This is the case while recording or playing back, so that
+	 * timers fire at the same points of the game in both.
+	 */
+	bool hasEngineThreadTimers() const { return _recordMode != kPassthrough; }
+
+	/**
+	 * To be called by backends on every updateScreen(). Every few frames,
+	 * a checksum of the screen is written to the recording, or compared
+	 * to the recorded one during playback.
+	 */
+	void processScreenUpdate();
+
 private:
 	bool notifyEvent(const Event &ev);
 	bool pollEvent(Event &ev);
@@ -74,6 +105,7 @@ private:
 	volatile uint32 _recordTimeCount;
 	WriteStream *_recordFile;
 	WriteStream *_recordTimeFile;
+	WriteStream *_recordChecksumFile;
 	MutexRef _timeMutex;
 	MutexRef _recorderMutex;
 	volatile uint32 _lastMillis;
@@ -85,6 +117,24 @@ private:
 	Event _playbackEvent;
 	SeekableReadStream *_playbackFile;
 	SeekableReadStream *_playbackTimeFile;
+	SeekableReadStream *_playbackChecksumFile;
+	uint32 _playbackVersion;
+
+	bool _fastPlayback;
+	volatile uint32 _virtualDelay;
+	bool _playbackStarted;
+	uint32 _playbackStartMillis;
+	uint32 _playbackStartRealMillis;
+	uint32 _lastRealMillis;
+
+	uint32 _checksumInterval;
+	uint32 _frameCount;
+	uint32 _nextChecksumFrame;
+	uint32 _nextChecksum;
+	uint32 _checksumCount;
+	uint32 _checksumMismatches;
+
+	void readNextChecksum();
 
 	volatile uint32 _eventCount;
 	volatile uint32 _lastEventCount;
@@ -98,6 +148,7 @@ private:
 	String _recordFileName;
 	String _recordTempFileName;
 	String _recordTimeFileName;
+	String _recordChecksumFileName;
 };
 
 } // End of namespace Common
@@ -23,7 +23,7 @@
 // Based on eos' BitStream implementation
 
 #include "common/bitstream.h"
-#include "common/memstream.h"
+#include "common/endian.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -42,59 +42,60 @@ void BitStream::skip(uint32 n) {
 }
 
 
-BitStreamBE::BitStreamBE(SeekableReadStream &stream, uint32 bitCount) : _value(0), _inValue(0) {
+BitStreamBE::BitStreamBE(SeekableReadStream &stream, uint32 bitCount) : _pos(0) {
 	if ((bitCount % 8) != 0)
 		error("Big-endian bit stream size has to be divisible by 8");
 
 	// Read the number of bytes of the stream
 
-	uint32 byteSize = bitCount / 8;
-	byte *data = (byte *)malloc(byteSize);
+	_size = bitCount / 8;
+	_data = (byte *)malloc(_size);
 
-	if (stream.read(data, byteSize) != byteSize) {
-		free(data);
+	if (stream.read(_data, _size) != _size) {
+		free(_data);
 		error("Bad BitStreamBE size");
 	}
-
-	_stream = new MemoryReadStream(data, byteSize, DisposeAfterUse::YES);
 }
 
-BitStreamBE::BitStreamBE(const byte *data, uint32 bitCount) : _value(0), _inValue(0) {
+BitStreamBE::BitStreamBE(const byte *data, uint32 bitCount) : _pos(0) {
 	if ((bitCount % 8) != 0)
 		error("Big-endian bit stream size has to be divisible by 8");
 
 	// Copy the number of bytes from the data array
 
-	uint32 byteSize = bitCount / 8;
-	byte *dataN = (byte *)malloc(byteSize);
-
-	memcpy(dataN, data, byteSize);
+	_size = bitCount / 8;
+	_data = (byte *)malloc(_size);
 
-	_stream = new MemoryReadStream(dataN, byteSize, DisposeAfterUse::YES);
+	memcpy(_data, data, _size);
 }
 
 BitStreamBE::~BitStreamBE() {
-	delete _stream;
+	free(_data);
 }
 
-uint32 BitStreamBE::getBit() {
-	if (_inValue == 0) {
-		// Need to get new byte
+uint32 BitStreamBE::getWord(uint32 offset) const {
+	if (offset + 4 <= _size)
+		return READ_BE_UINT32(_data + offset);
 
-		if (_stream->eos())
-			error("End of bit stream reached");
+	uint32 v = 0;
+	for (uint32 i = 0; i < 4; i++)
+		v = (v << 8) | ((offset + i < _size) ? _data[offset + i] : 0);
 
-		_value = _stream->readByte();
-	}
+	return v;
+}
 
-	// Get the current bit
-	int b = ((_value & 0x80) == 0) ? 0 : 1;
+uint32 BitStreamBE::getBit() {
+	// Like the stream based implementation before, we hand out the zero
+	// bits of one more byte before complaining.
+	if (_pos >= (_size + 1) * 8)
+		error("End of bit stream reached");
 
-	// Shift to the next bit
-	_value <<= 1;
+	// Get the current bit
+	uint32 b = 0;
+	if ((_pos >> 3) < _size)
+		b = (_data[_pos >> 3] >> (7 - (_pos & 7))) & 1;
 
-	// Increase the position within the current byte
-	_inValue = (_inValue + 1) % 8;
+	_pos++;
 
 	return b;
 }
@@ -103,10 +104,8 @@ uint32 BitStreamBE::getBits(uint32 n) {
 	if (n > 32)
 		error("Too many bits requested to be read");
 
-	// Read the number of bits
-	uint32 v = 0;
-	while (n-- > 0)
-		v = (v << 1) | getBit();
+	uint32 v = peekBits(n);
+	skip(n);
 
 	return v;
 }
@@ -115,72 +114,93 @@ void BitStreamBE::addBit(uint32 &x, uint32 n) {
 	x = (x << 1) | getBit();
 }
 
-uint32 BitStreamBE::pos() const {
-	if (_stream->pos() == 0)
+uint32 BitStreamBE::peekBits(uint32 n) {
+	if (n > 32)
+		error("Too many bits requested to be read");
+	if (n == 0)
 		return 0;
 
-	uint32 p = (_inValue == 0) ? _stream->pos() : (_stream->pos() - 1);
-	return p * 8 + _inValue;
+	const uint32 offset = _pos >> 3;
+	const uint32 shift  = _pos & 7;
+
+	uint32 v = getWord(offset) << shift;
+	if (shift)
+		v |= ((offset + 4 < _size) ? _data[offset + 4] : 0) >> (8 - shift);
+
+	return v >> (32 - n);
+}
+
+void BitStreamBE::skip(uint32 n) {
+	if (n > (_size + 1) * 8 - _pos)
+		error("End of bit stream reached");
+
+	_pos += n;
+}
+
+uint32 BitStreamBE::pos() const {
+	return _pos;
 }
 
 uint32 BitStreamBE::size() const {
-	return _stream->size() * 8;
+	return _size * 8;
 }
 
 
-BitStream32LE::BitStream32LE(SeekableReadStream &stream, uint32 bitCount) : _value(0), _inValue(0) {
+BitStream32LE::BitStream32LE(SeekableReadStream &stream, uint32 bitCount) : _pos(0) {
 	if ((bitCount % 32) != 0)
 		error("32bit little-endian bit stream size has to be divisible by 32");
 
 	// Read the number of bytes of the stream
 
-	uint32 byteSize = bitCount / 8;
-	byte *data = (byte *)malloc(byteSize);
+	_size = bitCount / 8;
+	_data = (byte *)malloc(_size);
 
-	if (stream.read(data, byteSize) != byteSize) {
-		free(data);
+	if (stream.read(_data, _size) != _size) {
+		free(_data);
 		error("Bad BitStream32LE size");
 	}
-
-	_stream = new MemoryReadStream(data, byteSize, DisposeAfterUse::YES);
 }
 
-BitStream32LE::BitStream32LE(const byte *data, uint32 bitCount) : _value(0), _inValue(0) {
+BitStream32LE::BitStream32LE(const byte *data, uint32 bitCount) : _pos(0) {
 	if ((bitCount % 32) != 0)
 		error("32bit little-endian bit stream size has to be divisible by 32");
 
 	// Copy the number of bytes from the data array
 
-	uint32 byteSize = bitCount / 8;
-	byte *dataN = (byte *)malloc(byteSize);
-
-	memcpy(dataN, data, byteSize);
+	_size = bitCount / 8;
+	_data = (byte *)malloc(_size);
 
-	_stream = new MemoryReadStream(dataN, byteSize, DisposeAfterUse::YES);
+	memcpy(_data, data, _size);
 }
 
 BitStream32LE::~BitStream32LE() {
-	delete _stream;
+	free(_data);
 }
 
-uint32 BitStream32LE::getBit() {
-	if (_inValue == 0) {
-		// Need to get new 32bit value
+uint32 BitStream32LE::getWord(uint32 offset) const {
+	if (offset + 4 <= _size)
+		return READ_LE_UINT32(_data + offset);
 
-		if (_stream->eos())
-			error("End of bit stream reached");
+	uint32 v = 0;
+	for (uint32 i = 0; i < 4; i++)
+		v |= ((offset + i < _size) ? (uint32)_data[offset + i] : 0) << (8 * i);
 
-		_value = _stream->readUint32LE();
-	}
+	return v;
+}
 
-	// Get the current bit
-	int b = ((_value & 1) == 0) ? 0 : 1;
+uint32 BitStream32LE::getBit() {
+	// Like the stream based implementation before, we hand out the zero
+	// bits of one more 32bit value before complaining.
+	if (_pos >= (_size + 4) * 8)
+		error("End of bit stream reached");
 
-	// Shift to the next bit
-	_value >>= 1;
+	// Since the 32bit values are little-endian, their bits are handed out
+	// in the same order as the bits of the single bytes.
+	uint32 b = 0;
+	if ((_pos >> 3) < _size)
+		b = (_data[_pos >> 3] >> (_pos & 7)) & 1;
 
-	// Increase the position within the current byte
-	_inValue = (_inValue + 1) % 32;
+	_pos++;
 
 	return b;
 }
@@ -189,12 +209,9 @@ uint32 BitStream32LE::getBits(uint32 n) {
 	if (n > 32)
 		error("Too many bits requested to be read");
 
-	// Read the number of bits
-	uint32 v = 0;
-	for (uint32 i = 0; i < n; i++)
-		v = (v >> 1) | (((uint32) getBit()) << 31);
+	uint32 v = peekBits(n);
+	skip(n);
 
-	v >>= (32 - n);
 	return v;
 }
 
@@ -202,16 +219,35 @@ void BitStream32LE::addBit(uint32 &x, uint32 n) {
 	x = (x & ~(1 << n)) | (getBit() << n);
 }
 
-uint32 BitStream32LE::pos() const {
-	if (_stream->pos() == 0)
+uint32 BitStream32LE::peekBits(uint32 n) {
+	if (n > 32)
+		error("Too many bits requested to be read");
+	if (n == 0)
 		return 0;
 
-	uint32 p = ((_inValue == 0) ? _stream->pos() : (_stream->pos() - 1)) & 0xFFFFFFFC;
-	return p * 8 + _inValue;
+	const uint32 offset = _pos >> 3;
+	const uint32 shift  = _pos & 7;
+
+	uint32 v = getWord(offset) >> shift;
+	if (shift)
+		v |= ((offset + 4 < _size) ? (uint32)_data[offset + 4] : 0) << (32 - shift);
+
+	return (n == 32) ? v : (v & (((uint32)1 << n) - 1));
+}
+
+void BitStream32LE::skip(uint32 n) {
+	if (n > (_size + 4) * 8 - _pos)
+		error("End of bit stream reached");
+
+	_pos += n;
+}
+
+uint32 BitStream32LE::pos() const {
+	return _pos;
 }
 
 uint32 BitStream32LE::size() const {
-	return _stream->size() * 8;
+	return _size * 8;
 }
 
 } // End of namespace Common
@@ -26,6 +26,10 @@
 #define COMMON_BITSTREAM_H
 
 #include "common/scummsys.h"
+#include "common/endian.h"
+#include "common/stream.h"
+#include "common/textconsole.h"
+#include "common/types.h"
 
 namespace Common {
 
@@ -51,8 +55,20 @@ public:
 	/** Add more bits, creating a multi-bit value in stages. */
 	virtual void addBit(uint32 &x, uint32 n) = 0;
 
+	/**
+	 * Return the value of the next n bits, the way getBits() would, but
+	 * without consuming them. Bits past the end of the stream read as 0.
+	 */
+	virtual uint32 peekBits(uint32 n) = 0;
+
 	/** Skip a number of bits. */
-	void skip(uint32 n);
+	virtual void skip(uint32 n);
+
+	/**
+	 * Return whether the first bit read ends up as the most significant
+	 * bit of the values returned by getBits() and peekBits().
+	 */
+	virtual bool isMSBFirst() const = 0;
 
 	/** Get the current position, in bits. */
 	virtual uint32 pos()  const = 0;
@@ -104,14 +120,20 @@ public:
 	 */
 	void addBit(uint32 &x, uint32 n);
 
+	uint32 peekBits(uint32 n);
+	void skip(uint32 n);
+	bool isMSBFirst() const { return true; }
+
 	uint32 pos()  const;
 	uint32 size() const;
 
 private:
-	SeekableReadStream *_stream;
+	byte  *_data; ///< The bits, in the order they are handed out.
+	uint32 _size; ///< Size of the data, in bytes.
+	uint32 _pos;  ///< Position within the data, in bits.
 
-	byte  _value;   ///< Current byte.
-	uint8 _inValue; ///< Position within the current byte.
+	/** Return the 32 bits starting at the given byte, reading past the end as 0. */
+	uint32 getWord(uint32 offset) const;
 };
 
 /**
@@ -158,16 +180,177 @@ public:
 	 */
 	void addBit(uint32 &x, uint32 n);
 
+	uint32 peekBits(uint32 n);
+	void skip(uint32 n);
+	bool isMSBFirst() const { return false; }
+
 	uint32 pos()  const;
 	uint32 size() const;
 
 private:
-	SeekableReadStream *_stream;
+	byte  *_data; ///< The little-endian 32bit values.
+	uint32 _size; ///< Size of the data, in bytes.
+	uint32 _pos;  ///< Position within the data, in bits.
+
+	/** Return the 32 bits starting at the given byte, reading past the end as 0. */
+	uint32 getWord(uint32 offset) const;
+};
+
+/**
+ * A bit stream over data in memory, for the hot loops of decoders.
+ *
+ * Unlike the classes derived from BitStream, all methods are inline and
+ * not virtual. Values are not built up bit by bit: every read loads the
+ * 32 bits at the current byte, which always hold at least 25 of the
+ * wanted bits, and only reads more for larger values.
+ *
+ * With isMSB2LSB, the bits are handed out in the same order as BitStreamBE,
+ * otherwise in the same order as BitStream32LE. Like those, it hands out
+ * the zero bits of one more byte (MSB) or 32bit value (LSB) past the end
+ * before complaining.
+ */
+template<bool isMSB2LSB>
+class BitStreamMemory {
+public:
+	/**
+	 * Create a bit stream over bitCount bits read from the provided stream.
+	 * Ownership of the stream is not transferred.
+	 */
+	BitStreamMemory(SeekableReadStream &stream, uint32 bitCount) :
+		_size(bitCount / 8), _pos(0), _disposeAfterUse(DisposeAfterUse::YES) {
+
+		if ((bitCount % 8) != 0)
+			error("Memory bit stream size has to be divisible by 8");
+
+		byte *data = (byte *)malloc(_size);
+		if (stream.read(data, _size) != _size) {
+			free(data);
+			error("Bad BitStreamMemory size");
+		}
+
+		_data = data;
+	}
+
+	/**
+	 * Create a bit stream over the first bitCount bits of the provided data.
+	 * The data is not copied.
+	 */
+	BitStreamMemory(const byte *data, uint32 bitCount, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::NO) :
+		_data(data), _size(bitCount / 8), _pos(0), _disposeAfterUse(disposeAfterUse) {
+
+		if ((bitCount % 8) != 0)
+			error("Memory bit stream size has to be divisible by 8");
+	}
+
+	~BitStreamMemory() {
+		if (_disposeAfterUse == DisposeAfterUse::YES)
+			free(const_cast<byte *>(_data));
+	}
+
+	/** Read a bit from the bitstream. */
+	uint32 getBit() {
+		if (_pos >= _size * 8 + kSlackBits)
+			error("End of bit stream reached");
+
+		const byte b = getByte(_pos >> 3);
+		const uint32 shift = isMSB2LSB ? (7 - (_pos & 7)) : (_pos & 7);
+
+		_pos++;
+
+		return (b >> shift) & 1;
+	}
+
+	/** Read a number of bits, creating a multi-bit value. */
+	uint32 getBits(uint32 n) {
+		const uint32 v = peekBits(n);
+		skip(n);
+
+		return v;
+	}
+
+	/**
+	 * Return the value of the next n bits, without consuming them. Bits
+	 * past the end of the stream read as 0.
+	 */
+	uint32 peekBits(uint32 n) const {
+		if (n > 32)
+			error("Too many bits requested to be read");
+		if (n == 0)
+			return 0;
+
+		const uint32 offset = _pos >> 3;
+		const uint32 shift  = _pos & 7;
+
+		if (isMSB2LSB) {
+			uint32 v = getWord(offset) << shift;
+			if (n > 32 - shift)
+				v |= getByte(offset + 4) >> (8 - shift);
+
+			return v >> (32 - n);
+		}
+
+		uint32 v = getWord(offset) >> shift;
+		if (n > 32 - shift)
+			v |= ((uint32)getByte(offset + 4)) << (32 - shift);
+
+		return (n == 32) ? v : (v & (((uint32)1 << n) - 1));
+	}
+
+	/** Add more bits, creating a multi-bit value in stages. */
+	void addBit(uint32 &x, uint32 n) {
+		if (isMSB2LSB)
+			x = (x << 1) | getBit();
+		else
+			x = (x & ~(1 << n)) | (getBit() << n);
+	}
+
+	/** Skip a number of bits. */
+	void skip(uint32 n) {
+		if (n > _size * 8 + kSlackBits - _pos)
+			error("End of bit stream reached");
+
+		_pos += n;
+	}
+
+	/** Whether the first bit read is the most significant one of multi-bit values. */
+	bool isMSBFirst() const { return isMSB2LSB; }
+
+	/** Get the current position, in bits. */
+	uint32 pos() const { return _pos; }
+	/** Return the number of bits in the stream. */
+	uint32 size() const { return _size * 8; }
+
+private:
+	enum {
+		kSlackBits = isMSB2LSB ? 8 : 32 ///< Bits which can be read past the end.
+	};
+
+	const byte *_data;
+	uint32 _size; ///< Size of the data, in bytes.
+	uint32 _pos;  ///< Position within the data, in bits.
+	DisposeAfterUse::Flag _disposeAfterUse;
+
+	byte getByte(uint32 offset) const {
+		return (offset < _size) ? _data[offset] : 0;
+	}
 
-	uint32 _value;   ///< Current 32bit value.
-	uint8  _inValue; ///< Position within the current 32bit value.
+	/** Return the 32 bits starting at the given byte, reading past the end as 0. */
+	uint32 getWord(uint32 offset) const {
+		if (offset + 4 <= _size)
+			return isMSB2LSB ? READ_BE_UINT32(_data + offset) : READ_LE_UINT32(_data + offset);
+
+		if (isMSB2LSB)
+			return ((uint32)getByte(offset) << 24) | (getByte(offset + 1) << 16) | (getByte(offset + 2) << 8) | getByte(offset + 3);
+
+		return getByte(offset) | (getByte(offset + 1) << 8) | (getByte(offset + 2) << 16) | ((uint32)getByte(offset + 3) << 24);
+	}
 };
 
+/** A memory bit stream handing out the bits in the order of BitStreamBE. */
+typedef BitStreamMemory<true> BitStreamMemoryMSB;
+/** A memory bit stream handing out the bits in the order of BitStream32LE. */
+typedef BitStreamMemory<false> BitStreamMemoryLSB;
+
 } // End of namespace Common
 
 #endif // COMMON_BITSTREAM_H
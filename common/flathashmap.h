@@ -0,0 +1,508 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/func.h"
+
+#include <new>
+
+namespace Common {
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val>, which
+ * stores the entries inline in one array instead of allocating a node for
+ * each of them. A separate array with one control byte per slot, holding
+ * seven bits of the hash of the entry, is scanned while probing, so that
+ * most mismatching slots are skipped without touching (or even comparing)
+ * their key. Erased slots are marked in the control bytes as well.
+ *
+ * The interface is the same as the one of HashMap. The one difference is
+ * that adding a key may move all entries around, i.e. pointers and
+ * references to values are only valid until the next key is added (erasing
+ * keys does not move anything). Hence, only switch maps to FlatHashMap whose
+ * users don't keep such pointers around.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> HM_t;
+
+	struct Node {
+		const Key _key;
+		Val _value;
+		explicit Node(const Key &key) : _key(key), _value() {}
+	};
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The quotient of the next two constants controls how much of the
+		// storage (including erased slots) may be used before it is grown.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4
+	};
+
+	enum {
+		kSlotEmpty = 0,
+		kSlotErased = 1,
+		kSlotUsed = 0x80	///< ORed with seven bits of the hash
+	};
+
+	byte *_ctrl;	///< One control byte per slot
+	Node *_nodes;	///< The slots, only constructed where used
+	uint _mask;		///< Capacity of the map minus one; the capacity is a power of two
+	uint _shift;	///< 32 minus the number of bits in _mask
+	uint _size;
+	uint _erased;	///< Number of erased slots
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+	/**
+	 * Spreads the hash over all bits (the hash functions for integers are
+	 * the identity), and returns the slot to start probing at.
+	 */
+	uint startSlot(uint hash) const {
+		return (uint32)(hash * 0x9E3779B1U) >> _shift;
+	}
+
+	static byte hashTag(uint hash) {
+		return kSlotUsed | (hash & 0x7F);
+	}
+
+	void allocStorage(uint capacity);
+	void freeStorage();
+	void assign(const HM_t &map);
+	uint lookup(const Key &key) const;
+	uint lookupAndCreateIfMissing(const Key &key);
+	void expandStorage(uint newCapacity);
+	void eraseSlot(uint ctr);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		uint _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(uint idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_ctrl[_idx] & kSlotUsed);
+			return _hashmap->_nodes + _idx;
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && !(_hashmap->_ctrl[_idx] & kSlotUsed));
+			if (_idx > _hashmap->_mask)
+				_idx = (uint)-1;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const HM_t &map);
+	~FlatHashMap();
+
+	HM_t &operator=(const HM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		clear();
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	uint size() const { return _size; }
+
+	iterator	begin() {
+		// Find and return the first non-empty entry
+		for (uint ctr = 0; ctr <= _mask; ++ctr) {
+			if (_ctrl[ctr] & kSlotUsed)
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator((uint)-1, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first non-empty entry
+		for (uint ctr = 0; ctr <= _mask; ++ctr) {
+			if (_ctrl[ctr] & kSlotUsed)
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator((uint)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		uint ctr = lookup(key);
+		if (ctr <= _mask)
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		uint ctr = lookup(key);
+		if (ctr <= _mask)
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const HM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	clear();
+	freeStorage();
+}
+
+/**
+ * Allocates empty storage with the given capacity, which must be a power
+ * of two. The previous storage must have been freed already.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(uint capacity) {
+	_mask = capacity - 1;
+	_shift = 32;
+	while (capacity > 1) {
+		capacity >>= 1;
+		_shift--;
+	}
+
+	_ctrl = new byte[_mask + 1];
+	assert(_ctrl != NULL);
+	memset(_ctrl, kSlotEmpty, _mask + 1);
+
+	_nodes = (Node *)malloc((_mask + 1) * sizeof(Node));
+	assert(_nodes != NULL);
+
+	_size = 0;
+	_erased = 0;
+}
+
+/**
+ * Frees the storage. All entries must have been destroyed already.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	delete[] _ctrl;
+	free(_nodes);
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const HM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// Keep all entries in the same slots, so that no rehashing is needed
+	memcpy(_ctrl, map._ctrl, _mask + 1);
+	for (uint ctr = 0; ctr <= _mask; ++ctr) {
+		if (_ctrl[ctr] & kSlotUsed)
+			new (_nodes + ctr) Node(map._nodes[ctr]);
+	}
+	_size = map._size;
+	_erased = map._erased;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	for (uint ctr = 0; ctr <= _mask; ++ctr) {
+		if (_ctrl[ctr] & kSlotUsed)
+			_nodes[ctr].~Node();
+	}
+	memset(_ctrl, kSlotEmpty, _mask + 1);
+
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+	}
+
+	_size = 0;
+	_erased = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(uint newCapacity) {
+	const uint oldMask = _mask;
+	byte *oldCtrl = _ctrl;
+	Node *oldNodes = _nodes;
+#ifndef NDEBUG
+	const uint oldSize = _size;
+#endif
+
+	allocStorage(newCapacity);
+
+	// Move all entries over. Since we know that no key exists twice in the
+	// old table, we don't need to call _equal() for that.
+	for (uint ctr = 0; ctr <= oldMask; ++ctr) {
+		if (!(oldCtrl[ctr] & kSlotUsed))
+			continue;
+
+		const uint hash = _hash(oldNodes[ctr]._key);
+		uint idx = startSlot(hash);
+		while (_ctrl[idx] != kSlotEmpty)
+			idx = (idx + 1) & _mask;
+
+		_ctrl[idx] = oldCtrl[ctr];
+		new (_nodes + idx) Node(oldNodes[ctr]);
+		oldNodes[ctr].~Node();
+		_size++;
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == oldSize);
+
+	delete[] oldCtrl;
+	free(oldNodes);
+}
+
+/**
+ * Returns the slot of the given key, or _mask + 1 if it is not contained.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+uint FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	const uint hash = _hash(key);
+	const byte tag = hashTag(hash);
+	uint ctr = startSlot(hash);
+
+	// There always is at least one empty slot, so this terminates
+	while (_ctrl[ctr] != kSlotEmpty) {
+		if (_ctrl[ctr] == tag && _equal(_nodes[ctr]._key, key))
+			return ctr;
+		ctr = (ctr + 1) & _mask;
+	}
+
+	return _mask + 1;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+uint FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const uint hash = _hash(key);
+	const byte tag = hashTag(hash);
+	uint ctr = startSlot(hash);
+	uint firstErased = _mask + 1;
+
+	while (_ctrl[ctr] != kSlotEmpty) {
+		if (_ctrl[ctr] == tag && _equal(_nodes[ctr]._key, key))
+			return ctr;
+		if (_ctrl[ctr] == kSlotErased && firstErased > _mask)
+			firstErased = ctr;
+		ctr = (ctr + 1) & _mask;
+	}
+
+	// Reuse the first erased slot passed on the way, if any
+	if (firstErased <= _mask) {
+		ctr = firstErased;
+		_erased--;
+	}
+
+	_ctrl[ctr] = tag;
+	new (_nodes + ctr) Node(key);
+	_size++;
+
+	// Keep the load factor below a certain threshold. Erased slots are
+	// counted as well; if they make up a large part of it, the storage is
+	// rebuilt with the same size to get rid of them.
+	const uint capacity = _mask + 1;
+	if ((_size + _erased) * FLATHASHMAP_LOADFACTOR_DENOMINATOR >
+	        capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		if (_size * 2 > capacity)
+			expandStorage(capacity * 2);
+		else
+			expandStorage(capacity);
+		ctr = lookup(key);
+		assert(ctr <= _mask);
+	}
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(uint ctr) {
+	_nodes[ctr].~Node();
+	_size--;
+
+	// When the next slot is empty, no probe sequence continues past this
+	// slot, so it can become empty as well instead of being marked erased.
+	// The same then holds for any erased slots right before it.
+	if (_ctrl[(ctr + 1) & _mask] == kSlotEmpty) {
+		_ctrl[ctr] = kSlotEmpty;
+		ctr = (ctr - 1) & _mask;
+		while (_ctrl[ctr] == kSlotErased) {
+			_ctrl[ctr] = kSlotEmpty;
+			_erased--;
+			ctr = (ctr - 1) & _mask;
+		}
+	} else {
+		_ctrl[ctr] = kSlotErased;
+		_erased++;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key) <= _mask;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	// This may grow the storage, so only access _nodes afterwards
+	const uint ctr = lookupAndCreateIfMissing(key);
+	return _nodes[ctr]._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	uint ctr = lookup(key);
+	if (ctr <= _mask)
+		return _nodes[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	const uint ctr = lookupAndCreateIfMissing(key);
+	_nodes[ctr]._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	const uint ctr = entry._idx;
+	assert(ctr <= _mask);
+	assert(_ctrl[ctr] & kSlotUsed);
+
+	eraseSlot(ctr);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	uint ctr = lookup(key);
+	if (ctr <= _mask)
+		eraseSlot(ctr);
+}
+
+}	// End of namespace Common
+
+#endif
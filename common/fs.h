@@ -26,6 +26,7 @@
 #include "common/archive.h"
 #include "common/hash-str.h"
 #include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "common/ptr.h"
 #include "common/str.h"
 
@@ -205,6 +206,18 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Queries the size and the modification time of the file referred by
+	 * this node, without opening it. This allows checking whether
+	 * information which was derived from the file earlier is still up to
+	 * date. Not all backends support this.
+	 *
+	 * @param size      set to the size of the file
+	 * @param timestamp set to the modification time
+	 * @return true if the file exists and its information is available
+	 */
+	bool getFileInfo(uint32 &size, uint32 &timestamp) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -266,7 +279,7 @@ class FSDirectory : public Archive {
 
 	// Caches are case insensitive, clashes are dealt with when creating
 	// Key is stored in lowercase.
-	typedef HashMap<String, FSNode, IgnoreCase_Hash, IgnoreCase_EqualTo> NodeCache;
+	typedef FlatHashMap<String, FSNode, IgnoreCase_Hash, IgnoreCase_EqualTo> NodeCache;
 	mutable NodeCache	_fileCache, _subDirCache;
 	mutable bool _cached;
 	mutable int	_depth;
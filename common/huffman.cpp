@@ -66,21 +66,108 @@ Huffman::~Huffman() {
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (uint32 i = 0; i < _symbols.size(); i++)
 		_symbols[i]->symbol = symbols ? *symbols++ : i;
+
+	// The lookup tables contain the symbols
+	_tables[0].clear();
+	_tables[1].clear();
 }
 
-uint32 Huffman::getSymbol(BitStream &bits) const {
-	uint32 code = 0;
+/** Reverse the order of the lowest n bits of x. */
+static uint32 reverseBits(uint32 x, uint32 n) {
+	uint32 r = 0;
+	for (uint32 i = 0; i < n; i++, x >>= 1)
+		r = (r << 1) | (x & 1);
+
+	return r;
+}
 
+const Huffman::Table &Huffman::getTable(bool msbFirst) const {
+	Table &table = _tables[msbFirst ? 1 : 0];
+	if (!table.empty())
+		return table;
+
+	// Bring all codes into reading order. The codes of streams handing out
+	// the LSB first start with their lowest bit.
+	ReadCodeList codes;
 	for (uint32 i = 0; i < _codes.size(); i++) {
-		bits.addBit(code, i);
+		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode) {
+			ReadCode code;
+			code.code   = msbFirst ? cCode->code : reverseBits(cCode->code, i + 1);
+			code.length = i + 1;
+			code.symbol = cCode->symbol;
+			codes.push_back(code);
+		}
+	}
+
+	buildTable(table, codes, 0, MIN<uint32>(_codes.size(), kTableBits), msbFirst);
+	return table;
+}
+
+uint32 Huffman::buildTable(Table &table, const ReadCodeList &codes, uint32 prefixLength, uint32 indexBits, bool msbFirst) {
+	const uint32 offset = table.size();
+	const uint32 entryCount = 1 << indexBits;
+
+	TableEntry invalid;
+	invalid.value  = 0;
+	invalid.length = 0;
+	table.resize(offset + entryCount);
+	for (uint32 i = 0; i < entryCount; i++)
+		table[offset + i] = invalid;
+
+	// Codes that are too long for this table
+	ReadCodeList longCodes;
+
+	for (uint32 i = 0; i < codes.size(); i++) {
+		const uint32 length = codes[i].length - prefixLength;
+
+		if (length > indexBits) {
+			longCodes.push_back(codes[i]);
+			continue;
+		}
+
+		// All entries starting with the code decode to its symbol. If
+		// codes are ambiguous, the first one wins.
+		const uint32 bits  = codes[i].code & ((1 << length) - 1);
+		const uint32 first = bits << (indexBits - length);
+		for (uint32 j = 0; j < (1U << (indexBits - length)); j++) {
+			TableEntry &entry = table[offset + (msbFirst ? (first + j) : reverseBits(first + j, indexBits))];
+			if (entry.length != 0)
+				continue;
+
+			entry.value  = codes[i].symbol;
+			entry.length = length;
+		}
+	}
 
-		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-			if (code == cCode->code)
-				return cCode->symbol;
+	// Group the long codes by their index into this table, and give each
+	// group a subtable.
+	while (!longCodes.empty()) {
+		const uint32 shift = longCodes[0].length - prefixLength - indexBits;
+		const uint32 index = (longCodes[0].code >> shift) & (entryCount - 1);
+
+		ReadCodeList group, rest;
+		uint32 groupLength = 0;
+		for (uint32 i = 0; i < longCodes.size(); i++) {
+			const uint32 length = longCodes[i].length - prefixLength;
+			if (((longCodes[i].code >> (length - indexBits)) & (entryCount - 1)) == index) {
+				group.push_back(longCodes[i]);
+				groupLength = MAX(groupLength, length - indexBits);
+			} else {
+				rest.push_back(longCodes[i]);
+			}
+		}
+
+		const uint32 subBits = MIN<uint32>(groupLength, kTableBits);
+		const uint32 subOffset = buildTable(table, group, prefixLength + indexBits, subBits, msbFirst);
+
+		TableEntry &entry = table[offset + (msbFirst ? index : reverseBits(index, indexBits))];
+		entry.value  = subOffset;
+		entry.length = -(int8)subBits;
+
+		longCodes = rest;
 	}
 
-	error("Unknown Huffman code");
-	return 0;
+	return offset;
 }
 
 } // End of namespace Common
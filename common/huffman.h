@@ -27,7 +27,9 @@
 
 #include "common/array.h"
 #include "common/list.h"
+#include "common/textconsole.h"
 #include "common/types.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -36,6 +38,10 @@ class BitStream;
 /**
  * Huffman bitstream decoding
  *
+ * Symbols are decoded through lookup tables, which are indexed by the next
+ * few bits of the stream. Short codes are resolved with a single lookup,
+ * longer ones continue in a subtable.
+ *
  * Used in engines:
  *  - scumm
  */
@@ -55,10 +61,45 @@ public:
 	/** Modify the codes' symbols. */
 	void setSymbols(const uint32 *symbols = 0);
 
-	/** Return the next symbol in the bitstream. */
-	uint32 getSymbol(BitStream &bits) const;
+	/**
+	 * Return the next symbol in the bitstream.
+	 *
+	 * Works with any bit stream class providing peekBits(), skip() and
+	 * isMSBFirst(), like BitStream and BitStreamMemory.
+	 */
+	template<class BITSTREAM>
+	uint32 getSymbol(BITSTREAM &bits) const {
+		const Table &table = getTable(bits.isMSBFirst());
+
+		uint32 offset = 0;
+		uint32 indexBits = MIN<uint32>(_codes.size(), kTableBits);
+
+		while (true) {
+			const TableEntry &entry = table[offset + bits.peekBits(indexBits)];
+
+			if (entry.length > 0) {
+				bits.skip(entry.length);
+				return entry.value;
+			}
+
+			if (entry.length == 0)
+				break;
+
+			// Continue in the subtable
+			bits.skip(indexBits);
+			offset    = entry.value;
+			indexBits = -entry.length;
+		}
+
+		error("Unknown Huffman code");
+		return 0;
+	}
 
 private:
+	enum {
+		kTableBits = 9 ///< Maximum number of index bits of a lookup table.
+	};
+
 	struct Symbol {
 		uint32 code;
 		uint32 symbol;
@@ -75,6 +116,50 @@ private:
 
 	/** Sorted list of pointers to the symbols. */
 	SymbolList _symbols;
+
+	/** A code, with its bits in the order they are read from the stream. */
+	struct ReadCode {
+		uint32 code;   ///< The first bit read is the most significant one.
+		uint8 length;
+		uint32 symbol;
+	};
+
+	typedef Common::Array<ReadCode> ReadCodeList;
+
+	/** An entry of a lookup table. */
+	struct TableEntry {
+		/** The symbol, or the offset of the subtable. */
+		uint32 value;
+		/**
+		 * The number of bits of the code left at this table level. A
+		 * negative value is the number of index bits of the subtable, and
+		 * 0 marks an invalid code.
+		 */
+		int8 length;
+	};
+
+	typedef Common::Array<TableEntry> Table;
+
+	/**
+	 * The lookup tables, for bit streams handing out the LSB (0) and the
+	 * MSB (1) first. They are built when first needed, and consist of the
+	 * root table followed by all subtables.
+	 */
+	mutable Table _tables[2];
+
+	const Table &getTable(bool msbFirst) const;
+
+	/**
+	 * Add a table for the given codes to the end of the lookup table.
+	 *
+	 * @param table The lookup table.
+	 * @param codes Codes whose first prefixLength bits have already been resolved.
+	 * @param prefixLength Number of bits already resolved by the parent tables.
+	 * @param indexBits Number of bits this table is indexed with.
+	 * @param msbFirst Whether the table is for streams handing out the MSB first.
+	 * @return The offset of the new table.
+	 */
+	static uint32 buildTable(Table &table, const ReadCodeList &codes, uint32 prefixLength, uint32 indexBits, bool msbFirst);
 };
 
 } // End of namespace Common
@@ -127,8 +127,13 @@ private:
 			return;
 
 		byte *old_data = _data;
+		const uint32 old_capacity = _capacity;
 
+		// Grow geometrically, so that writing a stream in small pieces
+		// takes linear time
 		_capacity = new_len + 32;
+		if (_capacity < old_capacity * 2)
+			_capacity = old_capacity * 2;
 		_data = (byte *)malloc(_capacity);
 		_ptr = _data + _pos;
 
@@ -149,6 +149,54 @@ public:
 	 * @see Common::matchString()
 	 */
 	virtual StringArray listSavefiles(const String &pattern) = 0;
+
+	/**
+	 * Queries the size and the modification time of a savefile, without
+	 * opening it for loading. This allows checking whether information
+	 * which was derived from a savefile earlier is still up to date.
+	 *
+	 * The default implementation returns false, i.e. the information is
+	 * not available. Savefile managers which implement it have to return
+	 * true from hasSavefileInfo() as well.
+	 *
+	 * @param name      the name of the savefile
+	 * @param size      set to the size of the file, as stored
+	 * @param timestamp set to the modification time
+	 * @return true if the savefile exists and both its size and its
+	 *         modification time are known
+	 */
+	virtual bool getSavefileInfo(const String &name, uint32 &size, uint32 &timestamp) { return false; }
+
+	/**
+	 * Returns whether getSavefileInfo() is implemented, i.e. whether it
+	 * can succeed for existing savefiles at all.
+	 */
+	virtual bool hasSavefileInfo() const { return false; }
+
+	/**
+	 * Returns whether the given savefile is still being written in the
+	 * background. Some backends only buffer the data of an OutSaveFile,
+	 * and store it after it was finalized, so that the engine does not
+	 * have to wait for the compression and the disk.
+	 *
+	 * Loading, listing or removing a savefile which is still being
+	 * written waits for it, so this is only needed to report progress.
+	 *
+	 * @param name the name of the savefile
+	 * @return true if the savefile has not been stored yet
+	 */
+	virtual bool isSavePending(const String &name) { return false; }
+
+	/**
+	 * Waits until all savefiles written in the background are stored, and
+	 * returns whether this failed for any of them. The OutSaveFile can
+	 * only report such a failure if it already happened when it is asked,
+	 * so this is the reliable way to learn about them. The error is
+	 * cleared afterwards.
+	 *
+	 * @return the first error of a background write since the last call
+	 */
+	virtual Error waitForPendingSaves() { return kNoError; }
 };
 
 } // End of namespace Common
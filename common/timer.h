@@ -39,7 +39,8 @@ public:
 	 * written following the same safety guidelines as any other threaded code.
 	 *
 	 * @note Although the interval is specified in microseconds, the actual timer resolution
-	 *       may be lower. In particular, with the SDL backend the timer resolution is 10ms.
+	 *       may be lower. In particular, with the SDL backend the timer resolution is 1ms.
+	 *       The interval is still kept in microseconds, so that the average rate is exact.
 	 * @param proc		the callback
 	 * @param interval	the interval in which the timer shall be invoked (in microseconds)
 	 * @param refCon	an arbitrary void pointer; will be passed to the timer callback
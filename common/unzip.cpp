@@ -102,9 +102,13 @@ typedef struct {
 
 #endif  // !USE_ZLIB
 
+#include "common/array.h"
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -379,6 +383,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamRef;	/* shared with the member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -541,6 +546,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -592,7 +598,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -641,7 +646,7 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
+	// The stream itself is deleted together with the last member stream
 	delete s;
 	return UNZ_OK;
 }
@@ -1416,12 +1421,239 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/**
+ * Stream for a stored (uncompressed) member of a ZIP archive. The data is
+ * read directly from the archive, whose stream stays alive as long as any
+ * of its members is open.
+ */
+class ZipStoredStream : public SafeSubReadStream {
+	SharedPtr<SeekableReadStream> _zipStream;
+
+public:
+	ZipStoredStream(SharedPtr<SeekableReadStream> zipStream, uint32 begin, uint32 end)
+		: SafeSubReadStream(zipStream.get(), begin, end), _zipStream(zipStream) {
+	}
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * Stream for a deflated member of a ZIP archive. The data is inflated on
+ * the fly as it is read, with a zlib state of its own, so any number of
+ * members can be read at the same time.
+ *
+ * Seeking forward inflates and discards the data in between. While reading,
+ * the zlib state is saved every kRestartInterval bytes, so seeking backward
+ * only has to inflate the data after the closest restart point instead of
+ * the whole member.
+ */
+class ZipInflateStream : public SeekableReadStream {
+	enum {
+		kRestartInterval = 256 * 1024
+	};
+
+	/** Saved inflate state, from which the decompression can be resumed */
+	struct RestartPoint {
+		z_stream stream;
+		uint32 compressedPos;
+		uint32 pos;
+		uint32 crc;
+	};
+
+	SharedPtr<SeekableReadStream> _zipStream;
+	uint32 _dataStart;
+	uint32 _compressedSize;
+	uint32 _compressedPos;
+	uint32 _size;
+	uint32 _pos;
+	uint32 _crc;
+	uint32 _expectedCrc;
+	bool _eos;
+	int _zlibErr;
+
+	z_stream _stream;
+	byte _buf[UNZ_BUFSIZE];
+
+	// zlib keeps a pointer to the z_stream, so the points must not move
+	Array<RestartPoint *> _restartPoints;
+
+	void addRestartPoint() {
+		RestartPoint *point = new RestartPoint;
+		if (inflateCopy(&point->stream, &_stream) != Z_OK) {
+			delete point;
+			return;
+		}
+
+		// The input left in the buffer is read again after a restart
+		point->compressedPos = _compressedPos - _stream.avail_in;
+		point->pos = _pos;
+		point->crc = _crc;
+		_restartPoints.push_back(point);
+	}
+
+	bool restart(RestartPoint *point) {
+		if (point) {
+			inflateEnd(&_stream);
+			_zlibErr = inflateCopy(&_stream, &point->stream);
+			_compressedPos = point->compressedPos;
+			_pos = point->pos;
+			_crc = point->crc;
+		} else {
+			_zlibErr = inflateReset(&_stream);
+			_compressedPos = 0;
+			_pos = 0;
+			_crc = 0;
+		}
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		return _zlibErr == Z_OK;
+	}
+
+public:
+	ZipInflateStream(SharedPtr<SeekableReadStream> zipStream, uint32 dataStart,
+	                 uint32 compressedSize, uint32 size, uint32 crc)
+		: _zipStream(zipStream), _dataStart(dataStart), _compressedSize(compressedSize),
+		  _compressedPos(0), _size(size), _pos(0), _crc(0), _expectedCrc(crc), _eos(false) {
+
+		_stream.zalloc = Z_NULL;
+		_stream.zfree = Z_NULL;
+		_stream.opaque = Z_NULL;
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+
+		// A negative windowBits tells zlib that there is no zlib header
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+	}
+
+	~ZipInflateStream() {
+		inflateEnd(&_stream);
+		for (uint i = 0; i < _restartPoints.size(); ++i) {
+			inflateEnd(&_restartPoints[i]->stream);
+			delete _restartPoints[i];
+		}
+	}
+
+	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
+	void clearErr() {
+		// only reset _eos; I/O errors are not recoverable
+		_eos = false;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		_stream.next_out = (byte *)dataPtr;
+		_stream.avail_out = dataSize;
+
+		// Keep going while we get no error
+		while (_zlibErr == Z_OK && _stream.avail_out) {
+			if (_stream.avail_in == 0 && _compressedPos < _compressedSize) {
+				// Other members may have moved the archive stream in between
+				const uint32 readSize = MIN<uint32>(UNZ_BUFSIZE, _compressedSize - _compressedPos);
+				_zipStream->seek(_dataStart + _compressedPos, SEEK_SET);
+				if (_zipStream->read(_buf, readSize) != readSize) {
+					_zlibErr = Z_ERRNO;
+					break;
+				}
+				_compressedPos += readSize;
+				_stream.next_in = _buf;
+				_stream.avail_in = readSize;
+			}
+
+			// zlib needs an extra byte to detect the end of a raw deflate
+			// stream, but we know the uncompressed size anyway.
+			_zlibErr = inflate(&_stream, Z_SYNC_FLUSH);
+			if (_zlibErr == Z_BUF_ERROR && _stream.avail_in == 0 && _compressedPos == _compressedSize)
+				_zlibErr = Z_DATA_ERROR;
+		}
+
+		const uint32 readSize = dataSize - _stream.avail_out;
+		_crc = crc32(_crc, (const Bytef *)dataPtr, readSize);
+		_pos += readSize;
+
+		if (_pos == _size && _crc != _expectedCrc && !err()) {
+			warning("ZipInflateStream: CRC mismatch");
+			_zlibErr = Z_DATA_ERROR;
+		}
+
+		if (readSize < dataSize)
+			_eos = true;
+
+		if (!err() && _pos < _size && _pos >= (_restartPoints.size() + 1) * kRestartInterval)
+			addRestartPoint();
+
+		return readSize;
+	}
+
+	bool eos() const {
+		return _eos;
+	}
+	int32 pos() const {
+		return _pos;
+	}
+	int32 size() const {
+		return _size;
+	}
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		int32 newPos = 0;
+		switch (whence) {
+		case SEEK_END:
+			newPos = _size + offset;
+			break;
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+		}
+
+		if (newPos < 0 || (uint32)newPos > _size)
+			return false;
+
+		// Resume from the closest restart point before the new position,
+		// unless we are already closer to it.
+		RestartPoint *point = 0;
+		for (uint i = 0; i < _restartPoints.size() && _restartPoints[i]->pos <= (uint32)newPos; ++i)
+			point = _restartPoints[i];
+
+		if ((uint32)newPos < _pos || (point && point->pos > _pos)) {
+			if (!restart(point))
+				return false;
+		}
+
+		// Inflate and discard the data up to the new position
+		byte tmpBuf[1024];
+		while (!err() && _pos < (uint32)newPos) {
+			if (read(tmpBuf, MIN<uint32>(sizeof(tmpBuf), newPos - _pos)) == 0)
+				break;
+		}
+
+		_eos = false;
+		return !err() && _pos == (uint32)newPos;
+	}
+};
+
+#endif
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
+	/**
+	 * Where the archive was opened from, to give each member a file handle
+	 * of its own. Archives created from a stream share that stream with
+	 * their members, which then must all be read from the same thread.
+	 */
+	FSNode _node;
+	String _name;
+
+	SeekableReadStream *openArchiveFile() const;
+
 public:
-	ZipArchive(unzFile zipFile);
+	ZipArchive(unzFile zipFile, const FSNode &node = FSNode(), const String &name = String());
 
 
 	~ZipArchive();
@@ -1450,7 +1682,8 @@ public:
 };
 */
 
-ZipArchive::ZipArchive(unzFile zipFile) : _zipFile(zipFile) {
+ZipArchive::ZipArchive(unzFile zipFile, const FSNode &node, const String &name)
+	: _zipFile(zipFile), _node(node), _name(name) {
 	assert(_zipFile);
 }
 
@@ -1492,43 +1725,58 @@ Common::SeekableReadStream *ZipArchive::createReadStreamForMember(const Common::
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	unz_s *s = (unz_s *)_zipFile;
+	uInt iSizeVar;
+	uLong offset_local_extrafield;
+	uInt size_local_extrafield;
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
+				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
 		return 0;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
-		return 0;
+	const unz_file_info &fileInfo = s->cur_file_info;
+	const uint32 dataStart = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER
+		+ iSizeVar + s->byte_before_the_zipfile;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
+	// Members may be read from other threads, like the sound mixer, so
+	// they get their own file handle where possible.
+	SharedPtr<SeekableReadStream> zipStream(openArchiveFile());
+	if (!zipStream)
+		zipStream = s->_streamRef;
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return 0;
+	// Stored members are read straight from the archive
+	if (fileInfo.compression_method == 0) {
+		if (fileInfo.compressed_size != fileInfo.uncompressed_size)
+			return 0;
+
+		return new ZipStoredStream(zipStream, dataStart, dataStart + fileInfo.uncompressed_size);
 	}
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
+#ifdef USE_ZLIB
+	if (fileInfo.compression_method != Z_DEFLATED)
+		return 0;
+
+	ZipInflateStream *stream = new ZipInflateStream(zipStream, dataStart,
+		fileInfo.compressed_size, fileInfo.uncompressed_size, fileInfo.crc);
+	if (stream->err()) {
+		delete stream;
 		return 0;
 	}
 
-	return new Common::MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return stream;
+#else
+	// Cannot decompress the file without zlib.
+	return 0;
+#endif
 }
 
-Archive *makeZipArchive(const String &name) {
-	return makeZipArchive(SearchMan.createReadStreamForMember(name));
-}
+SeekableReadStream *ZipArchive::openArchiveFile() const {
+	if (!_name.empty())
+		return SearchMan.createReadStreamForMember(_name);
 
-Archive *makeZipArchive(const FSNode &node) {
-	return makeZipArchive(node.createReadStream());
+	return _node.createReadStream();
 }
 
-Archive *makeZipArchive(SeekableReadStream *stream) {
+static Archive *openZipArchive(SeekableReadStream *stream, const FSNode &node, const String &name) {
 	if (!stream)
 		return 0;
 	unzFile zipFile = unzOpen(stream);
@@ -1537,7 +1785,19 @@ Archive *makeZipArchive(SeekableReadStream *stream) {
 		// goes wrong.
 		return 0;
 	}
-	return new ZipArchive(zipFile);
+	return new ZipArchive(zipFile, node, name);
+}
+
+Archive *makeZipArchive(const String &name) {
+	return openZipArchive(SearchMan.createReadStreamForMember(name), FSNode(), name);
+}
+
+Archive *makeZipArchive(const FSNode &node) {
+	return openZipArchive(node.createReadStream(), node, String());
+}
+
+Archive *makeZipArchive(SeekableReadStream *stream) {
+	return openZipArchive(stream, FSNode(), String());
 }
 
 }	// End of namespace Common
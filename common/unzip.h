@@ -51,6 +51,8 @@ Archive *makeZipArchive(const FSNode &node);
  * of the given ZIP compressed datastream.
  * This takes ownership of the stream,  in particular, it is deleted when the
  * ZipArchive is deleted.
+ * All members opened from the archive read from this stream, so they must
+ * be used from one thread only.
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
@@ -32,6 +32,7 @@
 #include "common/translation.h"
 
 #include "engines/advancedDetector.h"
+#include "engines/detectioncache.h"
 #include "engines/obsolete.h"
 
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
@@ -281,7 +282,7 @@ Common::Error AdvancedMetaEngine::createInstance(OSystem *syst, Engine **engine)
 }
 
 struct SizeMD5 {
-	int size;
+	int32 size;
 	Common::String md5;
 };
 
@@ -384,14 +385,8 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 				if (allFiles.contains(fname)) {
 					debug(3, "+ %s", fname.c_str());
 
-					Common::File testFile;
-
-					if (testFile.open(allFiles[fname])) {
-						tmp.size = (int32)testFile.size();
-						tmp.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
-					} else {
+					if (!DetectionCache::instance().getFileMD5(allFiles[fname], _md5Bytes, tmp.md5, tmp.size))
 						tmp.size = -1;
-					}
 
 					debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
 					filesSizeMD5[fname] = tmp;
@@ -0,0 +1,206 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+
+#include "common/algorithm.h"
+#include "common/array.h"
+#include "common/endian.h"
+#include "common/file.h"
+#include "common/fs.h"
+#include "common/md5.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+namespace {
+
+const char *const kCacheFileName = "detection.cache";
+
+enum {
+	kCacheVersion = 2
+};
+
+void writeString(Common::WriteStream &out, const Common::String &str) {
+	out.writeUint32LE(str.size());
+	out.write(str.c_str(), str.size());
+}
+
+Common::String readString(Common::ReadStream &in) {
+	const uint32 size = in.readUint32LE();
+
+	Common::String str;
+	for (uint32 i = 0; i < size && !in.eos(); ++i)
+		str += (char)in.readByte();
+	return str;
+}
+
+Common::String makeKey(const Common::String &path, uint32 md5Bytes) {
+	return Common::String::format("%u:", md5Bytes) + path;
+}
+
+} // End of anonymous namespace
+
+DetectionCache::DetectionCache()
+	: _loaded(false), _changed(false), _deferFlush(false), _useCount(0), _hits(0), _misses(0) {
+}
+
+bool DetectionCache::getFileMD5(const Common::FSNode &node, uint32 md5Bytes, Common::String &md5, int32 &size) {
+	if (!_loaded)
+		load();
+
+	uint32 fileSize, timestamp;
+	const bool cacheable = node.getFileInfo(fileSize, timestamp);
+	const Common::String key = makeKey(node.getPath(), md5Bytes);
+
+	if (cacheable) {
+		EntryMap::iterator entry = _entries.find(key);
+		if (entry != _entries.end() && entry->_value.size == fileSize && entry->_value.timestamp == timestamp) {
+			entry->_value.lastUse = ++_useCount;
+			md5 = entry->_value.md5;
+			size = (int32)fileSize;
+			++_hits;
+			return true;
+		}
+	}
+
+	Common::File file;
+	if (!file.open(node))
+		return false;
+
+	size = (int32)file.size();
+	md5 = Common::computeStreamMD5AsString(file, md5Bytes);
+	++_misses;
+
+	if (cacheable) {
+		Entry &entry = _entries[key];
+		entry.size = fileSize;
+		entry.timestamp = timestamp;
+		entry.md5 = md5;
+		entry.lastUse = ++_useCount;
+		_changed = true;
+	}
+
+	return true;
+}
+
+void DetectionCache::load() {
+	_loaded = true;
+
+	// Detection may run before the backend is set up, e.g. from the
+	// command line. The cache then lasts for this run only.
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::InSaveFile *in = saveFileMan->openForLoading(kCacheFileName);
+	if (!in)
+		return;
+
+	if (in->readUint32BE() == MKTAG('D','C','C','H') && in->readUint32LE() == kCacheVersion) {
+		const uint32 count = in->readUint32LE();
+		for (uint32 i = 0; i < count; ++i) {
+			const Common::String key = readString(*in);
+
+			Entry entry;
+			entry.size = in->readUint32LE();
+			entry.timestamp = in->readUint32LE();
+			entry.md5 = readString(*in);
+			entry.lastUse = in->readUint32LE();
+
+			if (in->err() || in->eos()) {
+				// A damaged cache is simply built again
+				_entries.clear();
+				break;
+			}
+
+			_entries[key] = entry;
+			_useCount = MAX(_useCount, entry.lastUse);
+		}
+	}
+
+	delete in;
+}
+
+void DetectionCache::flush() {
+	if (!_changed || _deferFlush)
+		return;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::OutSaveFile *out = saveFileMan->openForSaving(kCacheFileName);
+	if (!out)
+		return;
+
+	dropUnusedEntries();
+
+	out->writeUint32BE(MKTAG('D','C','C','H'));
+	out->writeUint32LE(kCacheVersion);
+	out->writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
+		writeString(*out, entry->_key);
+		out->writeUint32LE(entry->_value.size);
+		out->writeUint32LE(entry->_value.timestamp);
+		writeString(*out, entry->_value.md5);
+		out->writeUint32LE(entry->_value.lastUse);
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("Could not write the detection cache '%s'", kCacheFileName);
+	delete out;
+
+	_changed = false;
+}
+
+void DetectionCache::setDeferFlush(bool defer) {
+	_deferFlush = defer;
+	flush();
+}
+
+/**
+ * Drops the least recently used entries until at most kMaxEntries are
+ * left.
+ */
+void DetectionCache::dropUnusedEntries() {
+	if (_entries.size() <= kMaxEntries)
+		return;
+
+	Common::Array<uint32> lastUses;
+	for (EntryMap::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry)
+		lastUses.push_back(entry->_value.lastUse);
+	Common::sort(lastUses.begin(), lastUses.end());
+
+	// Entries used at the same time are kept or dropped together, which
+	// might leave a few more than kMaxEntries
+	const uint32 oldestKept = lastUses[lastUses.size() - kMaxEntries];
+	for (EntryMap::iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
+		if (entry->_value.lastUse < oldestKept)
+			_entries.erase(entry);
+	}
+}
@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+class FSNode;
+}
+
+/**
+ * A persistent cache of the MD5s which the AdvancedDetector computes from
+ * game files. It is shared by all engine plugins.
+ *
+ * Every entry is keyed on the absolute path of the file and the number of
+ * bytes hashed, and remembers the size and modification time of the file,
+ * so that changed files are hashed again. Files whose modification time
+ * the filesystem backend does not provide are never cached.
+ *
+ * The cache is stored in a savefile of its own, "detection.cache". It
+ * holds at most kMaxEntries entries; the ones used least recently are
+ * dropped first, so that files which were moved or deleted do not stay in
+ * it forever.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	/**
+	 * Returns the MD5 of the first md5Bytes bytes of a file (of the whole
+	 * file if md5Bytes is 0), and its size. The file is only read if the
+	 * cache has no up to date entry for it.
+	 *
+	 * @return false if the file could not be opened
+	 */
+	bool getFileMD5(const Common::FSNode &node, uint32 md5Bytes, Common::String &md5, int32 &size);
+
+	/**
+	 * Writes the cache back, if any entry was added. Does nothing while
+	 * writing is deferred.
+	 */
+	void flush();
+
+	/**
+	 * Defers writing the cache, e.g. while many directories are scanned
+	 * one by one. Ending the deferral writes the cache.
+	 */
+	void setDeferFlush(bool defer);
+
+	/** Returns how many MD5s were taken from the cache. */
+	uint32 getHits() const { return _hits; }
+
+	/** Returns how many MD5s were computed. */
+	uint32 getMisses() const { return _misses; }
+
+	void resetStats() { _hits = _misses = 0; }
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+
+	enum {
+		kMaxEntries = 8192
+	};
+
+	struct Entry {
+		uint32 size;
+		uint32 timestamp;
+		Common::String md5;
+		/** Value of _useCount when the entry was last used */
+		uint32 lastUse;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	EntryMap _entries;
+	bool _loaded;
+	bool _changed;
+	bool _deferFlush;
+	uint32 _useCount;
+	uint32 _hits;
+	uint32 _misses;
+
+	void load();
+	void dropUnusedEntries();
+};
+
+#endif
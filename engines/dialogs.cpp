@@ -23,6 +23,7 @@
 
 #include "common/config-manager.h"
 #include "common/events.h"
+#include "common/savefile.h"
 #include "common/str.h"
 #include "common/system.h"
 #include "common/translation.h"
@@ -41,6 +42,7 @@
 #include "engines/dialogs.h"
 #include "engines/engine.h"
 #include "engines/metaengine.h"
+#include "engines/saveindex.h"
 
 #ifdef SMALL_SCREEN_DEVICE
 #include "gui/KeysDialog.h"
@@ -216,24 +218,40 @@ void MainMenuDialog::reflowLayout() {
 }
 
 void MainMenuDialog::save() {
+	// Savefiles may be written in the background, after the engine was
+	// told that saving succeeded. Report if this failed for an earlier one.
+	if (_engine->getSaveFileManager()->waitForPendingSaves().getCode() != Common::kNoError) {
+		GUI::MessageDialog dialog(_("Failed to save game state to file."));
+		dialog.runModal();
+	}
+
 	const Common::String gameId = ConfMan.get("gameid");
 
 	const EnginePlugin *plugin = 0;
 	EngineMan.findGame(gameId, &plugin);
 
-	int slot = _saveDialog->runModalWithPluginAndTarget(plugin, ConfMan.getActiveDomainName());
+	const Common::String target = ConfMan.getActiveDomainName();
+	int slot = _saveDialog->runModalWithPluginAndTarget(plugin, target);
 
 	if (slot >= 0) {
 		Common::String result(_saveDialog->getResultString());
+		Common::Error status;
 		if (result.empty()) {
 			// If the user was lazy and entered no save name, come up with a default name.
 			Common::String buf;
 			buf = Common::String::format("Save %d", slot + 1);
-			_engine->saveGameState(slot, buf);
+			status = _engine->saveGameState(slot, buf);
 		} else {
-			_engine->saveGameState(slot, result);
+			status = _engine->saveGameState(slot, result);
 		}
 
+		// Drop the slot from the save state index right away. Its check of
+		// the file size and time could miss a save written within the same
+		// second. The save is read again the next time the saves are
+		// listed, so we don't wait for it to be written here.
+		if (status.getCode() == Common::kNoError && SaveStateIndex::isSupported(plugin, target))
+			SaveStateIndex(plugin, target).invalidateSlot(slot);
+
 		close();
 	}
 }
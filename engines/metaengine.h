@@ -138,6 +138,24 @@ public:
 		return SaveStateDescriptor();
 	}
 
+	/**
+	 * Returns the name of the save file of the specified save state.
+	 *
+	 * Engines which implement this, and which store exactly one file per
+	 * save state, allow the save/load dialog to keep an index of their
+	 * save states (see SaveStateIndex). Their querySaveMetaInfos() has to
+	 * include the description returned by listSaves().
+	 *
+	 * The default implementation returns an empty string, i.e. the save
+	 * states are not indexed.
+	 *
+	 * @param target	name of a config manager target
+	 * @param slot		slot number of the save state
+	 */
+	virtual Common::String getSavegameFile(const char *target, int slot) const {
+		return Common::String();
+	}
+
 	/** @name MetaEngineFeature flags */
 	//@{
 
@@ -2,10 +2,12 @@ MODULE := engines
 
 MODULE_OBJS := \
 	advancedDetector.o \
+	detectioncache.o \
 	dialogs.o \
 	engine.o \
 	game.o \
 	obsolete.o \
+	saveindex.o \
 	savestate.o
 
 # Include common rules
@@ -0,0 +1,387 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/saveindex.h"
+
+#include "common/endian.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+#include "graphics/scaler.h"
+#include "graphics/surface.h"
+
+namespace {
+
+enum {
+	kIndexVersion = 1
+};
+
+/** Size and time of save files which have to be read on every listing */
+const uint32 kUnknownFileInfo = 0xFFFFFFFF;
+
+enum {
+	kEntryDeletable = 1 << 0,
+	kEntryWriteProtected = 1 << 1,
+	kEntryThumbnail = 1 << 2
+};
+
+void writeString(Common::WriteStream &out, const Common::String &str) {
+	out.writeUint32LE(str.size());
+	out.write(str.c_str(), str.size());
+}
+
+bool readString(Common::SeekableReadStream &in, Common::String &str) {
+	const uint32 size = in.readUint32LE();
+	if (in.eos() || size > (uint32)(in.size() - in.pos()))
+		return false;
+
+	str.clear();
+	for (uint32 i = 0; i < size; ++i)
+		str += (char)in.readByte();
+	return true;
+}
+
+/**
+ * Returns whether the thumbnail can be stored in the index. Only the sizes
+ * engines are supposed to use are accepted, so that a damaged index cannot
+ * make us allocate huge surfaces.
+ */
+bool isIndexableThumbnail(const Graphics::Surface *thumbnail) {
+	return thumbnail->pixels &&
+	       (thumbnail->format.bytesPerPixel == 2 || thumbnail->format.bytesPerPixel == 4) &&
+	       thumbnail->w > 0 && thumbnail->w <= kThumbnailWidth &&
+	       thumbnail->h > 0 && thumbnail->h <= kThumbnailHeight2;
+}
+
+/**
+ * Restores the human readable dates and times of a save state, as
+ * formatted by SaveStateDescriptor. Returns false if a string cannot be
+ * parsed.
+ */
+bool restoreDates(SaveStateDescriptor &desc, const Common::String &saveDate, const Common::String &saveTime, const Common::String &playTime) {
+	int a, b, c;
+
+	if (!saveDate.empty()) {
+		if (sscanf(saveDate.c_str(), "%d.%d.%d", &a, &b, &c) != 3)
+			return false;
+		desc.setSaveDate(c, b, a);
+	}
+
+	if (!saveTime.empty()) {
+		if (sscanf(saveTime.c_str(), "%d:%d", &a, &b) != 2)
+			return false;
+		desc.setSaveTime(a, b);
+	}
+
+	if (!playTime.empty()) {
+		if (sscanf(playTime.c_str(), "%d:%d", &a, &b) != 2)
+			return false;
+		desc.setPlayTime(a, b);
+	}
+
+	// The strings have to come out the same, or the index was damaged
+	return desc.getSaveDate() == saveDate && desc.getSaveTime() == saveTime && desc.getPlayTime() == playTime;
+}
+
+} // End of anonymous namespace
+
+SaveStateIndex::SaveStateIndex(const EnginePlugin *plugin, const Common::String &target)
+	: _plugin(plugin), _target(target), _saveFileMan(g_system->getSavefileManager()), _loaded(false) {
+}
+
+bool SaveStateIndex::isSupported(const EnginePlugin *plugin, const Common::String &target) {
+	// Without the size and time of the save files, the index could not
+	// tell which entries are outdated, and every save state would be read
+	// through the MetaEngine anyway
+	return plugin && g_system->getSavefileManager()->hasSavefileInfo() &&
+	       (*plugin)->hasFeature(MetaEngine::kSupportsListSaves) &&
+	       (*plugin)->hasFeature(MetaEngine::kSavesSupportMetaInfo) &&
+	       !(*plugin)->getSavegameFile(target.c_str(), 0).empty();
+}
+
+Common::String SaveStateIndex::getIndexFileName() const {
+	return _target + ".index";
+}
+
+int SaveStateIndex::findEntry(int slot) const {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		if (_entries[i].desc.getSaveSlot() == slot)
+			return i;
+	}
+
+	return -1;
+}
+
+void SaveStateIndex::listSaveFiles() {
+	// Engines name their save files freely, so all files are listed
+	_saveFiles.clear();
+	const Common::StringArray files = _saveFileMan->listSavefiles("*");
+	for (Common::StringArray::const_iterator file = files.begin(); file != files.end(); ++file)
+		_saveFiles[*file] = true;
+}
+
+SaveStateList SaveStateIndex::listSaves() {
+	if (!_loaded)
+		load();
+
+	// Only the save files which exist are looked at more closely
+	listSaveFiles();
+
+	bool changed = false;
+	const int maxSlot = (*_plugin)->getMaximumSaveSlot();
+	for (int slot = 0; slot <= maxSlot; ++slot)
+		changed |= updateEntry(slot);
+
+	// Entries of slots beyond the maximum are dropped as well
+	while (!_entries.empty() && _entries.back().desc.getSaveSlot() > maxSlot) {
+		_entries.pop_back();
+		changed = true;
+	}
+
+	if (changed)
+		save();
+
+	SaveStateList saveList;
+	for (EntryList::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry)
+		saveList.push_back(entry->desc);
+	return saveList;
+}
+
+SaveStateDescriptor SaveStateIndex::querySaveMetaInfos(int slot) const {
+	const int index = findEntry(slot);
+	return (index >= 0) ? _entries[index].desc : SaveStateDescriptor();
+}
+
+void SaveStateIndex::invalidateSlot(int slot) {
+	if (!_loaded)
+		load();
+
+	const int index = findEntry(slot);
+	if (index >= 0) {
+		_entries.remove_at(index);
+		save();
+	}
+}
+
+bool SaveStateIndex::updateEntry(int slot) {
+	const Common::String fileName = (*_plugin)->getSavegameFile(_target.c_str(), slot);
+	const int index = findEntry(slot);
+
+	if (!_saveFiles.contains(fileName)) {
+		if (index < 0)
+			return false;
+
+		_entries.remove_at(index);
+		return true;
+	}
+
+	uint32 size, timestamp;
+	if (!_saveFileMan->getSavefileInfo(fileName, size, timestamp)) {
+		// The savefile manager cannot tell us whether the file changed,
+		// so the engine has to be asked every time
+		size = timestamp = kUnknownFileInfo;
+	} else if (index >= 0) {
+		const Entry &entry = _entries[index];
+		if (entry.fileName == fileName && entry.size == size && entry.timestamp == timestamp)
+			return false;
+	}
+
+	Entry entry;
+	entry.fileName = fileName;
+	entry.size = size;
+	entry.timestamp = timestamp;
+	entry.desc = (*_plugin)->querySaveMetaInfos(_target.c_str(), slot);
+	entry.desc.setSaveSlot(slot);
+
+	// Save states whose thumbnail cannot be stored are read every time
+	const Graphics::Surface *thumbnail = entry.desc.getThumbnail();
+	if (thumbnail && !isIndexableThumbnail(thumbnail))
+		entry.size = entry.timestamp = kUnknownFileInfo;
+
+	if (index >= 0) {
+		_entries[index] = entry;
+	} else {
+		uint pos = 0;
+		while (pos < _entries.size() && _entries[pos].desc.getSaveSlot() < slot)
+			++pos;
+		_entries.insert_at(pos, entry);
+	}
+
+	// Entries which are read every time are not worth writing the index
+	return entry.timestamp != kUnknownFileInfo;
+}
+
+void SaveStateIndex::load() {
+	_loaded = true;
+	_entries.clear();
+
+	Common::InSaveFile *in = _saveFileMan->openForLoading(getIndexFileName());
+	if (!in)
+		return;
+
+	if (in->readUint32BE() == MKTAG('S','I','D','X') && in->readUint32LE() == kIndexVersion) {
+		const uint32 count = in->readUint32LE();
+		for (uint32 i = 0; i < count; ++i) {
+			Entry entry;
+			if (!readEntry(*in, entry)) {
+				// A damaged index is simply built again
+				_entries.clear();
+				break;
+			}
+
+			_entries.push_back(entry);
+		}
+	}
+
+	delete in;
+}
+
+void SaveStateIndex::save() {
+	Common::OutSaveFile *out = _saveFileMan->openForSaving(getIndexFileName());
+	if (!out)
+		return;
+
+	out->writeUint32BE(MKTAG('S','I','D','X'));
+	out->writeUint32LE(kIndexVersion);
+	out->writeUint32LE(_entries.size());
+	for (EntryList::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry)
+		writeEntry(*out, *entry);
+
+	out->finalize();
+	if (out->err())
+		warning("Could not write the save state index '%s'", getIndexFileName().c_str());
+	delete out;
+}
+
+bool SaveStateIndex::readEntry(Common::SeekableReadStream &in, Entry &entry) const {
+	SaveStateDescriptor &desc = entry.desc;
+	Common::String description, saveDate, saveTime, playTime;
+
+	desc.setSaveSlot(in.readUint32LE());
+	if (!readString(in, entry.fileName))
+		return false;
+	entry.size = in.readUint32LE();
+	entry.timestamp = in.readUint32LE();
+	if (!readString(in, description) || !readString(in, saveDate) || !readString(in, saveTime) || !readString(in, playTime))
+		return false;
+
+	desc.setDescription(description);
+	if (!restoreDates(desc, saveDate, saveTime, playTime))
+		return false;
+
+	const byte flags = in.readByte();
+	desc.setDeletableFlag((flags & kEntryDeletable) != 0);
+	desc.setWriteProtectedFlag((flags & kEntryWriteProtected) != 0);
+
+	if (flags & kEntryThumbnail) {
+		const uint16 w = in.readUint16LE();
+		const uint16 h = in.readUint16LE();
+
+		Graphics::PixelFormat format;
+		format.bytesPerPixel = in.readByte();
+		format.rLoss = in.readByte();
+		format.gLoss = in.readByte();
+		format.bLoss = in.readByte();
+		format.aLoss = in.readByte();
+		format.rShift = in.readByte();
+		format.gShift = in.readByte();
+		format.bShift = in.readByte();
+		format.aShift = in.readByte();
+
+		if (format.bytesPerPixel != 2 && format.bytesPerPixel != 4)
+			return false;
+		if (w == 0 || w > kThumbnailWidth || h == 0 || h > kThumbnailHeight2)
+			return false;
+		if (in.eos() || (uint32)w * h * format.bytesPerPixel > (uint32)(in.size() - in.pos()))
+			return false;
+
+		Graphics::Surface *thumbnail = new Graphics::Surface();
+		thumbnail->create(w, h, format);
+		in.read(thumbnail->pixels, thumbnail->pitch * h);
+		if (format.bytesPerPixel == 2) {
+			uint16 *pixels = (uint16 *)thumbnail->pixels;
+			for (uint32 i = 0; i < (uint32)w * h; ++i)
+				pixels[i] = FROM_LE_16(pixels[i]);
+		} else {
+			uint32 *pixels = (uint32 *)thumbnail->pixels;
+			for (uint32 i = 0; i < (uint32)w * h; ++i)
+				pixels[i] = FROM_LE_32(pixels[i]);
+		}
+		desc.setThumbnail(thumbnail);
+
+		// The dialog shows thumbnails as they are. If the overlay format
+		// changed, the save state has to be read again.
+		if (format != g_system->getOverlayFormat())
+			entry.size = entry.timestamp = kUnknownFileInfo;
+	}
+
+	return !in.err() && !in.eos();
+}
+
+void SaveStateIndex::writeEntry(Common::WriteStream &out, const Entry &entry) const {
+	const SaveStateDescriptor &desc = entry.desc;
+	const Graphics::Surface *thumbnail = desc.getThumbnail();
+
+	out.writeUint32LE(desc.getSaveSlot());
+	writeString(out, entry.fileName);
+	out.writeUint32LE(entry.size);
+	out.writeUint32LE(entry.timestamp);
+	writeString(out, desc.getDescription());
+	writeString(out, desc.getSaveDate());
+	writeString(out, desc.getSaveTime());
+	writeString(out, desc.getPlayTime());
+
+	byte flags = 0;
+	if (desc.getDeletableFlag())
+		flags |= kEntryDeletable;
+	if (desc.getWriteProtectedFlag())
+		flags |= kEntryWriteProtected;
+	if (thumbnail && isIndexableThumbnail(thumbnail))
+		flags |= kEntryThumbnail;
+	out.writeByte(flags);
+
+	if (flags & kEntryThumbnail) {
+		const Graphics::PixelFormat &format = thumbnail->format;
+		out.writeUint16LE(thumbnail->w);
+		out.writeUint16LE(thumbnail->h);
+		out.writeByte(format.bytesPerPixel);
+		out.writeByte(format.rLoss);
+		out.writeByte(format.gLoss);
+		out.writeByte(format.bLoss);
+		out.writeByte(format.aLoss);
+		out.writeByte(format.rShift);
+		out.writeByte(format.gShift);
+		out.writeByte(format.bShift);
+		out.writeByte(format.aShift);
+
+		for (int y = 0; y < thumbnail->h; ++y) {
+			const byte *row = (const byte *)thumbnail->getBasePtr(0, y);
+			for (int x = 0; x < thumbnail->w; ++x) {
+				if (format.bytesPerPixel == 2)
+					out.writeUint16LE(((const uint16 *)row)[x]);
+				else
+					out.writeUint32LE(((const uint32 *)row)[x]);
+			}
+		}
+	}
+}
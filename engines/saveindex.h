@@ -0,0 +1,121 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_SAVEINDEX_H
+#define ENGINES_SAVEINDEX_H
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/str.h"
+
+#include "engines/metaengine.h"
+#include "engines/savestate.h"
+
+namespace Common {
+class SeekableReadStream;
+class SaveFileManager;
+class WriteStream;
+}
+
+/**
+ * A persistent index of the save states of a target. It holds what the
+ * save/load dialog shows: descriptions, save dates, play times and
+ * thumbnails.
+ *
+ * The index is stored in a savefile of its own, "<target>.index". Every
+ * entry remembers the size and modification time of its save file, so only
+ * the save files which were added or changed since the index was written
+ * are read through the MetaEngine.
+ *
+ * Only engines which implement MetaEngine::getSavegameFile() and support
+ * meta infos are indexed, and only if the savefile manager provides the
+ * size and modification time of save files.
+ */
+class SaveStateIndex {
+public:
+	SaveStateIndex(const EnginePlugin *plugin, const Common::String &target);
+
+	/**
+	 * Returns whether the save states of the given target can be indexed.
+	 */
+	static bool isSupported(const EnginePlugin *plugin, const Common::String &target);
+
+	/**
+	 * Brings the index up to date with the save files, and returns the
+	 * save states like MetaEngine::listSaves() does. The index is written
+	 * back if any entry changed.
+	 */
+	SaveStateList listSaves();
+
+	/**
+	 * Returns the meta infos of a save state from the index, like
+	 * MetaEngine::querySaveMetaInfos() does. Has to be called after
+	 * listSaves().
+	 */
+	SaveStateDescriptor querySaveMetaInfos(int slot) const;
+
+	/**
+	 * Removes the given save state from the index, e.g. after it was saved,
+	 * and writes the index back. The next listSaves() reads it again.
+	 */
+	void invalidateSlot(int slot);
+
+private:
+	struct Entry {
+		Common::String fileName;
+		uint32 size;
+		uint32 timestamp;
+		SaveStateDescriptor desc;
+	};
+
+	/** The entries, sorted by slot. */
+	typedef Common::Array<Entry> EntryList;
+
+	const EnginePlugin *_plugin;
+	Common::String _target;
+	Common::SaveFileManager *_saveFileMan;
+	EntryList _entries;
+	bool _loaded;
+
+	/** The existing save files of the target, listed by listSaves() */
+	Common::HashMap<Common::String, bool> _saveFiles;
+
+	Common::String getIndexFileName() const;
+	int findEntry(int slot) const;
+	void listSaveFiles();
+
+	void load();
+	void save();
+
+	/**
+	 * Checks the entry of a slot against its save file, and reads the save
+	 * state if it is missing or outdated. Returns whether the entry
+	 * changed.
+	 */
+	bool updateEntry(int slot);
+
+	bool readEntry(Common::SeekableReadStream &in, Entry &entry) const;
+	void writeEntry(Common::WriteStream &out, const Entry &entry) const;
+};
+
+#endif
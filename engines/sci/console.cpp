@@ -47,6 +47,9 @@
 #include "sci/graphics/palette.h"
 #include "sci/graphics/ports.h"
 #include "sci/graphics/view.h"
+#ifdef ENABLE_SCI32
+#include "sci/graphics/frameout.h"
+#endif
 
 #include "sci/parser/vocabulary.h"
 
@@ -108,6 +111,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	DCmd_Register("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	DCmd_Register("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	DCmd_Register("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	DCmd_Register("list",				WRAP_METHOD(Console, cmdList));
 	DCmd_Register("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	DCmd_Register("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
@@ -133,6 +137,8 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	DCmd_Register("wl",                 WRAP_METHOD(Console, cmdWindowList));	// alias
 	DCmd_Register("saved_bits",         WRAP_METHOD(Console, cmdSavedBits));
 	DCmd_Register("show_saved_bits",    WRAP_METHOD(Console, cmdShowSavedBits));
+	DCmd_Register("frame_stats",        WRAP_METHOD(Console, cmdFrameStats));
+	DCmd_Register("gfx_cache",          WRAP_METHOD(Console, cmdGfxCache));
 	// Segments
 	DCmd_Register("segment_table",		WRAP_METHOD(Console, cmdPrintSegmentTable));
 	DCmd_Register("segtable",			WRAP_METHOD(Console, cmdPrintSegmentTable));	// alias
@@ -344,6 +350,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	DebugPrintf(" resource_info - Shows info about a resource\n");
 	DebugPrintf(" resource_types - Shows the valid resource types\n");
+	DebugPrintf(" resource_cache - Shows memory usage and statistics of the resource cache\n");
 	DebugPrintf(" list - Lists all the resources of a given type\n");
 	DebugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	DebugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
@@ -368,6 +375,8 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	DebugPrintf(" animate_object_list / al - Shows the current list of objects in kAnimate's draw list\n");
 	DebugPrintf(" saved_bits - List saved bits on the hunk\n");
 	DebugPrintf(" show_saved_bits - Display saved bits\n");
+	DebugPrintf(" frame_stats - Shows how many frames were drawn and how many pixels were copied to the screen (SCI32)\n");
+	DebugPrintf(" gfx_cache - Shows memory usage and statistics of the view and font cache\n");
 	DebugPrintf("\n");
 	DebugPrintf("Segments:\n");
 	DebugPrintf(" segment_table / segtable - Lists all segments\n");
@@ -775,6 +784,24 @@ bool Console::cmdResourceInfo(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceCacheStats stats;
+	_engine->getResMan()->getCacheStats(stats);
+
+	const uint32 lookups = stats.hits + stats.misses;
+
+	DebugPrintf("Cache size: %d KB\n", stats.maxMemory / 1024);
+	DebugPrintf("Cached: %d entries, %d KB\n", stats.entriesLRU, stats.memoryLRU / 1024);
+	DebugPrintf("Locked: %d KB\n", stats.memoryLocked / 1024);
+	DebugPrintf("Lookups: %d (%d hits, %d misses", lookups, stats.hits, stats.misses);
+	if (lookups)
+		DebugPrintf(", %d%% hit rate", (int)(stats.hits * 100.0 / lookups));
+	DebugPrintf(")\n");
+	DebugPrintf("Evictions: %d\n", stats.evictions);
+
+	return true;
+}
+
 bool Console::cmdResourceTypes(int argc, const char **argv) {
 	DebugPrintf("The %d valid resource types are:\n", kResourceTypeInvalid);
 	for (int i = 0; i < kResourceTypeInvalid; i++) {
@@ -1771,6 +1798,36 @@ bool Console::cmdShowSavedBits(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdFrameStats(int argc, const char **argv) {
+#ifdef ENABLE_SCI32
+	if (_engine->_gfxFrameout) {
+		_engine->_gfxFrameout->printFrameStats(this);
+		return true;
+	}
+#endif
+	DebugPrintf("This command is only available in SCI32 games\n");
+	return true;
+}
+
+bool Console::cmdGfxCache(int argc, const char **argv) {
+	GfxCacheStats stats;
+	_engine->_gfxCache->getCacheStats(stats);
+
+	const uint32 lookups = stats.viewHits + stats.viewMisses;
+
+	DebugPrintf("View cache size: %d KB\n", stats.maxViewMemory / 1024);
+	DebugPrintf("Views: %d entries, %d KB\n", stats.viewEntries, stats.viewMemory / 1024);
+	DebugPrintf("View lookups: %d (%d hits, %d misses", lookups, stats.viewHits, stats.viewMisses);
+	if (lookups)
+		DebugPrintf(", %d%% hit rate", (int)(stats.viewHits * 100.0 / lookups));
+	DebugPrintf(")\n");
+	DebugPrintf("View evictions: %d\n", stats.viewEvictions);
+	DebugPrintf("Fonts: %d entries, %d lookups (%d hits, %d misses)\n", stats.fontEntries,
+			stats.fontHits + stats.fontMisses, stats.fontHits, stats.fontMisses);
+
+	return true;
+}
+
 
 bool Console::cmdParseGrammar(int argc, const char **argv) {
 	DebugPrintf("Parse grammar, in strict GNF:\n");
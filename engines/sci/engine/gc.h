@@ -24,7 +24,7 @@
 #ifndef SCI_ENGINE_GC_H
 #define SCI_ENGINE_GC_H
 
-#include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/state.h"
 
@@ -38,9 +38,9 @@ struct reg_t_Hash {
 
 /*
  * The AddrSet is a "set" of reg_t values.
- * We don't have a HashSet type, so we abuse a HashMap for this.
+ * We don't have a HashSet type, so we abuse a FlatHashMap for this.
  */
-typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
+typedef Common::FlatHashMap<reg_t, bool, reg_t_Hash> AddrSet;
 
 /**
  * Finds all used references and normalises them to their memory addresses
@@ -29,6 +29,7 @@
 #include "sci/graphics/screen.h"
 
 #include "common/debug-channels.h"
+#include "common/array.h"
 #include "common/list.h"
 #include "common/system.h"
 
@@ -94,21 +95,25 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Position in the vertex index
+	int index;
+
+	// A* open set position (-1 if not in the open set) and insertion order
+	int heapIndex;
+	uint32 openOrder;
+
+	// Whether the shortest path to this vertex is known
+	bool closed;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
+		costF = HUGE_DISTANCE;
 		costG = HUGE_DISTANCE;
 		path_prev = NULL;
-	}
-};
-
-class VertexList: public Common::List<Vertex *> {
-public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
-		}
-		return false;
+		index = -1;
+		heapIndex = -1;
+		openOrder = 0;
+		closed = false;
 	}
 };
 
@@ -228,6 +233,14 @@ struct PathfindingState {
 	// Total number of vertices
 	int vertices;
 
+	// Vertex visibility matrix, indexed by vertex index (see VisibilityState)
+	byte *visibility;
+
+	// Number of single-vertex polygons merge_point() added at the front
+	// of the polygon list, and whether it split an existing edge
+	int _mergedPolygons;
+	bool _edgeSplit;
+
 	// Point to prepend and append to final path
 	Common::Point *_prependPoint;
 	Common::Point *_appendPoint;
@@ -239,13 +252,17 @@ struct PathfindingState {
 		vertex_start = NULL;
 		vertex_end = NULL;
 		vertex_index = NULL;
+		visibility = NULL;
 		_prependPoint = NULL;
 		_appendPoint = NULL;
 		vertices = 0;
+		_mergedPolygons = 0;
+		_edgeSplit = false;
 	}
 
 	~PathfindingState() {
 		free(vertex_index);
+		free(visibility);
 
 		delete _prependPoint;
 		delete _appendPoint;
@@ -637,46 +654,140 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
+// States of the entries in the vertex visibility matrix
+enum VisibilityState {
+	VIS_UNKNOWN = 0,
+	VIS_HIDDEN = 1,
+	VIS_VISIBLE = 2
+};
+
 /**
- * Returns a list of all vertices that are visible from a particular vertex.
+ * Determines whether two vertices are visible from each other. The result
+ * does not depend on the order of the two vertices.
  * @param s				the pathfinding state
- * @param vertex_cur	the vertex
- * @return list of vertices that are visible from vert
+ * @param vertex_cur	the first vertex
+ * @param vertex		the second vertex
+ * @return true if the line between the vertices is not obstructed
  */
-static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
-	VertexList *visVerts = new VertexList();
+static bool vertices_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
 
-	for (int i = 0; i < s->vertices; i++) {
-		Vertex *vertex = s->vertex_index[i];
+	// Check for intersecting edges
+	for (int j = 0; j < s->vertices; j++) {
+		Vertex *edge = s->vertex_index[j];
+		if (VERTEX_HAS_EDGES(edge)) {
+			if (between(vertex_cur->v, vertex->v, edge->v)) {
+				// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+				if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
+					return false;
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
-			continue;
+				// This edge won't properly intersect, so we continue
+				continue;
+			}
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
-
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
+			if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
+				return false;
+		}
+	}
 
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
+	return true;
+}
+
+/**
+ * Looks up whether two vertices are visible from each other in the
+ * visibility matrix, computing (and recording) the answer if unknown
+ * @param s				the pathfinding state
+ * @param vertex_cur	the first vertex
+ * @param vertex		the second vertex
+ * @return true if the line between the vertices is not obstructed
+ */
+static bool is_visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	byte &state = s->visibility[vertex_cur->index * s->vertices + vertex->index];
+
+	if (state == VIS_UNKNOWN) {
+		state = vertices_visible(s, vertex_cur, vertex) ? VIS_VISIBLE : VIS_HIDDEN;
+		s->visibility[vertex->index * s->vertices + vertex_cur->index] = state;
+	}
+
+	return state == VIS_VISIBLE;
+}
+
+/**
+ * Builds the cache key for the polygon set of a pathfinding state: the
+ * sizes and vertices of all polygons, except for the ones merge_point()
+ * added for the start and end point. Those have no edges, so they don't
+ * affect whether other vertices can see each other.
+ * Parameters: (PathfindingState *) s: The pathfinding state
+ *             (Common::Array<int16> &) key: The key
+ */
+static void visibility_cache_key(PathfindingState *s, Common::Array<int16> &key) {
+	PolygonList::iterator it = s->polygons.begin();
+
+	for (int i = 0; i < s->_mergedPolygons; i++)
+		++it;
+
+	for (; it != s->polygons.end(); ++it) {
+		Polygon *polygon = *it;
+		Vertex *vertex;
+
+		key.push_back(polygon->vertices.size());
+		CLIST_FOREACH(vertex, &polygon->vertices) {
+			key.push_back(vertex->v.x);
+			key.push_back(vertex->v.y);
 		}
+	}
+}
+
+/**
+ * Sets up the visibility matrix of a pathfinding state, using what the
+ * cache knows about the visibility graph of the polygon set
+ * Parameters: (PathfindingState *) s: The pathfinding state
+ *             (AvoidPathCache *) cache: The cache
+ */
+static void load_visibility(PathfindingState *s, AvoidPathCache *cache) {
+	s->visibility = (byte *)calloc(s->vertices * s->vertices, 1);
 
-		if (j == s->vertices)
-			visVerts->push_front(vertex);
+	// Splitting an edge changes the polygons themselves
+	if (s->_edgeSplit)
+		return;
+
+	Common::Array<int16> key;
+	visibility_cache_key(s, key);
+
+	const int offset = s->_mergedPolygons;
+	const int size = s->vertices - offset;
+
+	if (key != cache->polygons) {
+		cache->polygons = key;
+		cache->visibility.clear();
+		cache->visibility.resize(size * size);
+		return;
 	}
 
-	return visVerts;
+	debugC(kDebugLevelAvoidPath, "AvoidPath: Reusing visibility graph of %d vertices", size);
+
+	for (int i = 0; i < size; i++)
+		memcpy(s->visibility + (i + offset) * s->vertices + offset, &cache->visibility[i * size], size);
+}
+
+/**
+ * Stores the visibility information gathered by AStar() in the cache
+ * Parameters: (PathfindingState *) s: The pathfinding state
+ *             (AvoidPathCache *) cache: The cache
+ */
+static void store_visibility(PathfindingState *s, AvoidPathCache *cache) {
+	if (s->_edgeSplit)
+		return;
+
+	const int offset = s->_mergedPolygons;
+	const int size = s->vertices - offset;
+
+	assert(cache->visibility.size() == (uint)(size * size));
+
+	for (int i = 0; i < size; i++)
+		memcpy(&cache->visibility[i * size], s->visibility + (i + offset) * s->vertices + offset, size);
 }
 
 /**
@@ -1061,6 +1172,7 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 				if (between(vertex->v, next->v, v)) {
 					// Split edge by adding vertex
 					polygon->vertices.insertAfter(vertex, v_new);
+					s->_edgeSplit = true;
 					return v_new;
 				}
 			}
@@ -1071,6 +1183,7 @@ static Vertex *merge_point(PathfindingState *s, const Common::Point &v) {
 	polygon = new Polygon(POLY_BARRED_ACCESS);
 	polygon->vertices.insertHead(v_new);
 	s->polygons.push_front(polygon);
+	s->_mergedPolygons++;
 
 	return v_new;
 }
@@ -1271,6 +1384,7 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		Vertex *vertex;
 
 		CLIST_FOREACH(vertex, &polygon->vertices) {
+			vertex->index = count;
 			pf_s->vertex_index[count++] = vertex;
 		}
 	}
@@ -1280,6 +1394,97 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	return pf_s;
 }
 
+/**
+ * The A* open set: a binary heap of vertices ordered by F cost. Ties are
+ * broken in favour of the vertex that entered the open set last.
+ */
+class OpenSet {
+public:
+	OpenSet() : _order(0) {}
+
+	bool empty() const {
+		return _heap.empty();
+	}
+
+	bool contains(Vertex *vertex) const {
+		return vertex->heapIndex >= 0;
+	}
+
+	void push(Vertex *vertex) {
+		vertex->openOrder = _order++;
+		_heap.push_back(vertex);
+		siftUp(_heap.size() - 1);
+	}
+
+	Vertex *top() const {
+		return _heap[0];
+	}
+
+	void pop() {
+		Vertex *last = _heap.back();
+		_heap[0]->heapIndex = -1;
+		_heap.pop_back();
+
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			siftDown(0);
+		}
+	}
+
+	/**
+	 * Restores the heap order after the cost of a vertex was lowered.
+	 */
+	void decreased(Vertex *vertex) {
+		siftUp(vertex->heapIndex);
+	}
+
+private:
+	static bool before(const Vertex *a, const Vertex *b) {
+		if (a->costF != b->costF)
+			return a->costF < b->costF;
+		return a->openOrder > b->openOrder;
+	}
+
+	void place(Vertex *vertex, uint index) {
+		_heap[index] = vertex;
+		vertex->heapIndex = index;
+	}
+
+	void siftUp(uint index) {
+		Vertex *vertex = _heap[index];
+
+		while (index > 0) {
+			const uint parent = (index - 1) / 2;
+			if (!before(vertex, _heap[parent]))
+				break;
+			place(_heap[parent], index);
+			index = parent;
+		}
+
+		place(vertex, index);
+	}
+
+	void siftDown(uint index) {
+		Vertex *vertex = _heap[index];
+		const uint size = _heap.size();
+
+		while (2 * index + 1 < size) {
+			uint child = 2 * index + 1;
+			if (child + 1 < size && before(_heap[child + 1], _heap[child]))
+				child++;
+			if (!before(_heap[child], vertex))
+				break;
+			place(_heap[child], index);
+			index = child;
+		}
+
+		place(vertex, index);
+	}
+
+	Common::Array<Vertex *> _heap;
+	uint32 _order;
+};
+
 /**
  * Computes a shortest path from vertex_start to vertex_end. The caller can
  * construct the resulting path by following the path_prev links from
@@ -1288,53 +1493,34 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
-
-	// The remaining vertices
-	VertexList openSet;
+	// The vertices that have been reached, but of which the shortest
+	// path is not known yet
+	OpenSet openSet;
 
-	openSet.push_front(s->vertex_start);
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
+	openSet.push(s->vertex_start);
 
 	while (!openSet.empty()) {
-		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = 0;
-		uint32 min = HUGE_DISTANCE;
-
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
-			}
-		}
-
-		assert(vertex_min != 0);	// the vertex cost should never be bigger than HUGE_DISTANCE
+		// Take the vertex in the open set with the lowest F cost
+		Vertex *vertex_min = openSet.top();
 
 		// Check if we are done
 		if (vertex_min == s->vertex_end)
 			break;
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+		openSet.pop();
+		vertex_min->closed = true;
 
-		VertexList *visVerts = visible_vertices(s, vertex_min);
-
-		for (VertexList::iterator it = visVerts->begin(); it != visVerts->end(); ++it) {
+		// Visit the visible vertices, from the end of the vertex index
+		for (int i = s->vertices - 1; i >= 0; i--) {
 			uint32 new_dist;
-			Vertex *vertex = *it;
+			Vertex *vertex = s->vertex_index[i];
 
-			if (closedSet.contains(vertex))
+			if (vertex->closed || !is_visible(s, vertex_min, vertex))
 				continue;
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
-
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
 			// When travelling to a vertex on the screen edge, we
@@ -1347,14 +1533,19 @@ static void AStar(PathfindingState *s) {
 			if (s->pointOnScreenBorder(vertex->v))
 				new_dist += 10000;
 
-			if (new_dist < vertex->costG) {
+			const bool improved = new_dist < vertex->costG;
+
+			if (improved) {
 				vertex->costG = new_dist;
 				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
 				vertex->path_prev = vertex_min;
 			}
-		}
 
-		delete visVerts;
+			if (!openSet.contains(vertex))
+				openSet.push(vertex);
+			else if (improved)
+				openSet.decreased(vertex);
+		}
 	}
 
 	if (openSet.empty())
@@ -1532,8 +1723,10 @@ reg_t kAvoidPath(EngineState *s, int argc, reg_t *argv) {
 			return output;
 		}
 
-		// Apply Dijkstra
+		// Apply Dijkstra, reusing what we know about the polygon set
+		load_visibility(p, &s->_avoidPathCache);
 		AStar(p);
+		store_visibility(p, &s->_avoidPathCache);
 
 		output = output_path(p, s);
 		delete p;
@@ -119,6 +119,9 @@ void playVideo(Video::VideoDecoder *videoDecoder, VideoState videoState) {
 
 	delete[] scaleBuffer;
 	delete videoDecoder;
+
+	// The video was drawn over the screen
+	g_sci->_gfxScreen->invalidateScreenCopy();
 }
 
 reg_t kShowMovie(EngineState *s, int argc, reg_t *argv) {
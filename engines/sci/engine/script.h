@@ -23,6 +23,7 @@
 #ifndef SCI_ENGINE_SCRIPT_H
 #define SCI_ENGINE_SCRIPT_H
 
+#include "common/flathashmap.h"
 #include "common/str.h"
 #include "sci/engine/segment.h"
 
@@ -46,7 +47,7 @@ enum ScriptObjectTypes {
 	SCI_OBJ_LOCALVARS
 };
 
-typedef Common::HashMap<uint16, Object> ObjMap;
+typedef Common::FlatHashMap<uint16, Object> ObjMap;
 
 class Script : public SegmentObj {
 private:
@@ -445,7 +445,7 @@ private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
 	/** Map script ids to segment ids. */
-	Common::HashMap<int, SegmentId> _scriptSegMap;
+	Common::FlatHashMap<int, SegmentId> _scriptSegMap;
 
 	ResourceManager *_resMan;
 
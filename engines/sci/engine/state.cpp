@@ -111,6 +111,8 @@ void EngineState::reset(bool isRestoring) {
 
 	_cursorWorkaroundActive = false;
 
+	_avoidPathCache.clear();
+
 	scriptStepCounter = 0;
 	scriptGCInterval = GC_INTERVAL;
 
@@ -131,6 +131,21 @@ struct VideoState {
 	}
 };
 
+/**
+ * What kAvoidPath found out about the visibility graph of the polygon set
+ * it was last called with. Rooms tend to call it over and over with the
+ * same polygons. See kpathing.cpp.
+ */
+struct AvoidPathCache {
+	Common::Array<int16> polygons;	///< Sizes and vertices of the polygons
+	Common::Array<byte> visibility;	///< Vertex visibility matrix
+
+	void clear() {
+		polygons.clear();
+		visibility.clear();
+	}
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -169,6 +184,8 @@ public:
 	Common::Point _cursorWorkaroundPoint;
 	Common::Rect _cursorWorkaroundRect;
 
+	AvoidPathCache _avoidPathCache;
+
 public:
 	/* VM Information */
 
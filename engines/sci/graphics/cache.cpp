@@ -36,6 +36,13 @@ namespace Sci {
 
 GfxCache::GfxCache(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette)
 	: _resMan(resMan), _screen(screen), _palette(palette) {
+	_viewMemory = 0;
+	_useCounter = 0;
+	_viewHits = 0;
+	_viewMisses = 0;
+	_viewEvictions = 0;
+	_fontHits = 0;
+	_fontMisses = 0;
 }
 
 GfxCache::~GfxCache() {
@@ -45,8 +52,8 @@ GfxCache::~GfxCache() {
 
 void GfxCache::purgeFontCache() {
 	for (FontCache::iterator iter = _cachedFonts.begin(); iter != _cachedFonts.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
+		delete iter->_value.font;
+		iter->_value.font = 0;
 	}
 
 	_cachedFonts.clear();
@@ -54,36 +61,111 @@ void GfxCache::purgeFontCache() {
 
 void GfxCache::purgeViewCache() {
 	for (ViewCache::iterator iter = _cachedViews.begin(); iter != _cachedViews.end(); ++iter) {
-		delete iter->_value;
-		iter->_value = 0;
+		delete iter->_value.view;
+		iter->_value.view = 0;
 	}
 
 	_cachedViews.clear();
+	_viewUseList.clear();
+	_viewMemory = 0;
+}
+
+uint32 GfxCache::nextUse() {
+	if (++_useCounter == 0) {
+		// The counter wrapped around, start over. This loses the order of
+		// the entries, which only affects which ones get freed next.
+		for (FontCache::iterator iter = _cachedFonts.begin(); iter != _cachedFonts.end(); ++iter)
+			iter->_value.lastUsed = 0;
+		_useCounter = 1;
+	}
+	return _useCounter;
 }
 
 GfxFont *GfxCache::getFont(GuiResourceId fontId) {
-	if (_cachedFonts.size() >= MAX_CACHED_FONTS)
-		purgeFontCache();
-
-	if (!_cachedFonts.contains(fontId)) {
-		// Create special SJIS font in japanese games, when font 900 is selected
-		if ((fontId == 900) && (g_sci->getLanguage() == Common::JA_JPN))
-			_cachedFonts[fontId] = new GfxFontSjis(_screen, fontId);
-		else
-			_cachedFonts[fontId] = new GfxFontFromResource(_resMan, _screen, fontId);
+	FontCache::iterator cached = _cachedFonts.find(fontId);
+	if (cached != _cachedFonts.end()) {
+		_fontHits++;
+		cached->_value.lastUsed = nextUse();
+		return cached->_value.font;
+	}
+
+	_fontMisses++;
+
+	// Free the least recently used font. Fonts are small, so their number is
+	// limited instead of their memory.
+	if (_cachedFonts.size() >= MAX_CACHED_FONTS) {
+		FontCache::iterator oldest = _cachedFonts.begin();
+		for (FontCache::iterator iter = _cachedFonts.begin(); iter != _cachedFonts.end(); ++iter) {
+			if (iter->_value.lastUsed < oldest->_value.lastUsed)
+				oldest = iter;
+		}
+		delete oldest->_value.font;
+		_cachedFonts.erase(oldest);
 	}
 
-	return _cachedFonts[fontId];
+	CachedFont entry;
+	// Create special SJIS font in japanese games, when font 900 is selected
+	if ((fontId == 900) && (g_sci->getLanguage() == Common::JA_JPN))
+		entry.font = new GfxFontSjis(_screen, fontId);
+	else
+		entry.font = new GfxFontFromResource(_resMan, _screen, fontId);
+	entry.lastUsed = nextUse();
+	_cachedFonts[fontId] = entry;
+
+	return entry.font;
 }
 
 GfxView *GfxCache::getView(GuiResourceId viewId) {
-	if (_cachedViews.size() >= MAX_CACHED_VIEWS)
-		purgeViewCache();
+	ViewCache::iterator cached = _cachedViews.find(viewId);
+	if (cached != _cachedViews.end()) {
+		_viewHits++;
+		// Move the view to the end of the use list
+		_viewUseList.erase(cached->_value.usePos);
+		_viewUseList.push_back(viewId);
+		cached->_value.usePos = _viewUseList.reverse_begin();
+		return cached->_value.view;
+	}
+
+	_viewMisses++;
 
-	if (!_cachedViews.contains(viewId))
-		_cachedViews[viewId] = new GfxView(_resMan, _screen, _palette, viewId);
+	CachedView entry;
+	entry.view = new GfxView(_resMan, _screen, _palette, viewId);
+	entry.view->setCache(this);
+	_viewMemory += entry.view->getMemorySize();
+	freeUnusedViews(entry.view);
+	_viewUseList.push_back(viewId);
+	entry.usePos = _viewUseList.reverse_begin();
+	_cachedViews[viewId] = entry;
 
-	return _cachedViews[viewId];
+	return entry.view;
+}
+
+void GfxCache::addViewMemory(const GfxView *view, uint32 size) {
+	_viewMemory += size;
+	freeUnusedViews(view);
+}
+
+/**
+ * Frees the least recently used views until the others fit into the budget.
+ * The views grow while their cels get unpacked, so this is checked whenever
+ * a view is added or grows. The view being added or unpacked is kept.
+ */
+void GfxCache::freeUnusedViews(const GfxView *keep) {
+	ViewUseList::iterator pos = _viewUseList.begin();
+	while (_viewMemory > MAX_CACHED_VIEWS_MEMORY && pos != _viewUseList.end()) {
+		ViewCache::iterator oldest = _cachedViews.find(*pos);
+		assert(oldest != _cachedViews.end());
+		if (oldest->_value.view == keep) {
+			++pos;
+			continue;
+		}
+
+		_viewMemory -= oldest->_value.view->getMemorySize();
+		delete oldest->_value.view;
+		_cachedViews.erase(oldest);
+		pos = _viewUseList.erase(pos);
+		_viewEvictions++;
+	}
 }
 
 int16 GfxCache::kernelViewGetCelWidth(GuiResourceId viewId, int16 loopNo, int16 celNo) {
@@ -102,4 +184,16 @@ int16 GfxCache::kernelViewGetCelCount(GuiResourceId viewId, int16 loopNo) {
 	return getView(viewId)->getCelCount(loopNo);
 }
 
+void GfxCache::getCacheStats(GfxCacheStats &stats) const {
+	stats.maxViewMemory = MAX_CACHED_VIEWS_MEMORY;
+	stats.viewMemory = _viewMemory;
+	stats.viewEntries = _cachedViews.size();
+	stats.viewHits = _viewHits;
+	stats.viewMisses = _viewMisses;
+	stats.viewEvictions = _viewEvictions;
+	stats.fontEntries = _cachedFonts.size();
+	stats.fontHits = _fontHits;
+	stats.fontMisses = _fontMisses;
+}
+
 } // End of namespace Sci
@@ -24,17 +24,45 @@
 #define SCI_GRAPHICS_CACHE_H
 
 #include "common/hashmap.h"
+#include "common/list.h"
 
 namespace Sci {
 
 class GfxFont;
 class GfxView;
 
-typedef Common::HashMap<int, GfxFont *> FontCache;
-typedef Common::HashMap<int, GfxView *> ViewCache;
+struct CachedFont {
+	GfxFont *font;
+	uint32 lastUsed;
+};
+
+typedef Common::List<GuiResourceId> ViewUseList;
+
+struct CachedView {
+	GfxView *view;
+	ViewUseList::iterator usePos;	///< Position of the view in GfxCache::_viewUseList
+};
+
+typedef Common::HashMap<int, CachedFont> FontCache;
+typedef Common::HashMap<int, CachedView> ViewCache;
+
+/** Statistics of the view and font caches, as shown by the debugger */
+struct GfxCacheStats {
+	uint32 maxViewMemory;	///< Budget for cached views, in bytes
+	uint32 viewMemory;		///< Bytes used by cached views, including their unpacked cels
+	uint viewEntries;		///< Number of cached views
+	uint32 viewHits;		///< Lookups of views which were cached already
+	uint32 viewMisses;		///< Lookups which had to load the view
+	uint32 viewEvictions;	///< Views freed to stay within the budget
+	uint fontEntries;		///< Number of cached fonts
+	uint32 fontHits;		///< Lookups of fonts which were cached already
+	uint32 fontMisses;		///< Lookups which had to load the font
+};
 
 /**
- * Cache class, handles caching of views/fonts
+ * Cache class, handles caching of views/fonts. When the caches are full, the
+ * least recently used entries are freed. Views are limited by the memory they
+ * use, which includes their unpacked cels, fonts by their number.
  */
 class GfxCache {
 public:
@@ -49,9 +77,24 @@ public:
 	int16 kernelViewGetLoopCount(GuiResourceId viewId);
 	int16 kernelViewGetCelCount(GuiResourceId viewId, int16 loopNo);
 
+	/**
+	 * Returns the current state of the view and font caches.
+	 * @param stats	Receives the statistics
+	 */
+	void getCacheStats(GfxCacheStats &stats) const;
+
+	/**
+	 * Called by cached views when they unpacked a cel. Frees the least
+	 * recently used views other than the given one, if the budget is
+	 * exceeded.
+	 */
+	void addViewMemory(const GfxView *view, uint32 size);
+
 private:
 	void purgeFontCache();
 	void purgeViewCache();
+	void freeUnusedViews(const GfxView *keep);
+	uint32 nextUse();
 
 	ResourceManager *_resMan;
 	GfxScreen *_screen;
@@ -59,6 +102,19 @@ private:
 
 	FontCache _cachedFonts;
 	ViewCache _cachedViews;
+
+	/** Cached views, the least recently used one first */
+	ViewUseList _viewUseList;
+	/** Bytes used by the cached views, updated by them when they unpack cels */
+	uint32 _viewMemory;
+
+	uint32 _useCounter;	///< Increased on every font lookup, orders the fonts by their last use
+
+	uint32 _viewHits;
+	uint32 _viewMisses;
+	uint32 _viewEvictions;
+	uint32 _fontHits;
+	uint32 _fontMisses;
 };
 
 } // End of namespace Sci
@@ -31,6 +31,7 @@
 #include "graphics/surface.h"
 
 #include "sci/sci.h"
+#include "sci/console.h"
 #include "sci/engine/kernel.h"
 #include "sci/engine/state.h"
 #include "sci/engine/selector.h"
@@ -56,6 +57,11 @@ GfxFrameout::GfxFrameout(SegManager *segMan, ResourceManager *resMan, GfxCoordAd
 	_coordAdjuster = (GfxCoordAdjuster32 *)coordAdjuster;
 	scriptsRunningWidth = 320;
 	scriptsRunningHeight = 200;
+
+	_lastFramePixels = 0;
+	_statsFrames = 0;
+	_statsFramesDrawn = 0;
+	_statsPixels = 0;
 }
 
 GfxFrameout::~GfxFrameout() {
@@ -65,6 +71,8 @@ void GfxFrameout::clear() {
 	_screenItems.clear();
 	_planes.clear();
 	_planePictures.clear();
+	_frameState.clear();
+	_screen->invalidateScreenCopy();
 }
 
 void GfxFrameout::kernelAddPlane(reg_t object) {
@@ -354,6 +362,119 @@ static int16 GetLongest(const char *text, int16 maxWidth, GfxFont *font) {
 	return maxChars;
 }
 
+static uint32 getStateKey(reg_t object) {
+	return (object.segment << 16) | object.offset;
+}
+
+static void addDirtyRect(Common::Rect &dirtyRect, const Common::Rect &rect) {
+	if (rect.isEmpty())
+		return;
+	if (dirtyRect.isEmpty())
+		dirtyRect = rect;
+	else
+		dirtyRect.extend(rect);
+}
+
+/** Returns the rect in screen coordinates which covers a display rect. */
+static Common::Rect displayToScreenRect(GfxScreen *screen, const Common::Rect &rect) {
+	if (screen->getUpscaledHires() == GFX_SCREEN_UPSCALED_DISABLED)
+		return rect;
+	// Round outwards, so that the whole display rect is covered
+	const int height = screen->getHeight();
+	const int displayHeight = screen->getDisplayHeight();
+	return Common::Rect(rect.left / 2, rect.top * height / displayHeight,
+			(rect.right + 1) / 2, (rect.bottom * height + displayHeight - 1) / displayHeight);
+}
+
+static bool isTextEntry(const FrameoutEntry *itemEntry) {
+	return !itemEntry->object.isNull() && itemEntry->viewId == 0xFFFF;
+}
+
+/**
+ * Adds everything a screen item is drawn from to its state. Must be called
+ * right after kernelUpdateScreenItem(), before the item gets laid out.
+ */
+void GfxFrameout::addScreenItemState(Common::Array<uint32> &state, reg_t planeObject, FrameoutEntry *itemEntry) {
+	reg_t itemObject = itemEntry->object;
+
+	state.push_back(getStateKey(planeObject));
+	state.push_back(itemEntry->givenOrderNr);
+	state.push_back(itemEntry->viewId);
+	state.push_back((uint16)itemEntry->loopNo);
+	state.push_back((uint16)itemEntry->celNo);
+	state.push_back((uint16)itemEntry->x);
+	state.push_back((uint16)itemEntry->y);
+	state.push_back((uint16)itemEntry->z);
+	state.push_back((uint16)itemEntry->priority);
+	state.push_back(itemEntry->signal);
+	state.push_back((uint16)itemEntry->scaleX);
+	state.push_back((uint16)itemEntry->scaleY);
+
+	if (itemEntry->viewId != 0xFFFF) {
+		uint16 useInsetRect = readSelectorValue(_segMan, itemObject, SELECTOR(useInsetRect));
+		state.push_back(useInsetRect);
+		if (useInsetRect) {
+			state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(inTop)));
+			state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(inLeft)));
+			state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(inBottom)));
+			state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(inRight)));
+		}
+	} else if (lookupSelector(_segMan, itemObject, SELECTOR(text), NULL, NULL) == kSelectorVariable) {
+		Common::String text = getScreenItemText(itemObject);
+		state.push_back(text.size());
+		for (uint i = 0; i < text.size(); i++)
+			state.push_back((byte)text[i]);
+		state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(font)));
+		state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(dimmed)));
+		state.push_back(readSelectorValue(_segMan, itemObject, SELECTOR(fore)));
+	}
+}
+
+/**
+ * Compares the state of the current frame with the last one.
+ * @return the union of the old and new screen rects of everything that
+ * changed, appeared or disappeared since the last frame
+ */
+Common::Rect GfxFrameout::getDirtyRect(const FrameoutStateMap &frameState) {
+	const Common::Rect screenRect(_screen->getWidth(), _screen->getHeight());
+
+	// Something else drew over the last frame
+	if (!_screen->isFrameCopyValid())
+		return screenRect;
+
+	Common::Rect dirtyRect;
+	for (FrameoutStateMap::const_iterator it = frameState.begin(); it != frameState.end(); ++it) {
+		FrameoutStateMap::const_iterator last = _frameState.find(it->_key);
+		if (last == _frameState.end()) {
+			addDirtyRect(dirtyRect, it->_value.rect);
+		} else if (last->_value.state != it->_value.state || last->_value.rect != it->_value.rect) {
+			addDirtyRect(dirtyRect, last->_value.rect);
+			addDirtyRect(dirtyRect, it->_value.rect);
+		}
+	}
+	for (FrameoutStateMap::const_iterator it = _frameState.begin(); it != _frameState.end(); ++it) {
+		if (!frameState.contains(it->_key))
+			addDirtyRect(dirtyRect, it->_value.rect);
+	}
+
+	dirtyRect.clip(screenRect);
+	return dirtyRect;
+}
+
+void GfxFrameout::printFrameStats(Console *con) {
+	const uint32 screenPixels = _screen->getDisplayWidth() * _screen->getDisplayHeight();
+
+	con->DebugPrintf("Last frame: %d pixels copied to the screen (%d%%)\n", _lastFramePixels, _lastFramePixels * 100 / screenPixels);
+	if (_statsFrames) {
+		con->DebugPrintf("Since the last call: %d frames, %d drawn, %d pixels copied per frame on average (%d%%)\n",
+				_statsFrames, _statsFramesDrawn, _statsPixels / _statsFrames, _statsPixels / _statsFrames * 100 / screenPixels);
+	}
+
+	_statsFrames = 0;
+	_statsFramesDrawn = 0;
+	_statsPixels = 0;
+}
+
 void GfxFrameout::kernelFrameout() {
 	if (g_sci->_robotDecoder->isVideoLoaded()) {
 		bool skipVideo = false;
@@ -385,41 +506,62 @@ void GfxFrameout::kernelFrameout() {
 
 			g_system->delayMillis(10);
 		}
+
+		// The video was drawn over the screen
+		_screen->invalidateScreenCopy();
 		return;
 	}
 
 	_palette->palVaryUpdate();
 
+	// First lay out the frame and collect what every plane and screen item
+	// is drawn from. Only the parts of the screen where something changed
+	// since the last frame get drawn again.
+	FrameoutStateMap frameState;
+	frameState[0].state.push_back(scriptsRunningWidth);
+	frameState[0].state.push_back(scriptsRunningHeight);
+	frameState[0].rect = Common::Rect(_screen->getWidth(), _screen->getHeight());
+
+	Common::Array<FrameoutList> planeItems;
+
 	for (PlaneList::iterator it = _planes.begin(); it != _planes.end(); it++) {
 		reg_t planeObject = it->object;
 		uint16 planeLastPriority = it->lastPriority;
+		planeItems.push_back(FrameoutList());
+		FrameoutList &itemList = planeItems.back();
 
 		// Update priority here, sq6 sets it w/o UpdatePlane
 		uint16 planePriority = it->priority = readSelectorValue(_segMan, planeObject, SELECTOR(priority));
 
 		it->lastPriority = planePriority;
+
 		if (planePriority == 0xffff) { // Plane currently not meant to be shown
+			frameState[getStateKey(planeObject)].state.push_back(planePriority);
 			// If plane was shown before, delete plane rect
 			if (planePriority != planeLastPriority)
 				_paint32->fillRect(it->planeRect, 0);
 			continue;
 		}
 
-		if (it->planeBack)
-			_paint32->fillRect(it->planeRect, it->planeBack);
-
 		GuiResourceId planeMainPictureId = it->pictureId;
 
 		_coordAdjuster->pictureSetDisplayArea(it->planeRect);
 		_palette->drewPicture(planeMainPictureId);
 
-		FrameoutList itemList;
+		FrameoutItemState planeState;
+		planeState.state.push_back(planePriority);
+		planeState.state.push_back((uint16)it->planeOffsetX);
+		planeState.state.push_back(it->pictureId);
+		planeState.state.push_back(it->planePictureMirrored);
+		planeState.state.push_back(it->planeBack);
+		planeState.rect = it->planeRect;
 
 		// Copy screen items of the current frame to the list of items to be drawn
 		for (FrameoutList::iterator listIterator = _screenItems.begin(); listIterator != _screenItems.end(); listIterator++) {
 			reg_t itemPlane = readSelector(_segMan, (*listIterator)->object, SELECTOR(plane));
 			if (planeObject == itemPlane) {
 				kernelUpdateScreenItem((*listIterator)->object);	// TODO: Why is this necessary?
+				addScreenItemState(frameState[getStateKey((*listIterator)->object)].state, planeObject, *listIterator);
 				itemList.push_back(*listIterator);
 			}
 		}
@@ -427,6 +569,9 @@ void GfxFrameout::kernelFrameout() {
 		for (PlanePictureList::iterator pictureIt = _planePictures.begin(); pictureIt != _planePictures.end(); pictureIt++) {
 			if (pictureIt->object == planeObject) {
 				GfxPicture *planePicture = pictureIt->picture;
+				planeState.state.push_back(pictureIt->pictureId);
+				planeState.state.push_back((uint16)pictureIt->startX);
+
 				// Allocate memory for picture cels
 				pictureIt->pictureCels = new FrameoutEntry[planePicture->getSci32celCount()];
 
@@ -449,6 +594,8 @@ void GfxFrameout::kernelFrameout() {
 			}
 		}
 
+		frameState[getStateKey(planeObject)] = planeState;
+
 		// Now sort our itemlist
 		Common::sort(itemList.begin(), itemList.end(), sortHelper);
 
@@ -456,199 +603,297 @@ void GfxFrameout::kernelFrameout() {
 
 		for (FrameoutList::iterator listIterator = itemList.begin(); listIterator != itemList.end(); listIterator++) {
 			FrameoutEntry *itemEntry = *listIterator;
+			layoutScreenItem(*it, itemEntry);
+			if (!itemEntry->object.isNull())
+				frameState[getStateKey(itemEntry->object)].rect = itemEntry->drawnRect;
+		}
+	}
 
-			if (itemEntry->object.isNull()) {
-				// Picture cel data
-				itemEntry->y = ((itemEntry->y * _screen->getHeight()) / scriptsRunningHeight);
-				itemEntry->x = ((itemEntry->x * _screen->getWidth()) / scriptsRunningWidth);
-				itemEntry->picStartX = ((itemEntry->picStartX * _screen->getWidth()) / scriptsRunningWidth);
-
-				// Out of view
-				int16 pictureCelStartX = itemEntry->picStartX + itemEntry->x;
-				int16 pictureCelEndX = pictureCelStartX + itemEntry->picture->getSci32celWidth(itemEntry->celNo);
-				int16 planeStartX = it->planeOffsetX;
-				int16 planeEndX = planeStartX + it->planeRect.width();
-				if (pictureCelEndX < planeStartX)
-					continue;
-				if (pictureCelStartX > planeEndX)
-					continue;
-
-				int16 pictureOffsetX = it->planeOffsetX;
-				int16 pictureX = itemEntry->x;
-				if ((it->planeOffsetX) || (itemEntry->picStartX)) {
-					if (it->planeOffsetX <= itemEntry->picStartX) {
-						pictureX += itemEntry->picStartX - it->planeOffsetX;
-						pictureOffsetX = 0;
-					} else {
-						pictureOffsetX = it->planeOffsetX - itemEntry->picStartX;
-					}
+	Common::Rect dirtyRect = getDirtyRect(frameState);
+
+	// Text can't be drawn clipped, so the dirty rect has to cover all of
+	// every text it touches
+	bool dirtyRectExtended = !dirtyRect.isEmpty();
+	while (dirtyRectExtended) {
+		dirtyRectExtended = false;
+		for (uint planeNr = 0; planeNr < planeItems.size(); planeNr++) {
+			for (FrameoutList::iterator listIterator = planeItems[planeNr].begin(); listIterator != planeItems[planeNr].end(); listIterator++) {
+				const Common::Rect &textRect = (*listIterator)->drawnRect;
+				if (isTextEntry(*listIterator) && textRect.intersects(dirtyRect) && !dirtyRect.contains(textRect)) {
+					dirtyRect.extend(textRect);
+					dirtyRectExtended = true;
 				}
+			}
+		}
+	}
 
-				itemEntry->picture->drawSci32Vga(itemEntry->celNo, pictureX, itemEntry->y, pictureOffsetX, it->planePictureMirrored);
-//				warning("picture cel %d %d", itemEntry->celNo, itemEntry->priority);
+	if (!dirtyRect.isEmpty()) {
+		uint planeNr = 0;
+		for (PlaneList::iterator it = _planes.begin(); it != _planes.end(); it++, planeNr++) {
+			if (it->priority == 0xffff)
+				continue;
 
-			} else if (itemEntry->viewId != 0xFFFF) {
-				GfxView *view = _cache->getView(itemEntry->viewId);
+			_coordAdjuster->pictureSetDisplayArea(it->planeRect);
 
-//				warning("view %s %04x:%04x", _segMan->getObjectName(itemEntry->object), PRINT_REG(itemEntry->object));
+			if (it->planeBack) {
+				Common::Rect backRect = it->planeRect;
+				backRect.clip(dirtyRect);
+				_paint32->fillRect(backRect, it->planeBack);
+			}
 
+			for (FrameoutList::iterator listIterator = planeItems[planeNr].begin(); listIterator != planeItems[planeNr].end(); listIterator++)
+				drawScreenItem(*it, *listIterator, dirtyRect);
+		}
+	}
 
-				if (view->isSci2Hires()) {
-					int16 dummyX = 0;
-					view->adjustToUpscaledCoordinates(itemEntry->y, itemEntry->x);
-					view->adjustToUpscaledCoordinates(itemEntry->z, dummyX);
-				} else if (getSciVersion() == SCI_VERSION_2_1) {
-					itemEntry->y = (itemEntry->y * _screen->getHeight()) / scriptsRunningHeight;
-					itemEntry->x = (itemEntry->x * _screen->getWidth()) / scriptsRunningWidth;
-					itemEntry->z = (itemEntry->z * _screen->getHeight()) / scriptsRunningHeight;
-				}
+	for (PlanePictureList::iterator pictureIt = _planePictures.begin(); pictureIt != _planePictures.end(); pictureIt++) {
+		delete[] pictureIt->pictureCels;
+		pictureIt->pictureCels = 0;
+	}
 
-				// Adjust according to current scroll position
-				itemEntry->x -= it->planeOffsetX;
-
-				uint16 useInsetRect = readSelectorValue(_segMan, itemEntry->object, SELECTOR(useInsetRect));
-				if (useInsetRect) {
-					itemEntry->celRect.top = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inTop));
-					itemEntry->celRect.left = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inLeft));
-					itemEntry->celRect.bottom = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inBottom)) + 1;
-					itemEntry->celRect.right = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inRight)) + 1;
-					if (view->isSci2Hires()) {
-						view->adjustToUpscaledCoordinates(itemEntry->celRect.top, itemEntry->celRect.left);
-						view->adjustToUpscaledCoordinates(itemEntry->celRect.bottom, itemEntry->celRect.right);
-					}
-					itemEntry->celRect.translate(itemEntry->x, itemEntry->y);
-					// TODO: maybe we should clip the cels rect with this, i'm not sure
-					//  the only currently known usage is game menu of gk1
-				} else {
-					if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
-						view->getCelRect(itemEntry->loopNo, itemEntry->celNo, itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->celRect);
-					else
-						view->getCelScaledRect(itemEntry->loopNo, itemEntry->celNo, itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->scaleX, itemEntry->scaleY, itemEntry->celRect);
-
-					Common::Rect nsRect = itemEntry->celRect;
-					// Translate back to actual coordinate within scrollable plane
-					nsRect.translate(it->planeOffsetX, 0);
-
-					if (view->isSci2Hires()) {
-						view->adjustBackUpscaledCoordinates(nsRect.top, nsRect.left);
-						view->adjustBackUpscaledCoordinates(nsRect.bottom, nsRect.right);
-					} else if (getSciVersion() == SCI_VERSION_2_1) {
-						nsRect.top = (nsRect.top * scriptsRunningHeight) / _screen->getHeight();
-						nsRect.left = (nsRect.left * scriptsRunningWidth) / _screen->getWidth();
-						nsRect.bottom = (nsRect.bottom * scriptsRunningHeight) / _screen->getHeight();
-						nsRect.right = (nsRect.right * scriptsRunningWidth) / _screen->getWidth();
-					}
-
-					writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsLeft), nsRect.left);
-					writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsTop), nsRect.top);
-					writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsRight), nsRect.right);
-					writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsBottom), nsRect.bottom);
-				}
+	_frameState = frameState;
 
-				int16 screenHeight = _screen->getHeight();
-				int16 screenWidth = _screen->getWidth();
-				if (view->isSci2Hires()) {
-					screenHeight = _screen->getDisplayHeight();
-					screenWidth = _screen->getDisplayWidth();
-				}
+	_lastFramePixels = _screen->copyFrameRectToScreen(dirtyRect);
+	_statsFrames++;
+	if (!dirtyRect.isEmpty())
+		_statsFramesDrawn++;
+	_statsPixels += _lastFramePixels;
 
-				if (itemEntry->celRect.bottom < 0 || itemEntry->celRect.top >= screenHeight)
-					continue;
-
-				if (itemEntry->celRect.right < 0 || itemEntry->celRect.left >= screenWidth)
-					continue;
-
-				Common::Rect clipRect, translatedClipRect;
-				clipRect = itemEntry->celRect;
-				if (view->isSci2Hires()) {
-					clipRect.clip(it->upscaledPlaneClipRect);
-					translatedClipRect = clipRect;
-					translatedClipRect.translate(it->upscaledPlaneRect.left, it->upscaledPlaneRect.top);
-				} else {
-					clipRect.clip(it->planeClipRect);
-					translatedClipRect = clipRect;
-					translatedClipRect.translate(it->planeRect.left, it->planeRect.top);
-				}
+	g_sci->getEngineState()->_throttleTrigger = true;
+}
 
-				if (!clipRect.isEmpty()) {
-					if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
-						view->draw(itemEntry->celRect, clipRect, translatedClipRect, itemEntry->loopNo, itemEntry->celNo, 255, 0, view->isSci2Hires());
-					else
-						view->drawScaled(itemEntry->celRect, clipRect, translatedClipRect, itemEntry->loopNo, itemEntry->celNo, 255, itemEntry->scaleX, itemEntry->scaleY);
-				}
-			} else {
-				// Most likely a text entry
-				// This draws text the "SCI0-SCI11" way. In SCI2, text is prerendered in kCreateTextBitmap
-				// TODO: rewrite this the "SCI2" way (i.e. implement the text buffer to draw inside kCreateTextBitmap)
-				if (lookupSelector(_segMan, itemEntry->object, SELECTOR(text), NULL, NULL) == kSelectorVariable) {
-					reg_t stringObject = readSelector(_segMan, itemEntry->object, SELECTOR(text));
-
-					// The object in the text selector of the item can be either a raw string
-					// or a Str object. In the latter case, we need to access the object's data
-					// selector to get the raw string.
-					if (_segMan->isHeapObject(stringObject))
-						stringObject = readSelector(_segMan, stringObject, SELECTOR(data));
-
-					Common::String text = _segMan->getString(stringObject);
-					GfxFont *font = _cache->getFont(readSelectorValue(_segMan, itemEntry->object, SELECTOR(font)));
-					bool dimmed = readSelectorValue(_segMan, itemEntry->object, SELECTOR(dimmed));
-					uint16 foreColor = readSelectorValue(_segMan, itemEntry->object, SELECTOR(fore));
-
-					itemEntry->y = ((itemEntry->y * _screen->getHeight()) / scriptsRunningHeight);
-					itemEntry->x = ((itemEntry->x * _screen->getWidth()) / scriptsRunningWidth);
-
-					uint16 startX = itemEntry->x + it->planeRect.left;
-					uint16 curY = itemEntry->y + it->planeRect.top;
-					const char *txt = text.c_str();
-					// HACK. The plane sometimes doesn't contain the correct width. This
-					// hack breaks the dialog options when speaking with Grace, but it's
-					// the best we got up to now. This happens because of the unimplemented
-					// kTextWidth function in SCI32.
-					// TODO: Remove this once kTextWidth has been implemented.
-					uint16 w = it->planeRect.width() >= 20 ? it->planeRect.width() : _screen->getWidth() - 10;
-					int16 charCount;
-
-					// Upscale the coordinates/width if the fonts are already upscaled
-					if (_screen->fontIsUpscaled()) {
-						startX = startX * _screen->getDisplayWidth() / _screen->getWidth();
-						curY = curY * _screen->getDisplayHeight() / _screen->getHeight();
-						w  = w * _screen->getDisplayWidth() / _screen->getWidth();
-					}
-
-					while (*txt) {
-						charCount = GetLongest(txt, w, font);
-						if (charCount == 0)
-							break;
-
-						uint16 curX = startX;
-
-						for (int i = 0; i < charCount; i++) {
-							unsigned char curChar = txt[i];
-							font->draw(curChar, curY, curX, foreColor, dimmed);
-							curX += font->getCharWidth(curChar);
-						}
-
-						curY += font->getHeight();
-						txt += charCount;
-						while (*txt == ' ')
-							txt++; // skip over breaking spaces
-					}
+void GfxFrameout::layoutScreenItem(const PlaneEntry &plane, FrameoutEntry *itemEntry) {
+	itemEntry->drawnRect = Common::Rect();
+
+	if (itemEntry->object.isNull()) {
+		// Picture cel data
+		itemEntry->y = ((itemEntry->y * _screen->getHeight()) / scriptsRunningHeight);
+		itemEntry->x = ((itemEntry->x * _screen->getWidth()) / scriptsRunningWidth);
+		itemEntry->picStartX = ((itemEntry->picStartX * _screen->getWidth()) / scriptsRunningWidth);
+
+		// Out of view
+		int16 pictureCelStartX = itemEntry->picStartX + itemEntry->x;
+		int16 pictureCelEndX = pictureCelStartX + itemEntry->picture->getSci32celWidth(itemEntry->celNo);
+		int16 planeStartX = plane.planeOffsetX;
+		int16 planeEndX = planeStartX + plane.planeRect.width();
+		if (pictureCelEndX < planeStartX)
+			return;
+		if (pictureCelStartX > planeEndX)
+			return;
 
-				}
+		int16 pictureOffsetX = plane.planeOffsetX;
+		int16 pictureX = itemEntry->x;
+		if ((plane.planeOffsetX) || (itemEntry->picStartX)) {
+			if (plane.planeOffsetX <= itemEntry->picStartX) {
+				pictureX += itemEntry->picStartX - plane.planeOffsetX;
+				pictureOffsetX = 0;
+			} else {
+				pictureOffsetX = plane.planeOffsetX - itemEntry->picStartX;
 			}
 		}
 
-		for (PlanePictureList::iterator pictureIt = _planePictures.begin(); pictureIt != _planePictures.end(); pictureIt++) {
-			if (pictureIt->object == planeObject) {
-				delete[] pictureIt->pictureCels;
-				pictureIt->pictureCels = 0;
+		itemEntry->x = pictureX;
+		itemEntry->pictureOffsetX = pictureOffsetX;
+		// Picture cels are clipped to the plane when they are drawn
+		itemEntry->drawnRect = plane.planeRect;
+
+	} else if (itemEntry->viewId != 0xFFFF) {
+		GfxView *view = _cache->getView(itemEntry->viewId);
+
+//		warning("view %s %04x:%04x", _segMan->getObjectName(itemEntry->object), PRINT_REG(itemEntry->object));
+
+		if (view->isSci2Hires()) {
+			int16 dummyX = 0;
+			view->adjustToUpscaledCoordinates(itemEntry->y, itemEntry->x);
+			view->adjustToUpscaledCoordinates(itemEntry->z, dummyX);
+		} else if (getSciVersion() == SCI_VERSION_2_1) {
+			itemEntry->y = (itemEntry->y * _screen->getHeight()) / scriptsRunningHeight;
+			itemEntry->x = (itemEntry->x * _screen->getWidth()) / scriptsRunningWidth;
+			itemEntry->z = (itemEntry->z * _screen->getHeight()) / scriptsRunningHeight;
+		}
+
+		// Adjust according to current scroll position
+		itemEntry->x -= plane.planeOffsetX;
+
+		uint16 useInsetRect = readSelectorValue(_segMan, itemEntry->object, SELECTOR(useInsetRect));
+		if (useInsetRect) {
+			itemEntry->celRect.top = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inTop));
+			itemEntry->celRect.left = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inLeft));
+			itemEntry->celRect.bottom = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inBottom)) + 1;
+			itemEntry->celRect.right = readSelectorValue(_segMan, itemEntry->object, SELECTOR(inRight)) + 1;
+			if (view->isSci2Hires()) {
+				view->adjustToUpscaledCoordinates(itemEntry->celRect.top, itemEntry->celRect.left);
+				view->adjustToUpscaledCoordinates(itemEntry->celRect.bottom, itemEntry->celRect.right);
+			}
+			itemEntry->celRect.translate(itemEntry->x, itemEntry->y);
+			// TODO: maybe we should clip the cels rect with this, i'm not sure
+			//  the only currently known usage is game menu of gk1
+		} else {
+			if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
+				view->getCelRect(itemEntry->loopNo, itemEntry->celNo, itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->celRect);
+			else
+				view->getCelScaledRect(itemEntry->loopNo, itemEntry->celNo, itemEntry->x, itemEntry->y, itemEntry->z, itemEntry->scaleX, itemEntry->scaleY, itemEntry->celRect);
+
+			Common::Rect nsRect = itemEntry->celRect;
+			// Translate back to actual coordinate within scrollable plane
+			nsRect.translate(plane.planeOffsetX, 0);
+
+			if (view->isSci2Hires()) {
+				view->adjustBackUpscaledCoordinates(nsRect.top, nsRect.left);
+				view->adjustBackUpscaledCoordinates(nsRect.bottom, nsRect.right);
+			} else if (getSciVersion() == SCI_VERSION_2_1) {
+				nsRect.top = (nsRect.top * scriptsRunningHeight) / _screen->getHeight();
+				nsRect.left = (nsRect.left * scriptsRunningWidth) / _screen->getWidth();
+				nsRect.bottom = (nsRect.bottom * scriptsRunningHeight) / _screen->getHeight();
+				nsRect.right = (nsRect.right * scriptsRunningWidth) / _screen->getWidth();
 			}
+
+			writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsLeft), nsRect.left);
+			writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsTop), nsRect.top);
+			writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsRight), nsRect.right);
+			writeSelectorValue(_segMan, itemEntry->object, SELECTOR(nsBottom), nsRect.bottom);
 		}
+
+		int16 screenHeight = _screen->getHeight();
+		int16 screenWidth = _screen->getWidth();
+		if (view->isSci2Hires()) {
+			screenHeight = _screen->getDisplayHeight();
+			screenWidth = _screen->getDisplayWidth();
+		}
+
+		if (itemEntry->celRect.bottom < 0 || itemEntry->celRect.top >= screenHeight)
+			return;
+
+		if (itemEntry->celRect.right < 0 || itemEntry->celRect.left >= screenWidth)
+			return;
+
+		Common::Rect clipRect, translatedClipRect;
+		clipRect = itemEntry->celRect;
+		if (view->isSci2Hires()) {
+			clipRect.clip(plane.upscaledPlaneClipRect);
+			translatedClipRect = clipRect;
+			translatedClipRect.translate(plane.upscaledPlaneRect.left, plane.upscaledPlaneRect.top);
+		} else {
+			clipRect.clip(plane.planeClipRect);
+			translatedClipRect = clipRect;
+			translatedClipRect.translate(plane.planeRect.left, plane.planeRect.top);
+		}
+
+		itemEntry->clipRect = clipRect;
+		itemEntry->translatedClipRect = translatedClipRect;
+		if (!clipRect.isEmpty())
+			itemEntry->drawnRect = view->isSci2Hires() ? displayToScreenRect(_screen, translatedClipRect) : translatedClipRect;
+
+	} else if (lookupSelector(_segMan, itemEntry->object, SELECTOR(text), NULL, NULL) == kSelectorVariable) {
+		// Most likely a text entry
+		itemEntry->y = ((itemEntry->y * _screen->getHeight()) / scriptsRunningHeight);
+		itemEntry->x = ((itemEntry->x * _screen->getWidth()) / scriptsRunningWidth);
+		itemEntry->drawnRect = drawText(plane, itemEntry, false);
+	}
+}
+
+/**
+ * Draws the part of a screen item which is inside of dirtyRect. Text is
+ * always drawn completely.
+ */
+void GfxFrameout::drawScreenItem(const PlaneEntry &plane, FrameoutEntry *itemEntry, const Common::Rect &dirtyRect) {
+	if (!itemEntry->drawnRect.intersects(dirtyRect))
+		return;
+
+	if (itemEntry->object.isNull()) {
+		itemEntry->picture->drawSci32Vga(itemEntry->celNo, itemEntry->x, itemEntry->y, itemEntry->pictureOffsetX, plane.planePictureMirrored, dirtyRect);
+//		warning("picture cel %d %d", itemEntry->celNo, itemEntry->priority);
+
+	} else if (itemEntry->viewId != 0xFFFF) {
+		GfxView *view = _cache->getView(itemEntry->viewId);
+
+		// Only draw the part of the cel inside of the dirty rect
+		Common::Rect translatedClipRect = itemEntry->translatedClipRect;
+		translatedClipRect.clip(view->isSci2Hires() ? _screen->toDisplayRect(dirtyRect) : dirtyRect);
+		if (translatedClipRect.isEmpty())
+			return;
+		Common::Rect clipRect = translatedClipRect;
+		clipRect.translate(itemEntry->clipRect.left - itemEntry->translatedClipRect.left,
+				itemEntry->clipRect.top - itemEntry->translatedClipRect.top);
+
+		if ((itemEntry->scaleX == 128) && (itemEntry->scaleY == 128))
+			view->draw(itemEntry->celRect, clipRect, translatedClipRect, itemEntry->loopNo, itemEntry->celNo, 255, 0, view->isSci2Hires());
+		else
+			view->drawScaled(itemEntry->celRect, clipRect, translatedClipRect, itemEntry->loopNo, itemEntry->celNo, 255, itemEntry->scaleX, itemEntry->scaleY);
+	} else {
+		drawText(plane, itemEntry, true);
 	}
+}
 
-	_screen->copyToScreen();
+Common::String GfxFrameout::getScreenItemText(reg_t object) {
+	reg_t stringObject = readSelector(_segMan, object, SELECTOR(text));
 
-	g_sci->getEngineState()->_throttleTrigger = true;
+	// The object in the text selector of the item can be either a raw string
+	// or a Str object. In the latter case, we need to access the object's data
+	// selector to get the raw string.
+	if (_segMan->isHeapObject(stringObject))
+		stringObject = readSelector(_segMan, stringObject, SELECTOR(data));
+
+	return _segMan->getString(stringObject);
+}
+
+/**
+ * Lays out the text of a text screen item and draws it, if requested.
+ * @return the screen rect covered by the text
+ */
+Common::Rect GfxFrameout::drawText(const PlaneEntry &plane, FrameoutEntry *itemEntry, bool draw) {
+	// This draws text the "SCI0-SCI11" way. In SCI2, text is prerendered in kCreateTextBitmap
+	// TODO: rewrite this the "SCI2" way (i.e. implement the text buffer to draw inside kCreateTextBitmap)
+	Common::String text = getScreenItemText(itemEntry->object);
+	GfxFont *font = _cache->getFont(readSelectorValue(_segMan, itemEntry->object, SELECTOR(font)));
+	bool dimmed = readSelectorValue(_segMan, itemEntry->object, SELECTOR(dimmed));
+	uint16 foreColor = readSelectorValue(_segMan, itemEntry->object, SELECTOR(fore));
+
+	uint16 startX = itemEntry->x + plane.planeRect.left;
+	uint16 curY = itemEntry->y + plane.planeRect.top;
+	const char *txt = text.c_str();
+	// HACK. The plane sometimes doesn't contain the correct width. This
+	// hack breaks the dialog options when speaking with Grace, but it's
+	// the best we got up to now. This happens because of the unimplemented
+	// kTextWidth function in SCI32.
+	// TODO: Remove this once kTextWidth has been implemented.
+	uint16 w = plane.planeRect.width() >= 20 ? plane.planeRect.width() : _screen->getWidth() - 10;
+	int16 charCount;
+
+	// Upscale the coordinates/width if the fonts are already upscaled
+	if (_screen->fontIsUpscaled()) {
+		startX = startX * _screen->getDisplayWidth() / _screen->getWidth();
+		curY = curY * _screen->getDisplayHeight() / _screen->getHeight();
+		w  = w * _screen->getDisplayWidth() / _screen->getWidth();
+	}
+
+	Common::Rect textRect(startX, curY, startX, curY);
+
+	while (*txt) {
+		charCount = GetLongest(txt, w, font);
+		if (charCount == 0)
+			break;
+
+		uint16 curX = startX;
+
+		for (int i = 0; i < charCount; i++) {
+			unsigned char curChar = txt[i];
+			if (draw)
+				font->draw(curChar, curY, curX, foreColor, dimmed);
+			curX += font->getCharWidth(curChar);
+		}
+
+		textRect.extend(Common::Rect(startX, curY, curX, curY + font->getHeight()));
+		curY += font->getHeight();
+		txt += charCount;
+		while (*txt == ' ')
+			txt++; // skip over breaking spaces
+	}
+
+	if (_screen->fontIsUpscaled())
+		textRect = displayToScreenRect(_screen, textRect);
+	textRect.clip(_screen->getWidth(), _screen->getHeight());
+	return textRect;
 }
 
 } // End of namespace Sci
@@ -23,6 +23,8 @@
 #ifndef SCI_GRAPHICS_FRAMEOUT_H
 #define SCI_GRAPHICS_FRAMEOUT_H
 
+#include "common/hashmap.h"
+
 namespace Sci {
 
 class GfxPicture;
@@ -58,6 +60,12 @@ struct FrameoutEntry {
 	Common::Rect celRect;
 	GfxPicture *picture;
 	int16 picStartX;
+
+	// Set up by kernelFrameout() before the entry gets drawn
+	int16 pictureOffsetX;
+	Common::Rect clipRect;
+	Common::Rect translatedClipRect;
+	Common::Rect drawnRect; // screen coordinates, empty if not drawn
 };
 
 typedef Common::List<FrameoutEntry *> FrameoutList;
@@ -72,6 +80,18 @@ struct PlanePictureEntry {
 
 typedef Common::List<PlanePictureEntry> PlanePictureList;
 
+/**
+ * What a plane or screen item was drawn from in a frame, and where on the
+ * screen it was drawn.
+ */
+struct FrameoutItemState {
+	Common::Array<uint32> state;
+	Common::Rect rect;
+};
+
+typedef Common::HashMap<uint32, FrameoutItemState> FrameoutStateMap;
+
+class Console;
 class GfxCache;
 class GfxCoordAdjuster32;
 class GfxPaint32;
@@ -100,6 +120,8 @@ public:
 	void deletePlanePictures(reg_t object);
 	void clear();
 
+	void printFrameStats(Console *con);
+
 private:
 	SegManager *_segMan;
 	ResourceManager *_resMan;
@@ -115,6 +137,26 @@ private:
 
 	void sortPlanes();
 
+	void addScreenItemState(Common::Array<uint32> &state, reg_t planeObject, FrameoutEntry *itemEntry);
+	Common::Rect getDirtyRect(const FrameoutStateMap &frameState);
+	void layoutScreenItem(const PlaneEntry &plane, FrameoutEntry *itemEntry);
+	void drawScreenItem(const PlaneEntry &plane, FrameoutEntry *itemEntry, const Common::Rect &dirtyRect);
+	Common::String getScreenItemText(reg_t object);
+	Common::Rect drawText(const PlaneEntry &plane, FrameoutEntry *itemEntry, bool draw);
+
+	/**
+	 * The state of the planes and screen items in the last frame, by object.
+	 * Only the screen rects of the ones which changed since then are drawn
+	 * again.
+	 */
+	FrameoutStateMap _frameState;
+
+	// Statistics for the frame_stats console command
+	uint32 _lastFramePixels;
+	uint32 _statsFrames;
+	uint32 _statsFramesDrawn;
+	uint32 _statsPixels;
+
 	uint16 scriptsRunningWidth;
 	uint16 scriptsRunningHeight;
 };
@@ -176,7 +176,7 @@ int16 GfxPicture::getSci32celPriority(int16 celNo) {
 	return READ_SCI11ENDIAN_UINT16(inbuffer + cel_headerPos + 36);
 }
 
-void GfxPicture::drawSci32Vga(int16 celNo, int16 drawX, int16 drawY, int16 pictureX, bool mirrored) {
+void GfxPicture::drawSci32Vga(int16 celNo, int16 drawX, int16 drawY, int16 pictureX, bool mirrored, const Common::Rect &clipRect) {
 	byte *inbuffer = _resource->data;
 	int size = _resource->size;
 	int header_size = READ_SCI11ENDIAN_UINT16(inbuffer);
@@ -216,14 +216,14 @@ void GfxPicture::drawSci32Vga(int16 celNo, int16 drawX, int16 drawY, int16 pictu
 	cel_RlePos = READ_SCI11ENDIAN_UINT32(inbuffer + cel_headerPos + 24);
 	cel_LiteralPos = READ_SCI11ENDIAN_UINT32(inbuffer + cel_headerPos + 28);
 
-	drawCelData(inbuffer, size, cel_headerPos, cel_RlePos, cel_LiteralPos, drawX, drawY, pictureX);
+	drawCelData(inbuffer, size, cel_headerPos, cel_RlePos, cel_LiteralPos, drawX, drawY, pictureX, &clipRect);
 	cel_headerPos += 42;
 }
 #endif
 
 extern void unpackCelData(byte *inBuffer, byte *celBitmap, byte clearColor, int pixelCount, int rlePos, int literalPos, ViewType viewType, uint16 width, bool isMacSci11ViewData);
 
-void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos, int literalPos, int16 drawX, int16 drawY, int16 pictureX) {
+void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos, int literalPos, int16 drawX, int16 drawY, int16 pictureX, const Common::Rect *clipRect) {
 	byte *celBitmap = NULL;
 	byte *ptr = NULL;
 	byte *headerPtr = inbuffer + headerPos;
@@ -265,6 +265,37 @@ void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos
 	if (displaceX || displaceY)
 		error("unsupported embedded cel-data in picture");
 
+	Common::Rect displayArea = _coordAdjuster->pictureGetDisplayArea();
+
+	uint16 skipCelBitmapPixels = 0;
+	int16 displayWidth = width;
+	if (pictureX) {
+		// scroll position for picture active, we need to adjust drawX accordingly
+		drawX -= pictureX;
+		if (drawX < 0) {
+			skipCelBitmapPixels = -drawX;
+			displayWidth -= skipCelBitmapPixels;
+			drawX = 0;
+		}
+	}
+
+	y = displayArea.top + drawY;
+	lastY = MIN<int16>(height + y, displayArea.bottom);
+	leftX = displayArea.left + drawX;
+	rightX = MIN<int16>(displayWidth + leftX, displayArea.right);
+
+	// Pixels outside of the clip rect are left alone. A cel which is
+	// completely outside of it does not even get unpacked.
+	int16 clipLeft = leftX, clipRight = rightX, firstY = y;
+	if (clipRect) {
+		clipLeft = MAX<int16>(leftX, clipRect->left);
+		clipRight = MIN<int16>(rightX, clipRect->right);
+		firstY = MAX<int16>(y, clipRect->top);
+		lastY = MIN<int16>(lastY, clipRect->bottom);
+		if (displayWidth <= 0 || clipLeft >= clipRight || firstY >= lastY)
+			return;
+	}
+
 	// We will unpack cel-data into a temporary buffer and then plot it to screen
 	//  That needs to be done cause a mirrored picture may be requested
 	pixelCount = width * height;
@@ -298,26 +329,7 @@ void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos
 		}
 	}
 
-	Common::Rect displayArea = _coordAdjuster->pictureGetDisplayArea();
-
-	uint16 skipCelBitmapPixels = 0;
-	int16 displayWidth = width;
-	if (pictureX) {
-		// scroll position for picture active, we need to adjust drawX accordingly
-		drawX -= pictureX;
-		if (drawX < 0) {
-			skipCelBitmapPixels = -drawX;
-			displayWidth -= skipCelBitmapPixels;
-			drawX = 0;
-		}
-	}
-
 	if (displayWidth > 0) {
-		y = displayArea.top + drawY;
-		lastY = MIN<int16>(height + y, displayArea.bottom);
-		leftX = displayArea.left + drawX;
-		rightX = MIN<int16>(displayWidth + leftX, displayArea.right);
-
 		uint16 sourcePixelSkipPerRow = 0;
 		if (width > rightX - leftX)
 			sourcePixelSkipPerRow = width - (rightX - leftX);
@@ -334,12 +346,17 @@ void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos
 
 		ptr = celBitmap;
 		ptr += skipCelBitmapPixels;
+
+		// Skip the rows above the clip rect
+		ptr += (firstY - y) * (rightX - leftX + sourcePixelSkipPerRow);
+		y = firstY;
+
 		if (!_mirroredFlag) {
 			// Draw bitmap to screen
 			x = leftX;
 			while (y < lastY) {
 				curByte = *ptr++;
-				if ((curByte != clearColor) && (priority >= _screen->getPriority(x, y)))
+				if ((curByte != clearColor) && (x >= clipLeft) && (x < clipRight) && (priority >= _screen->getPriority(x, y)))
 					_screen->putPixel(x, y, drawMask, curByte, priority, 0);
 
 				x++;
@@ -355,7 +372,7 @@ void GfxPicture::drawCelData(byte *inbuffer, int size, int headerPos, int rlePos
 			x = rightX - 1;
 			while (y < lastY) {
 				curByte = *ptr++;
-				if ((curByte != clearColor) && (priority >= _screen->getPriority(x, y)))
+				if ((curByte != clearColor) && (x >= clipLeft) && (x < clipRight) && (priority >= _screen->getPriority(x, y)))
 					_screen->putPixel(x, y, drawMask, curByte, priority, 0);
 
 				if (x == leftX) {
@@ -57,14 +57,18 @@ public:
 	int16 getSci32celX(int16 celNo);
 	int16 getSci32celWidth(int16 celNo);
 	int16 getSci32celPriority(int16 celNo);
-	void drawSci32Vga(int16 celNo, int16 callerX, int16 callerY, int16 pictureX, bool mirrored);
+	/**
+	 * Draws a cel of a SCI32 picture. Only the part inside clipRect, in
+	 * screen coordinates, is drawn.
+	 */
+	void drawSci32Vga(int16 celNo, int16 callerX, int16 callerY, int16 pictureX, bool mirrored, const Common::Rect &clipRect);
 #endif
 
 private:
 	void initData(GuiResourceId resourceId);
 	void reset();
 	void drawSci11Vga();
-	void drawCelData(byte *inbuffer, int size, int headerPos, int rlePos, int literalPos, int16 drawX, int16 drawY, int16 pictureX);
+	void drawCelData(byte *inbuffer, int size, int headerPos, int rlePos, int literalPos, int16 drawX, int16 drawY, int16 pictureX, const Common::Rect *clipRect = 0);
 	void drawVectorData(byte *data, int size);
 	bool vectorIsNonOpcode(byte pixel);
 	void vectorGetAbsCoords(byte *data, int &curPos, int16 &x, int16 &y);
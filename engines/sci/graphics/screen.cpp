@@ -106,6 +106,8 @@ GfxScreen::GfxScreen(ResourceManager *resMan) : _resMan(resMan) {
 	// Sets display screen to be actually displayed
 	_activeScreen = _displayScreen;
 
+	_frameCopyValid = false;
+
 	_picNotValid = 0;
 	_picNotValidSci11 = 0;
 	_unditheringEnabled = true;
@@ -150,9 +152,28 @@ GfxScreen::~GfxScreen() {
 }
 
 void GfxScreen::copyToScreen() {
+	_frameCopyValid = false;
 	g_system->copyRectToScreen(_activeScreen, _displayWidth, 0, 0, _displayWidth, _displayHeight);
 }
 
+uint32 GfxScreen::copyFrameRectToScreen(const Common::Rect &rect) {
+	Common::Rect displayRect = toDisplayRect(rect);
+	displayRect.clip(_displayWidth, _displayHeight);
+	_frameCopyValid = true;
+	if (displayRect.isEmpty())
+		return 0;
+
+	g_system->copyRectToScreen(_activeScreen + displayRect.top * _displayWidth + displayRect.left, _displayWidth,
+			displayRect.left, displayRect.top, displayRect.width(), displayRect.height());
+	return displayRect.width() * displayRect.height();
+}
+
+Common::Rect GfxScreen::toDisplayRect(const Common::Rect &rect) const {
+	if (!_upscaledHires)
+		return rect;
+	return Common::Rect(rect.left * 2, _upscaledMapping[rect.top], rect.right * 2, _upscaledMapping[rect.bottom]);
+}
+
 void GfxScreen::copyFromScreen(byte *buffer) {
 	// TODO this ignores the pitch
 	Graphics::Surface *screen = g_system->lockScreen();
@@ -168,6 +189,7 @@ void GfxScreen::kernelSyncWithFramebuffer() {
 }
 
 void GfxScreen::copyRectToScreen(const Common::Rect &rect) {
+	_frameCopyValid = false;
 	if (!_upscaledHires)  {
 		g_system->copyRectToScreen(_activeScreen + rect.top * _displayWidth + rect.left, _displayWidth, rect.left, rect.top, rect.width(), rect.height());
 	} else {
@@ -183,10 +205,12 @@ void GfxScreen::copyRectToScreen(const Common::Rect &rect) {
 void GfxScreen::copyDisplayRectToScreen(const Common::Rect &rect) {
 	if (!_upscaledHires)
 		error("copyDisplayRectToScreen: not in upscaled hires mode");
+	_frameCopyValid = false;
 	g_system->copyRectToScreen(_activeScreen + rect.top * _displayWidth + rect.left, _displayWidth, rect.left, rect.top, rect.width(), rect.height());
 }
 
 void GfxScreen::copyRectToScreen(const Common::Rect &rect, int16 x, int16 y) {
+	_frameCopyValid = false;
 	if (!_upscaledHires)  {
 		g_system->copyRectToScreen(_activeScreen + rect.top * _displayWidth + rect.left, _displayWidth, x, y, rect.width(), rect.height());
 	} else {
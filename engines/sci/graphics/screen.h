@@ -79,6 +79,29 @@ public:
 	void copyDisplayRectToScreen(const Common::Rect &rect);
 	void copyRectToScreen(const Common::Rect &rect, int16 x, int16 y);
 
+	/**
+	 * Copies the part of a frame which was redrawn to the backend. This is
+	 * used by SCI32, which only redraws the parts of the screen that changed
+	 * since the last frame.
+	 * @param rect	the redrawn rect in screen coordinates
+	 * @return the number of display pixels which were copied
+	 */
+	uint32 copyFrameRectToScreen(const Common::Rect &rect);
+	/**
+	 * Returns whether the backend still shows the last frame, which was
+	 * copied by copyFrameRectToScreen(). If not, the next frame has to be
+	 * redrawn and copied completely.
+	 */
+	bool isFrameCopyValid() const { return _frameCopyValid; }
+	/**
+	 * Marks the last frame as overwritten. Needed after drawing to the
+	 * backend directly, e.g. for videos.
+	 */
+	void invalidateScreenCopy() { _frameCopyValid = false; }
+
+	/** Converts a rect in screen coordinates to display coordinates. */
+	Common::Rect toDisplayRect(const Common::Rect &rect) const;
+
 	byte getDrawingMask(byte color, byte prio, byte control);
 	void putPixel(int x, int y, byte drawMask, byte color, byte prio, byte control);
 	void putFontPixel(int startingY, int x, int y, byte color);
@@ -176,6 +199,12 @@ private:
 	 */
 	byte *_activeScreen;
 
+	/**
+	 * Set by copyFrameRectToScreen(), cleared by anything else that copies
+	 * to the backend.
+	 */
+	bool _frameCopyValid;
+
 	/**
 	 * This variable defines, if upscaled hires is active and what upscaled mode
 	 * is used.
@@ -23,6 +23,7 @@
 #include "sci/sci.h"
 #include "sci/util.h"
 #include "sci/engine/state.h"
+#include "sci/graphics/cache.h"
 #include "sci/graphics/screen.h"
 #include "sci/graphics/palette.h"
 #include "sci/graphics/coordadjuster.h"
@@ -31,7 +32,7 @@
 namespace Sci {
 
 GfxView::GfxView(ResourceManager *resMan, GfxScreen *screen, GfxPalette *palette, GuiResourceId resourceId)
-	: _resMan(resMan), _screen(screen), _palette(palette), _resourceId(resourceId) {
+	: _resMan(resMan), _screen(screen), _palette(palette), _resourceId(resourceId), _unpackedSize(0), _cache(0) {
 	assert(resourceId != -1);
 	_coordAdjuster = g_sci->_gfxCoordAdjuster;
 	initData(resourceId);
@@ -574,6 +575,7 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 	// allocating memory to store cel's bitmap
 	int pixelCount = width * height;
 	_loop[loopNo].cel[celNo].rawBitmap = new byte[pixelCount];
+	_unpackedSize += pixelCount;
 	byte *pBitmap = _loop[loopNo].cel[celNo].rawBitmap;
 
 	// unpack the actual cel bitmap data
@@ -588,6 +590,11 @@ const byte *GfxView::getBitmap(int16 loopNo, int16 celNo) {
 			for (int j = 0; j < width / 2; j++)
 				SWAP(pBitmap[j], pBitmap[width - j - 1]);
 	}
+
+	// This might free other views, but not this one
+	if (_cache)
+		_cache->addViewMemory(this, pixelCount);
+
 	return _loop[loopNo].cel[celNo].rawBitmap;
 }
 
@@ -53,6 +53,7 @@ struct LoopInfo {
 #define SCI_VIEW_EGAMAPPING_SIZE 16
 #define SCI_VIEW_EGAMAPPING_COUNT 8
 
+class GfxCache;
 class GfxScreen;
 class GfxPalette;
 
@@ -79,6 +80,15 @@ public:
 	uint16 getCelCount(int16 loopNo) const;
 	Palette *getPalette();
 
+	/** Returns the memory used by the view resource and the cels unpacked so far. */
+	uint32 getMemorySize() const { return _resourceSize + _unpackedSize; }
+
+	/**
+	 * Makes the view report the size of every cel unpacked from now on to
+	 * the given cache, which holds it.
+	 */
+	void setCache(GfxCache *cache) { _cache = cache; }
+
 	bool isScaleable();
 	bool isSci2Hires();
 
@@ -102,6 +112,8 @@ private:
 
 	uint16 _loopCount;
 	LoopInfo *_loop;
+	uint32 _unpackedSize;	///< Bytes allocated for unpacked cels
+	GfxCache *_cache;	///< Cache told about increases of _unpackedSize, if set
 	bool _embeddedPal;
 	Palette _viewPalette;
 
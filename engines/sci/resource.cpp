@@ -22,6 +22,7 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
@@ -190,6 +191,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
+	_lruPrev = NULL;
+	_lruNext = NULL;
 }
 
 Resource::~Resource() {
@@ -890,7 +893,16 @@ ResourceManager::ResourceManager() {
 void ResourceManager::init(bool initFromFallbackDetector) {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_lruFirst = NULL;
+	_lruLast = NULL;
+	_lruEntries = 0;
+	_cacheHits = 0;
+	_cacheMisses = 0;
+	_cacheEvictions = 0;
+
+	_maxMemoryLRU = MAX_MEMORY;
+	if (ConfMan.hasKey("sci_resource_cache_kb"))
+		_maxMemoryLRU = CLIP<int>(ConfMan.getInt("sci_resource_cache_kb"), MIN_MEMORY / 1024, MAX_MEMORY_LIMIT / 1024) * 1024;
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 
@@ -993,7 +1005,19 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		_lruFirst = res->_lruNext;
+
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		_lruLast = res->_lruPrev;
+
+	res->_lruPrev = res->_lruNext = NULL;
+	_lruEntries--;
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1003,7 +1027,16 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+
+	res->_lruPrev = NULL;
+	res->_lruNext = _lruFirst;
+	if (_lruFirst)
+		_lruFirst->_lruPrev = res;
+	else
+		_lruLast = res;
+	_lruFirst = res;
+
+	_lruEntries++;
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s.%03d (%d bytes) to lru control: %d bytes total",
@@ -1016,32 +1049,39 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
 
-	while (it != _LRU.end()) {
-		res = *it;
+	for (Resource *res = _lruFirst; res; res = res->_lruNext) {
 		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
 		mem += res->size;
 		++entries;
-		++it;
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
 void ResourceManager::freeOldResources() {
-	while (MAX_MEMORY < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+	while (_maxMemoryLRU < _memoryLRU) {
+		assert(_lruLast);
+		Resource *goner = _lruLast;
 		removeFromLRU(goner);
 		goner->unalloc();
+		_cacheEvictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s.%03d (%d bytes)", getResourceTypeName(goner->type), goner->number, goner->size);
 #endif
 	}
 }
 
+void ResourceManager::getCacheStats(ResourceCacheStats &stats) const {
+	stats.maxMemory = _maxMemoryLRU;
+	stats.memoryLRU = _memoryLRU;
+	stats.memoryLocked = _memoryLocked;
+	stats.entriesLRU = _lruEntries;
+	stats.hits = _cacheHits;
+	stats.misses = _cacheMisses;
+	stats.evictions = _cacheEvictions;
+}
+
 Common::List<ResourceId> *ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> *resources = new Common::List<ResourceId>;
 
@@ -1061,10 +1101,14 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheMisses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
-		removeFromLRU(retval);
+	} else {
+		_cacheHits++;
+		if (retval->_status == kResStatusEnqueued)
+			removeFromLRU(retval);
+	}
 	// Unless an error occurred, the resource is now either
 	// locked or allocated, but never queued or freed.
 
@@ -243,6 +243,10 @@ protected:
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
+	// Links of the LRU list, while the resource is enqueued
+	Resource *_lruPrev;
+	Resource *_lruNext;
+
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
 	bool loadFromWaveFile(Common::SeekableReadStream *file);
@@ -254,6 +258,17 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+/** Statistics of the resource cache, as shown by the debugger */
+struct ResourceCacheStats {
+	int maxMemory;		///< Budget for resources under LRU control, in bytes
+	int memoryLRU;		///< Amount of resource bytes under LRU control
+	int memoryLocked;	///< Amount of resource bytes in locked memory
+	uint entriesLRU;	///< Number of resources under LRU control
+	uint32 hits;		///< Lookups of resources which were in memory already
+	uint32 misses;		///< Lookups which had to load the resource
+	uint32 evictions;	///< Resources freed to stay within the budget
+};
+
 class ResourceManager {
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
 	// ease transition to the ResourceSource class system.
@@ -324,6 +339,12 @@ public:
 	 */
 	Common::List<ResourceId> *listResources(ResourceType type, int mapNumber = -1);
 
+	/**
+	 * Returns the current state of the resource cache.
+	 * @param stats	Receives the statistics
+	 */
+	void getCacheStats(ResourceCacheStats &stats) const;
+
 	void setAudioLanguage(int language);
 	int getAudioLanguage() const;
 	void changeAudioDirectory(Common::String path);
@@ -379,19 +400,30 @@ public:
 	ResourceType convertResType(byte type);
 
 protected:
-	// Maximum number of bytes to allow being allocated for resources
+	// Default maximum number of bytes to allow being allocated for resources,
+	// unless overridden by the sci_resource_cache_kb config key. The key can
+	// lower the budget down to MIN_MEMORY for devices with little memory, or
+	// raise it up to MAX_MEMORY_LIMIT.
 	// Note: maxMemory will not be interpreted as a hard limit, only as a restriction
 	// for resources which are not explicitly locked. However, a warning will be
 	// issued whenever this limit is exceeded.
 	enum {
-		MAX_MEMORY = 256 * 1024	// 256KB
+		MIN_MEMORY = 32 * 1024,	// 32KB
+		MAX_MEMORY = 256 * 1024,	// 256KB
+		MAX_MEMORY_LIMIT = 1024 * 1024 * 1024	// 1GB
 	};
 
 	ViewType _viewType; // Used to determine if the game has EGA or VGA graphics
 	Common::List<ResourceSource *> _sources;
+	int _maxMemoryLRU;	///< Maximum amount of resource bytes under LRU control
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Resource *_lruFirst;	///< Most recently used resource of the LRU list
+	Resource *_lruLast;	///< Least recently used resource of the LRU list
+	uint _lruEntries;	///< Number of resources in the LRU list
+	uint32 _cacheHits;
+	uint32 _cacheMisses;
+	uint32 _cacheEvictions;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
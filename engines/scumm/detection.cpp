@@ -858,6 +858,7 @@ public:
 	virtual int getMaximumSaveSlot() const;
 	virtual void removeSaveState(const char *target, int slot) const;
 	virtual SaveStateDescriptor querySaveMetaInfos(const char *target, int slot) const;
+	virtual Common::String getSavegameFile(const char *target, int slot) const;
 };
 
 bool ScummMetaEngine::hasFeature(MetaEngineFeature f) const {
@@ -1244,6 +1245,10 @@ SaveStateDescriptor ScummMetaEngine::querySaveMetaInfos(const char *target, int
 	return desc;
 }
 
+Common::String ScummMetaEngine::getSavegameFile(const char *target, int slot) const {
+	return ScummEngine::makeSavegameName(target, slot, false);
+}
+
 #if PLUGIN_ENABLED_DYNAMIC(SCUMM)
 	REGISTER_PLUGIN_DYNAMIC(SCUMM, PLUGIN_TYPE_ENGINE, ScummMetaEngine);
 #else
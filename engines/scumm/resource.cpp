@@ -829,6 +829,7 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 
 	memset(ptr, 0, size + SAFETY_AREA);
 	_allocatedSize += size;
+	_roomPeakSize = MAX(_roomPeakSize, _allocatedSize);
 
 	_types[type][idx]._address = ptr;
 	_types[type][idx]._size = size;
@@ -871,6 +872,11 @@ ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm) {
 	_maxHeapThreshold = 0;
 	_minHeapThreshold = 0;
 	_expireCounter = 0;
+	_roomPeakSize = 0;
+	_roomExpiredNum = 0;
+	_roomExpiredSize = 0;
+	_totalExpiredNum = 0;
+	_totalExpiredSize = 0;
 }
 
 ResourceManager::~ResourceManager() {
@@ -1008,9 +1014,6 @@ bool ResourceManager::Resource::isModified() const {
 }
 
 void ResourceManager::expireResources(uint32 size) {
-	byte best_counter;
-	ResType best_type;
-	int best_res = 0;
 	uint32 oldAllocatedSize;
 
 	if (_expireCounter != 0xFF) {
@@ -1023,30 +1026,51 @@ void ResourceManager::expireResources(uint32 size) {
 
 	oldAllocatedSize = _allocatedSize;
 
-	do {
-		best_type = rtInvalid;
-		best_counter = 2;
-
-		for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-			if (_types[type]._mode != kDynamicResTypeMode) {
-				// Resources of this type can be reloaded from the data files,
-				// so we can potentially unload them to free memory.
-				ResId idx = _types[type].size();
-				while (idx-- > 0) {
-					Resource &tmp = _types[type][idx];
-					byte counter = tmp.getResourceCounter();
-					if (!tmp.isLocked() && counter >= best_counter && tmp._address && !_vm->isResourceInUse(type, idx)) {
-						best_counter = counter;
-						best_type = type;
-						best_res = idx;
-					}
+	// Collect all resources which may be thrown out, with one list per
+	// counter value. Resources with the highest counter go first; among
+	// those, the highest type and then the lowest index.
+	int head[RF_USAGE_MAX + 1];
+	for (int i = 0; i <= RF_USAGE_MAX; i++)
+		head[i] = -1;
+
+	_expireQueue.resize(0);
+
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		if (_types[type]._mode != kDynamicResTypeMode) {
+			// Resources of this type can be reloaded from the data files,
+			// so we can potentially unload them to free memory.
+			ResId idx = _types[type].size();
+			while (idx-- > 0) {
+				Resource &tmp = _types[type][idx];
+				byte counter = tmp.getResourceCounter();
+				if (!tmp.isLocked() && counter >= 2 && tmp._address && !_vm->isResourceInUse(type, idx)) {
+					ExpireEntry entry;
+					entry.type = type;
+					entry.idx = idx;
+					entry.next = head[counter];
+					head[counter] = _expireQueue.size();
+					_expireQueue.push_back(entry);
 				}
 			}
 		}
+	}
+
+	int counter = RF_USAGE_MAX;
+	int next = -1;
 
-		if (!best_type)
+	do {
+		while (next < 0 && counter >= 2)
+			next = head[counter--];
+
+		if (next < 0)
 			break;
-		nukeResource(best_type, best_res);
+
+		const ExpireEntry &entry = _expireQueue[next];
+		next = entry.next;
+
+		_roomExpiredNum++;
+		_roomExpiredSize += _types[entry.type][entry.idx]._size;
+		nukeResource(entry.type, entry.idx);
 	} while (size + _allocatedSize > _minHeapThreshold);
 
 	increaseResourceCounters();
@@ -1109,6 +1133,20 @@ void ResourceManager::resourceStats() {
 	}
 
 	debug(1, "Total allocated size=%d, locked=%d(%d)", _allocatedSize, lockedSize, lockedNum);
+	debug(1, "Heap thresholds=%d/%d, expired=%d(%d), expired in this room=%d(%d)",
+		_minHeapThreshold, _maxHeapThreshold, _totalExpiredSize + _roomExpiredSize, _totalExpiredNum + _roomExpiredNum,
+		_roomExpiredSize, _roomExpiredNum);
+}
+
+void ResourceManager::reportRoomStats(int room) {
+	debugC(DEBUG_RESOURCE, "Room %d: allocated size=%d (peak %d), heap thresholds=%d/%d, expired=%d(%d)",
+		room, _allocatedSize, _roomPeakSize, _minHeapThreshold, _maxHeapThreshold, _roomExpiredSize, _roomExpiredNum);
+
+	_totalExpiredNum += _roomExpiredNum;
+	_totalExpiredSize += _roomExpiredSize;
+	_roomExpiredNum = 0;
+	_roomExpiredSize = 0;
+	_roomPeakSize = _allocatedSize;
 }
 
 void ScummEngine_v5::readMAXS(int blockSize) {
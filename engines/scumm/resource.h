@@ -171,6 +171,26 @@ protected:
 	uint32 _maxHeapThreshold, _minHeapThreshold;
 	byte _expireCounter;
 
+	/**
+	 * A resource which expireResources() may throw out. The entries are
+	 * chained into one list per resource counter value.
+	 */
+	struct ExpireEntry {
+		ResType type;
+		ResId idx;
+		int next;	///< Index of the next entry with the same counter, or -1
+	};
+
+	/** Storage for the expiry lists, kept around to avoid reallocations */
+	Common::Array<ExpireEntry> _expireQueue;
+
+	// Heap statistics, used for tuning the heap thresholds
+	uint32 _roomPeakSize;		///< Peak allocated size in the current room
+	uint32 _roomExpiredNum;		///< Resources expired in the current room
+	uint32 _roomExpiredSize;	///< Bytes expired in the current room
+	uint32 _totalExpiredNum;	///< Resources expired since the game started
+	uint32 _totalExpiredSize;	///< Bytes expired since the game started
+
 public:
 	ResourceManager(ScummEngine *vm);
 	~ResourceManager();
@@ -217,6 +237,14 @@ public:
 
 	void resourceStats();
 
+	/**
+	 * Reports the heap usage and the number of expired resources since the
+	 * last room change on the resource debug channel, then starts counting
+	 * anew. Called whenever a new room is entered.
+	 * @param room	the room which is being left
+	 */
+	void reportRoomStats(int room);
+
 //protected:
 	bool validateResource(const char *str, ResType type, ResId idx) const;
 protected:
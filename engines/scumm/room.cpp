@@ -115,6 +115,7 @@ void ScummEngine::startScene(int room, Actor *a, int objectNr) {
 	VAR(VAR_ROOM) = room;
 	_fullRedraw = true;
 
+	_res->reportRoomStats(_currentRoom);
 	_res->increaseResourceCounters();
 
 	_currentRoom = room;
@@ -210,6 +210,8 @@ void Animation::frameNotification(int timeElapsed) {
 	assert(animationDescriptionPtr);
 	assert(timeElapsed >= 0);
 
+	bool frameChanged = false;
+
 	// Nur wenn die Animation luft wird sie auch weiterbewegt
 	if (_running) {
 		// Gesamte vergangene Zeit bestimmen (inkl. Restzeit des aktuellen Frames)
@@ -274,6 +276,7 @@ void Animation::frameNotification(int timeElapsed) {
 
 		if ((int)_currentFrame != tmpCurFrame) {
 			forceRefresh();
+			frameChanged = true;
 
 			if (animationDescriptionPtr->getFrame(_currentFrame).action != "") {
 				// action callback
@@ -288,6 +291,9 @@ void Animation::frameNotification(int timeElapsed) {
 	// Gre und Position der Animation anhand des aktuellen Frames bestimmen
 	computeCurrentCharacteristics();
 
+	if (frameChanged)
+		prefetchNextFrame();
+
 	assert(_currentFrame < animationDescriptionPtr->getFrameCount());
 	assert(_currentFrameTime >= 0);
 }
@@ -315,6 +321,45 @@ void Animation::computeCurrentCharacteristics() {
 	pBitmap->release();
 }
 
+void Animation::prefetchNextFrame() {
+	AnimationDescription *animationDescriptionPtr = getAnimationDescription();
+	assert(animationDescriptionPtr);
+	const int frameCount = animationDescriptionPtr->getFrameCount();
+
+	// Advance by one frame, like frameNotification() does
+	int nextFrame = (_direction == FORWARD) ? (int)_currentFrame + 1 : (int)_currentFrame - 1;
+	if (nextFrame < 0) {
+		nextFrame = -nextFrame;
+	} else if (nextFrame >= frameCount) {
+		switch (animationDescriptionPtr->getAnimationType()) {
+		case AT_LOOP:
+			nextFrame = nextFrame % frameCount;
+			break;
+		case AT_JOJO:
+			nextFrame = frameCount - (nextFrame % frameCount) - 1;
+			break;
+		default:
+			return;
+		}
+	}
+
+	if (nextFrame == (int)_currentFrame || nextFrame >= frameCount)
+		return;
+
+	Resource *pResource = Kernel::getInstance()->getResourceManager()->requestResource(animationDescriptionPtr->getFrame(nextFrame).fileName);
+	assert(pResource);
+	assert(pResource->getType() == Resource::TYPE_BITMAP);
+	BitmapResource *pBitmap = static_cast<BitmapResource *>(pResource);
+
+	// The size doRender() will draw the frame at
+	if (isScalingAllowed())
+		pBitmap->prefetch(static_cast<int>(pBitmap->getWidth() * _scaleFactorX), static_cast<int>(pBitmap->getHeight() * _scaleFactorY));
+	else
+		pBitmap->prefetch(pBitmap->getWidth(), pBitmap->getHeight());
+
+	pBitmap->release();
+}
+
 bool Animation::lockAllFrames() {
 	if (!_framesLocked) {
 		AnimationDescription *animationDescriptionPtr = getAnimationDescription();
@@ -196,6 +196,13 @@ private:
 	*/
 	void computeCurrentCharacteristics();
 
+	/**
+	    @brief Announces the frame which follows the current one to its bitmap, at the size it will be drawn at.
+
+	    Vector images use this to rasterize the next frame in advance.
+	*/
+	void prefetchNextFrame();
+
 	/**
 	    @brief Berechnet den Abstand zwischen dem linken Rand und dem Hotspot auf X-Achse in der aktuellen Darstellung.
 	*/
@@ -128,6 +128,15 @@ public:
 		return _pImage->blit(posX, posY, flipping, pSrcPartRect, color, width, height);
 	}
 
+	/**
+	    @brief Announces that the bitmap is about to be rendered at the given size.
+	    @see Image::prefetch()
+	*/
+	void prefetch(int width, int height) {
+		assert(_pImage);
+		_pImage->prefetch(width, height);
+	}
+
 	/**
 	    @brief Fllt einen Rechteckigen Bereich des Bildes mit einer Farbe.
 	    @param pFillRect Pointer auf ein Common::Rect, welches den Ausschnitt des Bildes spezifiziert, der gefllt
@@ -29,6 +29,7 @@
  *
  */
 
+#include "common/config-manager.h"
 #include "common/system.h"
 
 #include "sword25/sword25.h"	// for kDebugScript
@@ -41,6 +42,7 @@
 #include "sword25/gfx/image/renderedimage.h"
 #include "sword25/gfx/image/swimage.h"
 #include "sword25/gfx/image/vectorimage.h"
+#include "sword25/gfx/image/vectorimagecache.h"
 #include "sword25/package/packagemanager.h"
 #include "sword25/kernel/inputpersistenceblock.h"
 #include "sword25/kernel/outputpersistenceblock.h"
@@ -74,6 +76,8 @@ GraphicEngine::GraphicEngine(Kernel *pKernel) :
 	ResourceService(pKernel) {
 	_frameTimeSamples.resize(FRAMETIME_SAMPLE_COUNT);
 
+	_vectorImageCachePtr.reset(new VectorImageCache(!ConfMan.hasKey("vector_prefetch") || ConfMan.getBool("vector_prefetch")));
+
 	if (!registerScriptBindings())
 		error("Script bindings could not be registered.");
 	else
@@ -107,6 +111,7 @@ bool GraphicEngine::init(int width, int height, int bitDepth, int backbufferCoun
 	_screenRect.top = 0;
 	_screenRect.right = _width;
 	_screenRect.bottom = _height;
+	_clipRect = _screenRect;
 
 	const Graphics::PixelFormat format = g_system->getScreenFormat();
 
@@ -140,8 +145,11 @@ bool GraphicEngine::startFrame(bool updateAll) {
 
 bool GraphicEngine::endFrame() {
 #ifndef THEORA_INDIRECT_RENDERING
-	if (Kernel::getInstance()->getFMV()->isMovieLoaded())
+	if (Kernel::getInstance()->getFMV()->isMovieLoaded()) {
+		// The movie is drawn directly to the screen
+		_renderObjectManagerPtr->invalidateScreen();
 		return true;
+	}
 #endif
 
 	_renderObjectManagerPtr->render();
@@ -181,6 +189,8 @@ bool GraphicEngine::fill(const Common::Rect *fillRectPtr, uint color) {
 		rect = *fillRectPtr;
 	}
 
+	rect.clip(_clipRect);
+
 	if (rect.width() > 0 && rect.height() > 0) {
 		if (ca == 0xff) {
 			_backSurface.fillRect(rect, color);
@@ -215,8 +225,6 @@ bool GraphicEngine::fill(const Common::Rect *fillRectPtr, uint color) {
 				outo += _backSurface.pitch;
 			}
 		}
-
-		g_system->copyRectToScreen((byte *)_backSurface.getBasePtr(rect.left, rect.top), _backSurface.pitch, rect.left, rect.top, rect.width(), rect.height());
 	}
 
 	return true;
@@ -59,6 +59,7 @@ class Image;
 class Panel;
 class Screenshot;
 class RenderObjectManager;
+class VectorImageCache;
 
 typedef uint BS_COLOR;
 
@@ -232,9 +233,22 @@ public:
 	Graphics::Surface _backSurface;
 	Graphics::Surface *getSurface() { return &_backSurface; }
 
+	/**
+	 * Restricts drawing to the back surface to the given rectangle. The render
+	 * object manager uses this to draw only the regions which changed.
+	 * @param rect          The rectangle, which has to be inside the screen
+	 */
+	void setClipRect(const Common::Rect &rect) { _clipRect = rect; }
+	const Common::Rect &getClipRect() const { return _clipRect; }
+
 	Common::SeekableReadStream *_thumbnail;
 	Common::SeekableReadStream *getThumbnail() { return _thumbnail; }
 
+	/**
+	 * Returns the cache of rasterized vector images.
+	 */
+	VectorImageCache *getVectorImageCache() { return _vectorImageCachePtr.get(); }
+
 	// Access methods
 
 	/**
@@ -290,6 +304,7 @@ protected:
 	int _width;
 	int _height;
 	Common::Rect _screenRect;
+	Common::Rect _clipRect;
 	int _bitDepth;
 
 	/**
@@ -316,6 +331,8 @@ private:
 
 	Common::ScopedPtr<RenderObjectManager> _renderObjectManagerPtr;
 
+	Common::ScopedPtr<VectorImageCache> _vectorImageCachePtr;
+
 	struct DebugLine {
 		DebugLine(const Vertex &start, const Vertex &end, uint color) :
 			_start(start),
@@ -131,6 +131,14 @@ public:
 	                  uint color = BS_ARGB(255, 255, 255, 255),
 	                  int width = -1, int height = -1) = 0;
 
+	/**
+	    @brief Announces that the image is about to be rendered at the given size.
+	    Images which have to be prepared for each size can do so in advance, so that the following Blit() call is faster.
+	    @param Width the output width, as it will be passed to Blit().
+	    @param Height the output height, as it will be passed to Blit().
+	*/
+	virtual void prefetch(int width, int height) {}
+
 	/**
 	    @brief fills a rectangular section of the image with a color.
 	    @param pFillRect Pointer on Common::Rect which specifies the section of the image which is supposed to be filled. If the whole image has to be filled this value is NULL.<br>
@@ -99,7 +99,8 @@ static byte *readSavegameThumbnail(const Common::String &filename, uint &fileSiz
 RenderedImage::RenderedImage(const Common::String &filename, bool &result) :
 	_data(0),
 	_width(0),
-	_height(0) {
+	_height(0),
+	_alphaTypeValid(false) {
 	result = false;
 
 	PackageManager *pPackage = Kernel::getInstance()->getPackage();
@@ -149,7 +150,8 @@ RenderedImage::RenderedImage(const Common::String &filename, bool &result) :
 
 RenderedImage::RenderedImage(uint width, uint height, bool &result) :
 	_width(width),
-	_height(height) {
+	_height(height),
+	_alphaTypeValid(false) {
 
 	_data = new byte[width * height * 4];
 	Common::set_to(_data, &_data[width * height * 4], 0);
@@ -162,7 +164,7 @@ RenderedImage::RenderedImage(uint width, uint height, bool &result) :
 	return;
 }
 
-RenderedImage::RenderedImage() : _width(0), _height(0), _data(0) {
+RenderedImage::RenderedImage() : _width(0), _height(0), _data(0), _alphaTypeValid(false) {
 	_backSurface = Kernel::getInstance()->getGfx()->getSurface();
 
 	_doCleanup = false;
@@ -173,6 +175,8 @@ RenderedImage::RenderedImage() : _width(0), _height(0), _data(0) {
 // -----------------------------------------------------------------------------
 
 RenderedImage::~RenderedImage() {
+	clearScaledImages();
+
 	if (_doCleanup)
 		delete[] _data;
 }
@@ -202,6 +206,9 @@ bool RenderedImage::setContent(const byte *pixeldata, uint size, uint offset, ui
 		in += stride;
 	}
 
+	_alphaTypeValid = false;
+	clearScaledImages();
+
 	return true;
 }
 
@@ -209,6 +216,12 @@ void RenderedImage::replaceContent(byte *pixeldata, int width, int height) {
 	_width = width;
 	_height = height;
 	_data = pixeldata;
+
+	// The content is only used for a single blit, which makes determining
+	// the alpha type not worth it. It is antialiased vector graphics anyway.
+	_alphaType = Graphics::kAlphaFull;
+	_alphaTypeValid = true;
+	clearScaledImages();
 }
 // -----------------------------------------------------------------------------
 
@@ -220,24 +233,10 @@ uint RenderedImage::getPixel(int x, int y) {
 // -----------------------------------------------------------------------------
 
 bool RenderedImage::blit(int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height) {
-	int ca = (color >> 24) & 0xff;
-
 	// Check if we need to draw anything at all
-	if (ca == 0)
+	if (((color >> 24) & 0xff) == 0)
 		return true;
 
-	int cr = (color >> 16) & 0xff;
-	int cg = (color >> 8) & 0xff;
-	int cb = (color >> 0) & 0xff;
-
-	// Compensate for transparency. Since we're coming
-	// down to 255 alpha, we just compensate for the colors here
-	if (ca != 255) {
-		cr = cr * ca >> 8;
-		cg = cg * ca >> 8;
-		cb = cb * ca >> 8;
-	}
-
 	// Create an encapsulating surface for the data
 	Graphics::Surface srcImage;
 	// TODO: Is the data really in the screen format?
@@ -273,174 +272,89 @@ bool RenderedImage::blit(int posX, int posY, int flipping, Common::Rect *pPartRe
 
 	Graphics::Surface *img;
 	Graphics::Surface *imgScaled = NULL;
-	byte *savedPixels = NULL;
 	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = scale(srcImage, width, height);
-		savedPixels = (byte *)img->pixels;
+		// Scale the image. Scaled versions of the whole image are kept,
+		// parts of it are scaled for each blit.
+		if (pPartRect)
+			img = imgScaled = scale(srcImage, width, height);
+		else
+			img = getScaledImage(srcImage, width, height);
 	} else {
 		img = &srcImage;
 	}
 
-	// Handle off-screen clipping
-	if (posY < 0) {
-		img->h = MAX(0, (int)img->h - -posY);
-		img->pixels = (byte *)img->pixels + img->pitch * -posY;
-		posY = 0;
+	// Clip against the screen and the region being drawn. The clipped rows
+	// and columns of a flipped image are at the other end of the source.
+	Common::Rect destRect(posX, posY, posX + img->w, posY + img->h);
+	destRect.clip(Kernel::getInstance()->getGfx()->getClipRect());
+
+	if (!destRect.isEmpty()) {
+		int skipX = (flipping & Image::FLIP_V) ? posX + img->w - destRect.right : destRect.left - posX;
+		int skipY = (flipping & Image::FLIP_H) ? posY + img->h - destRect.bottom : destRect.top - posY;
+
+		int mirror = 0;
+		if (flipping & Image::FLIP_V)
+			mirror |= Graphics::kBlitMirrorX;
+		if (flipping & Image::FLIP_H)
+			mirror |= Graphics::kBlitMirrorY;
+
+		// Scaling and taking parts of the image only drop pixels, so the
+		// alpha type of the whole image applies to the source as well
+		Graphics::alphaBlit((byte *)_backSurface->getBasePtr(destRect.left, destRect.top), _backSurface->pitch,
+		                    (const byte *)img->getBasePtr(skipX, skipY), img->pitch,
+		                    destRect.width(), destRect.height(), mirror, color, getAlphaType());
 	}
 
-	if (posX < 0) {
-		img->w = MAX(0, (int)img->w - -posX);
-		img->pixels = (byte *)img->pixels + (-posX * 4);
-		posX = 0;
+	if (imgScaled) {
+		imgScaled->free();
+		delete imgScaled;
 	}
 
-	img->w = CLIP((int)img->w, 0, (int)MAX((int)_backSurface->w - posX, 0));
-	img->h = CLIP((int)img->h, 0, (int)MAX((int)_backSurface->h - posY, 0));
-
-	if ((img->w > 0) && (img->h > 0)) {
-		int xp = 0, yp = 0;
+	return true;
+}
 
-		int inStep = 4;
-		int inoStep = img->pitch;
-		if (flipping & Image::FLIP_V) {
-			inStep = -inStep;
-			xp = img->w - 1;
-		}
+Graphics::AlphaType RenderedImage::getAlphaType() {
+	if (!_alphaTypeValid) {
+		_alphaType = Graphics::getAlphaType(_data, _width * 4, _width, _height);
+		_alphaTypeValid = true;
+	}
 
-		if (flipping & Image::FLIP_H) {
-			inoStep = -inoStep;
-			yp = img->h - 1;
-		}
+	return _alphaType;
+}
 
-		byte *ino = (byte *)img->getBasePtr(xp, yp);
-		byte *outo = (byte *)_backSurface->getBasePtr(posX, posY);
-		byte *in, *out;
-
-		for (int i = 0; i < img->h; i++) {
-			out = outo;
-			in = ino;
-			for (int j = 0; j < img->w; j++) {
-				uint32 pix = *(uint32 *)in;
-				int b = (pix >> 0) & 0xff;
-				int g = (pix >> 8) & 0xff;
-				int r = (pix >> 16) & 0xff;
-				int a = (pix >> 24) & 0xff;
-				in += inStep;
-
-				if (ca != 255) {
-					a = a * ca >> 8;
-				}
-
-				switch (a) {
-				case 0: // Full transparency
-					out += 4;
-					break;
-				case 255: // Full opacity
-#if defined(SCUMM_LITTLE_ENDIAN)
-					if (cb != 255)
-						*out++ = (b * cb) >> 8;
-					else
-						*out++ = b;
-
-					if (cg != 255)
-						*out++ = (g * cg) >> 8;
-					else
-						*out++ = g;
-
-					if (cr != 255)
-						*out++ = (r * cr) >> 8;
-					else
-						*out++ = r;
-
-					*out++ = a;
-#else
-					*out++ = a;
-
-					if (cr != 255)
-						*out++ = (r * cr) >> 8;
-					else
-						*out++ = r;
-
-					if (cg != 255)
-						*out++ = (g * cg) >> 8;
-					else
-						*out++ = g;
-
-					if (cb != 255)
-						*out++ = (b * cb) >> 8;
-					else
-						*out++ = b;
-#endif
-					break;
-
-				default: // alpha blending
-#if defined(SCUMM_LITTLE_ENDIAN)
-					if (cb == 0)
-						*out = 0;
-					else if (cb != 255)
-						*out += ((b - *out) * a * cb) >> 16;
-					else
-						*out += ((b - *out) * a) >> 8;
-					out++;
-					if (cg == 0)
-						*out = 0;
-					else if (cg != 255)
-						*out += ((g - *out) * a * cg) >> 16;
-					else
-						*out += ((g - *out) * a) >> 8;
-					out++;
-					if (cr == 0)
-						*out = 0;
-					else if (cr != 255)
-						*out += ((r - *out) * a * cr) >> 16;
-					else
-						*out += ((r - *out) * a) >> 8;
-					out++;
-					*out = 255;
-					out++;
-#else
-					*out = 255;
-					out++;
-					if (cr == 0)
-						*out = 0;
-					else if (cr != 255)
-						*out += ((r - *out) * a * cr) >> 16;
-					else
-						*out += ((r - *out) * a) >> 8;
-					out++;
-					if (cg == 0)
-						*out = 0;
-					else if (cg != 255)
-						*out += ((g - *out) * a * cg) >> 16;
-					else
-						*out += ((g - *out) * a) >> 8;
-					out++;
-					if (cb == 0)
-						*out = 0;
-					else if (cb != 255)
-						*out += ((b - *out) * a * cb) >> 16;
-					else
-						*out += ((b - *out) * a) >> 8;
-					out++;
-#endif
-				}
+/**
+ * Returns a scaled version of the whole image, which is kept until the
+ * content of the image changes
+ */
+Graphics::Surface *RenderedImage::getScaledImage(const Graphics::Surface &srcImage, int width, int height) {
+	for (uint i = 0; i < _scaledImages.size(); ++i) {
+		Graphics::Surface *s = _scaledImages[i];
+		if (s->w == width && s->h == height) {
+			if (i) {
+				_scaledImages.remove_at(i);
+				_scaledImages.insert_at(0, s);
 			}
-			outo += _backSurface->pitch;
-			ino += inoStep;
+			return s;
 		}
-
-		g_system->copyRectToScreen((byte *)_backSurface->getBasePtr(posX, posY), _backSurface->pitch, posX, posY,
-			img->w, img->h);
 	}
 
-	if (imgScaled) {
-		imgScaled->pixels = savedPixels;
-		imgScaled->free();
-		delete imgScaled;
+	if (_scaledImages.size() >= kMaxScaledImages) {
+		_scaledImages.back()->free();
+		delete _scaledImages.back();
+		_scaledImages.pop_back();
 	}
 
-	return true;
+	Graphics::Surface *s = scale(srcImage, width, height);
+	_scaledImages.insert_at(0, s);
+	return s;
+}
+
+void RenderedImage::clearScaledImages() {
+	for (uint i = 0; i < _scaledImages.size(); ++i) {
+		_scaledImages[i]->free();
+		delete _scaledImages[i];
+	}
+	_scaledImages.clear();
 }
 
 void RenderedImage::copyDirectly(int posX, int posY) {
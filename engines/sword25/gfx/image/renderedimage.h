@@ -40,6 +40,8 @@
 #include "sword25/gfx/image/image.h"
 #include "sword25/gfx/graphicengine.h"
 
+#include "graphics/alpha_blit.h"
+
 namespace Sword25 {
 
 class RenderedImage : public Image {
@@ -106,13 +108,32 @@ public:
 	static Graphics::Surface *scale(const Graphics::Surface &srcImage, int xSize, int ySize);
 
 private:
+	enum {
+		kMaxScaledImages = 4
+	};
+
 	byte *_data;
 	int  _width;
 	int  _height;
 	bool _doCleanup;
 
+	/** The alpha type of the image, determined on its first blit */
+	Graphics::AlphaType _alphaType;
+	bool _alphaTypeValid;
+
+	/**
+	 * Scaled versions of the whole image, the most recently used first.
+	 * Images are often drawn at the same size in every frame, so they only
+	 * need to be scaled once.
+	 */
+	Common::Array<Graphics::Surface *> _scaledImages;
+
 	Graphics::Surface *_backSurface;
 
+	Graphics::AlphaType getAlphaType();
+	Graphics::Surface *getScaledImage(const Graphics::Surface &srcImage, int width, int height);
+	void clearScaledImages();
+
 	static int *scaleLine(int size, int srcSize);
 };
 
@@ -33,8 +33,10 @@
 // Includes
 // -----------------------------------------------------------------------------
 
+#include "sword25/kernel/kernel.h"
 #include "sword25/gfx/image/art.h"
 #include "sword25/gfx/image/vectorimage.h"
+#include "sword25/gfx/image/vectorimagecache.h"
 #include "sword25/gfx/image/renderedimage.h"
 
 #include "graphics/colormasks.h"
@@ -214,7 +216,7 @@ Common::Rect CalculateBoundingBox(const VectorImageElement &vectorImageElement)
 // Construction
 // -----------------------------------------------------------------------------
 
-VectorImage::VectorImage(const byte *pFileData, uint fileSize, bool &success, const Common::String &fname) : _pixelData(0), _fname(fname) {
+VectorImage::VectorImage(const byte *pFileData, uint fileSize, bool &success, const Common::String &fname) : _fname(fname) {
 	success = false;
 
 	// Create bitstream object
@@ -299,8 +301,10 @@ VectorImage::~VectorImage() {
 			if (_elements[j].getPathInfo(i).getVec())
 				free(_elements[j].getPathInfo(i).getVec());
 
-	if (_pixelData)
-		free(_pixelData);
+	// The graphics engine is gone when the remaining resources are freed
+	GraphicEngine *gfx = Kernel::getInstance()->getGfx();
+	if (gfx)
+		gfx->getVectorImageCache()->removeImage(this);
 }
 
 
@@ -603,26 +607,20 @@ bool VectorImage::blit(int posX, int posY,
                        Common::Rect *pPartRect,
                        uint color,
                        int width, int height) {
-	static VectorImage *oldThis = 0;
-	static int              oldWidth = -2;
-	static int              oldHeight = -2;
+	if (width == -1)
+		width = getWidth();
+	if (height == -1)
+		height = getHeight();
 
 	// If width or height to 0, nothing needs to be shown.
-	if (width == 0 || height == 0)
+	if (width <= 0 || height <= 0)
 		return true;
 
-	// Determine if the old image in the cache can not be reused and must be recalculated
-	if (!(oldThis == this && oldWidth == width && oldHeight == height)) {
-		render(width, height);
-
-		oldThis = this;
-		oldHeight = height;
-		oldWidth = width;
-	}
+	const byte *pixelData = Kernel::getInstance()->getGfx()->getVectorImageCache()->getPixels(this, width, height);
 
 	RenderedImage *rend = new RenderedImage();
 
-	rend->replaceContent(_pixelData, width, height);
+	rend->replaceContent(const_cast<byte *>(pixelData), width, height);
 	rend->blit(posX, posY, flipping, pPartRect, color, width, height);
 
 	delete rend;
@@ -630,4 +628,9 @@ bool VectorImage::blit(int posX, int posY,
 	return true;
 }
 
+void VectorImage::prefetch(int width, int height) {
+	if (width > 0 && height > 0)
+		Kernel::getInstance()->getGfx()->getVectorImageCache()->prefetch(this, width, height);
+}
+
 } // End of namespace Sword25
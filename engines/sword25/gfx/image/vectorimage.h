@@ -183,7 +183,19 @@ public:
 	}
 	virtual bool fill(const Common::Rect *pFillRect = 0, uint color = BS_RGB(0, 0, 0));
 
-	void render(int width, int height);
+	/**
+	 * Rasterizes the image at the given size. The returned pixels have to be
+	 * freed with free(). This does not change the image, and may be called
+	 * from any thread.
+	 */
+	byte *render(int width, int height) const;
+
+	/**
+	 * Rasterizes a single element of the image into pixels of the given size,
+	 * which have to be cleared before the first element. Drawing all elements
+	 * in order gives the same result as render().
+	 */
+	void renderElement(byte *pixels, int width, int height, uint elementNr) const;
 
 	virtual uint getPixel(int x, int y);
 	virtual bool isBlitSource() const {
@@ -213,6 +225,7 @@ public:
 	                  Common::Rect *pPartRect = NULL,
 	                  uint color = BS_ARGB(255, 255, 255, 255),
 	                  int width = -1, int height = -1);
+	virtual void prefetch(int width, int height);
 
 	class SWFBitStream;
 
@@ -224,8 +237,6 @@ private:
 	Common::Array<VectorImageElement>    _elements;
 	Common::Rect                         _boundingBox;
 
-	byte *_pixelData;
-
 	Common::String _fname;
 };
 
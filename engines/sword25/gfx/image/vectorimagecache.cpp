@@ -0,0 +1,229 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "common/system.h"
+#include "common/timer.h"
+
+#include "sword25/gfx/image/vectorimage.h"
+#include "sword25/gfx/image/vectorimagecache.h"
+
+namespace Sword25 {
+
+VectorImageCache::VectorImageCache(bool prefetch) : _usedMemory(0), _nextElement(0), _drawnPixels(0), _prefetch(prefetch) {
+	if (_prefetch)
+		g_system->getTimerManager()->installTimerProc(&timerCallback, kPrefetchInterval, this);
+}
+
+VectorImageCache::~VectorImageCache() {
+	// This waits for a running callback to return
+	if (_prefetch)
+		g_system->getTimerManager()->removeTimerProc(&timerCallback);
+
+	free(_rasterizing.pixels);
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i)
+		free(i->pixels);
+}
+
+const byte *VectorImageCache::getPixels(const VectorImage *image, int width, int height) {
+	const Entry key(image, width, height);
+	bool rasterizing;
+
+	{
+		Common::StackLock lock(_mutex);
+		byte *pixels = lookUp(key);
+		if (pixels)
+			return _drawnPixels = pixels;
+
+		// It is needed now, so it is not worth waiting for the queue
+		_queue.remove(key);
+		rasterizing = (_rasterizing == key);
+	}
+
+	if (rasterizing) {
+		// The timer callback started rasterizing it already, the remaining
+		// elements are drawn here
+		Common::StackLock rasterizeLock(_rasterizeMutex);
+		while (_rasterizing == key && !rasterizeElement())
+			;
+
+		Common::StackLock lock(_mutex);
+		byte *pixels = lookUp(key);
+		if (pixels)
+			return _drawnPixels = pixels;
+	}
+
+	byte *pixels = image->render(width, height);
+
+	Common::StackLock lock(_mutex);
+	insert(Entry(image, width, height, pixels));
+	_drawnPixels = pixels;
+	freeUnusedMemory();
+
+	return pixels;
+}
+
+void VectorImageCache::prefetch(const VectorImage *image, int width, int height) {
+	if (!_prefetch)
+		return;
+
+	const Entry key(image, width, height);
+
+	Common::StackLock lock(_mutex);
+	if (_rasterizing == key)
+		return;
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i)
+		if (*i == key)
+			return;
+	for (EntryList::iterator i = _queue.begin(); i != _queue.end(); ++i)
+		if (*i == key)
+			return;
+
+	// The oldest predictions are the least likely to be still needed
+	if (_queue.size() >= kMaxQueuedImages)
+		_queue.pop_front();
+	_queue.push_back(key);
+}
+
+void VectorImageCache::removeImage(const VectorImage *image) {
+	// Keeps the timer callback from drawing into the image meanwhile
+	Common::StackLock rasterizeLock(_rasterizeMutex);
+	Common::StackLock lock(_mutex);
+
+	for (EntryList::iterator i = _queue.begin(); i != _queue.end(); ) {
+		if (i->image == image)
+			i = _queue.erase(i);
+		else
+			++i;
+	}
+
+	if (_rasterizing.image == image) {
+		free(_rasterizing.pixels);
+		_rasterizing = Entry();
+	}
+
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ) {
+		if (i->image == image) {
+			if (i->pixels == _drawnPixels)
+				_drawnPixels = 0;
+			_usedMemory -= i->width * i->height * 4;
+			free(i->pixels);
+			i = _entries.erase(i);
+		} else {
+			++i;
+		}
+	}
+}
+
+/**
+ * Returns the pixels of a cached image, and moves it to the front of the
+ * list. The mutex has to be held.
+ */
+byte *VectorImageCache::lookUp(const Entry &key) {
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (*i == key) {
+			const Entry entry = *i;
+			if (i != _entries.begin()) {
+				_entries.erase(i);
+				_entries.push_front(entry);
+			}
+			return entry.pixels;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Adds a rasterized image to the front of the list. The mutex has to be held.
+ */
+void VectorImageCache::insert(const Entry &entry) {
+	_entries.push_front(entry);
+	_usedMemory += entry.width * entry.height * 4;
+}
+
+/**
+ * Frees the least recently used images until the budget is met. The image
+ * which was returned by getPixels() last is always kept, as it might be
+ * being drawn. The mutex has to be held.
+ */
+void VectorImageCache::freeUnusedMemory() {
+	EntryList::iterator i = _entries.end();
+	while (_usedMemory > kMaxMemory && i != _entries.begin()) {
+		--i;
+		if (i->pixels == _drawnPixels)
+			continue;
+
+		_usedMemory -= i->width * i->height * 4;
+		free(i->pixels);
+		i = _entries.erase(i);
+	}
+}
+
+void VectorImageCache::timerCallback(void *refCon) {
+	((VectorImageCache *)refCon)->rasterizeQueued();
+}
+
+/**
+ * Draws the next element of the image being rasterized in advance, and
+ * starts on the first image in the queue if there is none. Only one element
+ * is drawn per call, so that the timer thread is not kept busy for long.
+ */
+void VectorImageCache::rasterizeQueued() {
+	Common::StackLock rasterizeLock(_rasterizeMutex);
+
+	if (!_rasterizing.image) {
+		Common::StackLock lock(_mutex);
+		if (_queue.empty())
+			return;
+
+		_rasterizing = _queue.front();
+		_queue.pop_front();
+		_rasterizing.pixels = (byte *)calloc(_rasterizing.width * _rasterizing.height, 4);
+		if (!_rasterizing.pixels)
+			error("[VectorImageCache::rasterizeQueued] Cannot allocate memory");
+		_nextElement = 0;
+	}
+
+	rasterizeElement();
+}
+
+/**
+ * Draws the next element of the image being rasterized in advance, and adds
+ * the image to the cache after the last one. Returns whether the image is
+ * complete. The rasterize mutex has to be held.
+ */
+bool VectorImageCache::rasterizeElement() {
+	const Entry &entry = _rasterizing;
+	if (_nextElement < entry.image->getElementCount())
+		entry.image->renderElement(entry.pixels, entry.width, entry.height, _nextElement++);
+	if (_nextElement < entry.image->getElementCount())
+		return false;
+
+	Common::StackLock lock(_mutex);
+	insert(_rasterizing);
+	_rasterizing = Entry();
+	freeUnusedMemory();
+	return true;
+}
+
+} // End of namespace Sword25
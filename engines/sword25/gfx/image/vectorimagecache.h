@@ -0,0 +1,124 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#ifndef SWORD25_VECTORIMAGECACHE_H
+#define SWORD25_VECTORIMAGECACHE_H
+
+#include "common/list.h"
+#include "common/mutex.h"
+#include "sword25/kernel/common.h"
+
+namespace Sword25 {
+
+class VectorImage;
+
+/**
+ * Keeps vector images rasterized at the sizes they were drawn at. When the
+ * rasterized images take more than kMaxMemory bytes, the least recently used
+ * ones are freed.
+ *
+ * Images which are about to be drawn, like the next frame of an animation,
+ * can be queued to be rasterized in advance. This is done by a timer
+ * callback, which draws one element of an image per call, as it shares the
+ * thread with the other timers. It can be disabled with the "vector_prefetch"
+ * config key.
+ */
+class VectorImageCache {
+public:
+	VectorImageCache(bool prefetch);
+	~VectorImageCache();
+
+	/**
+	 * Returns the pixels of the image rasterized at the given size, and
+	 * rasterizes them first if they are not cached yet. They stay valid until
+	 * the next call, or until the image is removed.
+	 */
+	const byte *getPixels(const VectorImage *image, int width, int height);
+
+	/**
+	 * Queues the image to be rasterized at the given size in the background,
+	 * unless it is cached already.
+	 */
+	void prefetch(const VectorImage *image, int width, int height);
+
+	/**
+	 * Frees the rasterized versions of the image and removes it from the
+	 * queue. This has to be done before the image is deleted.
+	 */
+	void removeImage(const VectorImage *image);
+
+private:
+	enum {
+		kMaxMemory = 16 * 1024 * 1024,
+		kMaxQueuedImages = 8,
+		kPrefetchInterval = 10000	// microseconds
+	};
+
+	struct Entry {
+		const VectorImage *image;
+		int width;
+		int height;
+		byte *pixels;
+
+		Entry() : image(0), width(0), height(0), pixels(0) {}
+		Entry(const VectorImage *image_, int width_, int height_, byte *pixels_ = 0) :
+			image(image_), width(width_), height(height_), pixels(pixels_) {}
+
+		bool operator==(const Entry &other) const {
+			return image == other.image && width == other.width && height == other.height;
+		}
+	};
+
+	typedef Common::List<Entry> EntryList;
+
+	/** The rasterized images, the most recently used first */
+	EntryList _entries;
+	uint _usedMemory;
+
+	/** The images to rasterize in advance, and the one being rasterized */
+	EntryList _queue;
+	Entry _rasterizing;
+	uint _nextElement;
+
+	/** The pixels getPixels() returned last, which are never freed */
+	const byte *_drawnPixels;
+
+	bool _prefetch;
+
+	/** Guards all of the above */
+	Common::Mutex _mutex;
+	/** Held while an element is drawn into the image being rasterized */
+	Common::Mutex _rasterizeMutex;
+
+	byte *lookUp(const Entry &key);
+	void insert(const Entry &entry);
+	void freeUnusedMemory();
+
+	static void timerCallback(void *refCon);
+	void rasterizeQueued();
+	bool rasterizeElement();
+};
+
+} // End of namespace Sword25
+
+#endif
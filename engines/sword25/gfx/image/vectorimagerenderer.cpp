@@ -401,72 +401,76 @@ void drawBez(ArtBpath *bez1, ArtBpath *bez2, byte *buffer, int width, int height
 	free(vec);
 }
 
-void VectorImage::render(int width, int height) {
-	double scaleX = (width == - 1) ? 1 : static_cast<double>(width) / static_cast<double>(getWidth());
-	double scaleY = (height == - 1) ? 1 : static_cast<double>(height) / static_cast<double>(getHeight());
-
+byte *VectorImage::render(int width, int height) const {
 	debug(3, "VectorImage::render(%d, %d) %s", width, height, _fname.c_str());
 
-	if (_pixelData)
-		free(_pixelData);
+	byte *pixelData = (byte *)malloc(width * height * 4);
+	if (!pixelData)
+		error("[VectorImage::render] Cannot allocate memory");
+	memset(pixelData, 0, width * height * 4);
+
+	for (uint e = 0; e < _elements.size(); e++)
+		renderElement(pixelData, width, height, e);
 
-	_pixelData = (byte *)malloc(width * height * 4);
-	memset(_pixelData, 0, width * height * 4);
+	return pixelData;
+}
 
-	for (uint e = 0; e < _elements.size(); e++) {
+void VectorImage::renderElement(byte *pixels, int width, int height, uint elementNr) const {
+	double scaleX = (width == - 1) ? 1 : static_cast<double>(width) / static_cast<double>(getWidth());
+	double scaleY = (height == - 1) ? 1 : static_cast<double>(height) / static_cast<double>(getHeight());
+	const VectorImageElement &element = getElement(elementNr);
 
-		//// Draw shapes
-		for (uint s = 0; s < _elements[e].getFillStyleCount(); s++) {
-			int fill0len = 0;
-			int fill1len = 0;
+	//// Draw shapes
+	for (uint s = 0; s < element.getFillStyleCount(); s++) {
+		int fill0len = 0;
+		int fill1len = 0;
 
-			// Count vector sizes in order to minimize memory
-			// fragmentation
-			for (uint p = 0; p < _elements[e].getPathCount(); p++) {
-				if (_elements[e].getPathInfo(p).getFillStyle0() == s + 1)
-					fill0len += _elements[e].getPathInfo(p).getVecLen();
+		// Count vector sizes in order to minimize memory
+		// fragmentation
+		for (uint p = 0; p < element.getPathCount(); p++) {
+			if (element.getPathInfo(p).getFillStyle0() == s + 1)
+				fill0len += element.getPathInfo(p).getVecLen();
 
-				if (_elements[e].getPathInfo(p).getFillStyle1() == s + 1)
-					fill1len += _elements[e].getPathInfo(p).getVecLen();
-			}
+			if (element.getPathInfo(p).getFillStyle1() == s + 1)
+				fill1len += element.getPathInfo(p).getVecLen();
+		}
 
-			// Now lump together vectors
-			ArtBpath *fill1 = art_new(ArtBpath, fill1len + 1);
-			ArtBpath *fill0 = art_new(ArtBpath, fill0len + 1);
-			ArtBpath *fill1pos = fill1;
-			ArtBpath *fill0pos = fill0;
+		// Now lump together vectors
+		ArtBpath *fill1 = art_new(ArtBpath, fill1len + 1);
+		ArtBpath *fill0 = art_new(ArtBpath, fill0len + 1);
+		ArtBpath *fill1pos = fill1;
+		ArtBpath *fill0pos = fill0;
 
-			for (uint p = 0; p < _elements[e].getPathCount(); p++) {
-				if (_elements[e].getPathInfo(p).getFillStyle0() == s + 1) {
-					for (int i = 0; i < _elements[e].getPathInfo(p).getVecLen(); i++)
-						*fill0pos++ = _elements[e].getPathInfo(p).getVec()[i];
-				}
+		for (uint p = 0; p < element.getPathCount(); p++) {
+			if (element.getPathInfo(p).getFillStyle0() == s + 1) {
+				for (int i = 0; i < element.getPathInfo(p).getVecLen(); i++)
+					*fill0pos++ = element.getPathInfo(p).getVec()[i];
+			}
 
-				if (_elements[e].getPathInfo(p).getFillStyle1() == s + 1) {
-					for (int i = 0; i < _elements[e].getPathInfo(p).getVecLen(); i++)
-						*fill1pos++ = _elements[e].getPathInfo(p).getVec()[i];
-				}
+			if (element.getPathInfo(p).getFillStyle1() == s + 1) {
+				for (int i = 0; i < element.getPathInfo(p).getVecLen(); i++)
+					*fill1pos++ = element.getPathInfo(p).getVec()[i];
 			}
+		}
 
-			// Close vectors
-			(*fill0pos).code = ART_END;
-			(*fill1pos).code = ART_END;
+		// Close vectors
+		(*fill0pos).code = ART_END;
+		(*fill1pos).code = ART_END;
 
-			drawBez(fill1, fill0, _pixelData, width, height, _boundingBox.left, _boundingBox.top, scaleX, scaleY, -1, _elements[e].getFillStyleColor(s));
+		drawBez(fill1, fill0, pixels, width, height, _boundingBox.left, _boundingBox.top, scaleX, scaleY, -1, element.getFillStyleColor(s));
 
-			free(fill0);
-			free(fill1);
-		}
+		free(fill0);
+		free(fill1);
+	}
 
-		//// Draw strokes
-		for (uint s = 0; s < _elements[e].getLineStyleCount(); s++) {
-			double penWidth = _elements[e].getLineStyleWidth(s);
-			penWidth *= sqrt(fabs(scaleX * scaleY));
+	//// Draw strokes
+	for (uint s = 0; s < element.getLineStyleCount(); s++) {
+		double penWidth = element.getLineStyleWidth(s);
+		penWidth *= sqrt(fabs(scaleX * scaleY));
 
-			for (uint p = 0; p < _elements[e].getPathCount(); p++) {
-				if (_elements[e].getPathInfo(p).getLineStyle() == s + 1) {
-					drawBez(_elements[e].getPathInfo(p).getVec(), 0, _pixelData, width, height, _boundingBox.left, _boundingBox.top, scaleX, scaleY, penWidth, _elements[e].getLineStyleColor(s));
-				}
+		for (uint p = 0; p < element.getPathCount(); p++) {
+			if (element.getPathInfo(p).getLineStyle() == s + 1) {
+				drawBez(element.getPathInfo(p).getVec(), 0, pixels, width, height, _boundingBox.left, _boundingBox.top, scaleX, scaleY, penWidth, element.getLineStyleColor(s));
 			}
 		}
 	}
@@ -96,6 +96,10 @@ RenderObject::RenderObject(RenderObjectPtr<RenderObject> parentPtr, TYPES type,
 }
 
 RenderObject::~RenderObject() {
+	// The region the object covered has to be drawn again
+	if (_managerPtr && _oldVisible)
+		_managerPtr->addDirtyRect(_oldBbox);
+
 	// Objekt aus dem Elternobjekt entfernen.
 	if (_parentPtr.isValid())
 		_parentPtr->detatchChildren(this->getHandle());
@@ -106,7 +110,7 @@ RenderObject::~RenderObject() {
 	RenderObjectRegistry::instance().deregisterObject(this);
 }
 
-bool RenderObject::render() {
+bool RenderObject::render(const Common::Rect &clipRect) {
 	// Objektnderungen validieren
 	validateObject();
 
@@ -120,13 +124,14 @@ bool RenderObject::render() {
 		_childChanged = false;
 	}
 
-	// Objekt zeichnen.
-	doRender();
+	// Objekt zeichnen, falls es im neu zu zeichnenden Bereich liegt.
+	if (_bbox.intersects(clipRect))
+		doRender();
 
 	// Dann mssen die Kinder gezeichnet werden
 	RENDEROBJECT_ITER it = _children.begin();
 	for (; it != _children.end(); ++it)
-		if (!(*it)->render())
+		if (!(*it)->render(clipRect))
 			return false;
 
 	return true;
@@ -156,7 +161,11 @@ bool RenderObject::updateObjectState() {
 			_parentPtr->signalChildChange();
 
 		// Die Bounding-Box neu berechnen und Update-Regions registrieren.
+		if (_managerPtr && _oldVisible)
+			_managerPtr->addDirtyRect(_oldBbox);
 		updateBoxes();
+		if (_managerPtr && _visible)
+			_managerPtr->addDirtyRect(_bbox);
 
 		// nderungen Validieren
 		validateObject();
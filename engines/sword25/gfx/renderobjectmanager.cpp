@@ -37,16 +37,24 @@
 #include "sword25/gfx/graphicengine.h"
 #include "sword25/gfx/animationtemplateregistry.h"
 #include "common/rect.h"
+#include "common/system.h"
 #include "sword25/gfx/renderobject.h"
 #include "sword25/gfx/timedrenderobject.h"
 #include "sword25/gfx/rootrenderobject.h"
 
 namespace Sword25 {
 
+// Above this number of dirty regions, they are merged into their bounding box
+static const uint kMaxDirtyRects = 32;
+
 RenderObjectManager::RenderObjectManager(int width, int height, int framebufferCount) :
-	_frameStarted(false) {
+	_frameStarted(false),
+	_screenRect(width, height) {
 	// Wurzel des BS_RenderObject-Baumes erzeugen.
 	_rootPtr = (new RootRenderObject(this, width, height))->getHandle();
+
+	// The first frame has to draw everything
+	invalidateScreen();
 }
 
 RenderObjectManager::~RenderObjectManager() {
@@ -75,8 +83,55 @@ bool RenderObjectManager::render() {
 
 	_frameStarted = false;
 
-	// Die Render-Methode der Wurzel aufrufen. Dadurch wird das rekursive Rendern der Baumelemente angestoen.
-	return _rootPtr->render();
+	// Only the regions which changed are drawn again and copied to the screen.
+	// For each of them, the objects inside it are drawn, clipped to it.
+	GraphicEngine *gfxPtr = Kernel::getInstance()->getGfx();
+	Graphics::Surface *surfacePtr = gfxPtr->getSurface();
+	bool result = true;
+
+	for (uint i = 0; i < _dirtyRects.size() && result; ++i) {
+		const Common::Rect &rect = _dirtyRects[i];
+
+		// Die Render-Methode der Wurzel aufrufen. Dadurch wird das rekursive Rendern der Baumelemente angestoen.
+		gfxPtr->setClipRect(rect);
+		result = _rootPtr->render(rect);
+
+		g_system->copyRectToScreen((byte *)surfacePtr->getBasePtr(rect.left, rect.top), surfacePtr->pitch,
+			rect.left, rect.top, rect.width(), rect.height());
+	}
+
+	gfxPtr->setClipRect(_screenRect);
+	_dirtyRects.clear();
+
+	return result;
+}
+
+void RenderObjectManager::addDirtyRect(const Common::Rect &rect) {
+	Common::Rect dirtyRect = rect;
+	dirtyRect.clip(_screenRect);
+	if (dirtyRect.isEmpty())
+		return;
+
+	// Merge it with the regions it overlaps. As the merged region is larger,
+	// it may overlap regions which were checked already.
+	uint i = 0;
+	while (i < _dirtyRects.size()) {
+		if (_dirtyRects[i].intersects(dirtyRect)) {
+			dirtyRect.extend(_dirtyRects[i]);
+			_dirtyRects.remove_at(i);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (_dirtyRects.size() >= kMaxDirtyRects) {
+		for (i = 0; i < _dirtyRects.size(); ++i)
+			dirtyRect.extend(_dirtyRects[i]);
+		_dirtyRects.clear();
+	}
+
+	_dirtyRects.push_back(dirtyRect);
 }
 
 void RenderObjectManager::attatchTimedRenderObject(RenderObjectPtr<TimedRenderObject> renderObjectPtr) {
@@ -140,6 +195,8 @@ bool RenderObjectManager::unpersist(InputPersistenceBlock &reader) {
 	// Alle BS_AnimationTemplates wieder herstellen.
 	result &= AnimationTemplateRegistry::instance().unpersist(reader);
 
+	invalidateScreen();
+
 	return result;
 }
 
@@ -42,6 +42,7 @@
 #ifndef SWORD25_RENDEROBJECTMANAGER_H
 #define SWORD25_RENDEROBJECTMANAGER_H
 
+#include "common/array.h"
 #include "common/rect.h"
 #include "sword25/kernel/common.h"
 #include "sword25/gfx/renderobjectptr.h"
@@ -86,6 +87,20 @@ public:
 	    @return Gibt false zurck, falls das Rendern fehlgeschlagen ist.
 	 */
 	bool render();
+
+	/**
+	 * Marks a region of the screen which has to be drawn again in the next
+	 * frame. Only these regions are drawn and copied to the screen.
+	 */
+	void addDirtyRect(const Common::Rect &rect);
+
+	/**
+	 * Makes the next frame draw the whole screen, e.g. after something else
+	 * drew to it.
+	 */
+	void invalidateScreen() {
+		addDirtyRect(_screenRect);
+	}
 	/**
 	    @brief Gibt einen Pointer auf die Wurzel des Objektbaumes zurck.
 	 */
@@ -111,6 +126,10 @@ public:
 
 private:
 	bool _frameStarted;
+
+	Common::Rect _screenRect;
+	/** The regions which changed since the last frame, without overlaps */
+	Common::Array<Common::Rect> _dirtyRects;
 	typedef Common::Array<RenderObjectPtr<TimedRenderObject> > RenderObjectList;
 	RenderObjectList _timedRenderObjects;
 
@@ -28,6 +28,7 @@ MODULE_OBJS := \
 	gfx/image/renderedimage.o \
 	gfx/image/swimage.o \
 	gfx/image/vectorimage.o \
+	gfx/image/vectorimagecache.o \
 	gfx/image/vectorimagerenderer.o \
 	input/inputengine.o \
 	input/inputengine_script.o \
@@ -0,0 +1,354 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+#include "common/scummsys.h"
+
+#include "graphics/alpha_blit.h"
+#include "graphics/sse2.h"
+
+#if (defined(__SSE2__) || defined(_M_X64)) && defined(SCUMM_LITTLE_ENDIAN)
+#define USE_ALPHA_BLIT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace Graphics {
+
+AlphaType getAlphaType(const byte *src, int pitch, int width, int height) {
+	AlphaType type = kAlphaOpaque;
+
+	for (int y = 0; y < height; y++) {
+		const uint32 *in = (const uint32 *)src;
+		for (int x = 0; x < width; x++) {
+			const uint32 a = in[x] >> 24;
+			if (a == 0)
+				type = kAlphaBinary;
+			else if (a != 255)
+				return kAlphaFull;
+		}
+		src += pitch;
+	}
+
+	return type;
+}
+
+namespace {
+
+/** The components of a modulation color. */
+struct BlitColor {
+	int a, r, g, b;
+
+	BlitColor(uint32 color) {
+		a = (color >> 24) & 0xff;
+		r = (color >> 16) & 0xff;
+		g = (color >> 8) & 0xff;
+		b = (color >> 0) & 0xff;
+
+		// Compensate for transparency. Since we're coming
+		// down to 255 alpha, we just compensate for the colors here
+		if (a != 255) {
+			r = r * a >> 8;
+			g = g * a >> 8;
+			b = b * a >> 8;
+		}
+	}
+};
+
+inline int modulateChannel(int s, int c) {
+	return (c != 255) ? (s * c) >> 8 : s;
+}
+
+inline int blendChannel(int d, int s, int a, int c) {
+	if (c == 0)
+		return 0;
+	else if (c != 255)
+		return d + (((s - d) * a * c) >> 16);
+	else
+		return d + (((s - d) * a) >> 8);
+}
+
+template<bool kModulate>
+inline uint32 modulateOpaque(uint32 pix, const BlitColor &c) {
+	if (!kModulate)
+		return pix;
+
+	return 0xFF000000 |
+	       (modulateChannel((pix >> 16) & 0xff, c.r) << 16) |
+	       (modulateChannel((pix >> 8) & 0xff, c.g) << 8) |
+	       modulateChannel(pix & 0xff, c.b);
+}
+
+template<bool kModulate>
+inline void blendPixel(uint32 *out, uint32 pix, const BlitColor &c) {
+	int a = pix >> 24;
+	if (kModulate && c.a != 255)
+		a = a * c.a >> 8;
+
+	if (a == 0)
+		return;
+
+	if (a == 255) {
+		*out = modulateOpaque<kModulate>(pix, c);
+		return;
+	}
+
+	const uint32 d = *out;
+	int r = (d >> 16) & 0xff;
+	int g = (d >> 8) & 0xff;
+	int b = d & 0xff;
+
+	if (kModulate) {
+		r = blendChannel(r, (pix >> 16) & 0xff, a, c.r);
+		g = blendChannel(g, (pix >> 8) & 0xff, a, c.g);
+		b = blendChannel(b, pix & 0xff, a, c.b);
+	} else {
+		r += ((int)((pix >> 16) & 0xff) - r) * a >> 8;
+		g += ((int)((pix >> 8) & 0xff) - g) * a >> 8;
+		b += ((int)(pix & 0xff) - b) * a >> 8;
+	}
+
+	*out = 0xFF000000 | (r << 16) | (g << 8) | b;
+}
+
+/**
+ * Draw a row of pixels. The source is read backwards if it is mirrored.
+ * The checks which do not apply to the alpha type of the source and the
+ * modulation compile away.
+ */
+template<bool kMirrorX, int kAlphaType, bool kModulate>
+void blitRow(uint32 *out, const uint32 *in, int width, const BlitColor &c) {
+	if (kAlphaType == kAlphaOpaque && !kModulate && !kMirrorX) {
+		memcpy(out, in, width * 4);
+		return;
+	}
+
+	for (int x = 0; x < width; x++) {
+		const uint32 pix = kMirrorX ? in[-x] : in[x];
+
+		if (kAlphaType == kAlphaOpaque) {
+			out[x] = modulateOpaque<kModulate>(pix, c);
+		} else if (kAlphaType == kAlphaBinary && !kModulate) {
+			if (pix >> 24)
+				out[x] = pix;
+		} else {
+			blendPixel<kModulate>(out + x, pix, c);
+		}
+	}
+}
+
+#ifdef USE_ALPHA_BLIT_SSE2
+
+/** The modulation color, prepared for blending two pixels in 16 bit lanes. */
+struct BlitColorSSE2 {
+	__m128i alpha;		///< the alpha of the color, 256 for 255
+	__m128i factor;		///< the components of the color, 256 for 255
+	__m128i keep;		///< all bits set for the components which are not 0
+	__m128i opaque;		///< the alpha component of opaque pixels
+
+	BlitColorSSE2(const BlitColor &c) {
+		const short r = (c.r == 255) ? 256 : c.r;
+		const short g = (c.g == 255) ? 256 : c.g;
+		const short b = (c.b == 255) ? 256 : c.b;
+		const short keepR = c.r ? -1 : 0;
+		const short keepG = c.g ? -1 : 0;
+		const short keepB = c.b ? -1 : 0;
+
+		alpha = _mm_set1_epi16((c.a == 255) ? 256 : c.a);
+		factor = _mm_set_epi16(0, r, g, b, 0, r, g, b);
+		keep = _mm_set_epi16(0, keepR, keepG, keepB, 0, keepR, keepG, keepB);
+		opaque = _mm_set1_epi32((int)0xFF000000);
+	}
+};
+
+/** Modulate two opaque pixels unpacked to 16 bit lanes. */
+inline __m128i modulateOpaqueSSE2(__m128i s, const BlitColorSSE2 &c) {
+	return _mm_srli_epi16(_mm_mullo_epi16(s, c.factor), 8);
+}
+
+/**
+ * Blend two pixels unpacked to 16 bit lanes, with their alpha in all lanes.
+ * The alpha component of the result is left 0.
+ */
+inline __m128i blendSSE2(__m128i s, __m128i d, __m128i a, const BlitColorSSE2 &c) {
+	const __m128i isOpaque = _mm_cmpeq_epi16(a, _mm_set1_epi16(255));
+	const __m128i opaque = modulateOpaqueSSE2(s, c);
+
+	// The factor is unsigned, but multiplied as a signed number. Where it
+	// is 32768 or more, the high word of the product lacks one diff.
+	const __m128i m = _mm_mullo_epi16(a, c.factor);
+	const __m128i diff = _mm_sub_epi16(s, d);
+	const __m128i delta = _mm_add_epi16(_mm_mulhi_epi16(diff, m), _mm_and_si128(diff, _mm_srai_epi16(m, 15)));
+	const __m128i blended = _mm_add_epi16(d, delta);
+
+	const __m128i result = _mm_or_si128(_mm_and_si128(isOpaque, opaque), _mm_andnot_si128(isOpaque, blended));
+	return _mm_and_si128(result, c.keep);
+}
+
+template<bool kModulate>
+inline __m128i blendPixelsSSE2(__m128i s, __m128i d, const BlitColorSSE2 &c) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i sLo = _mm_unpacklo_epi8(s, zero);
+	const __m128i sHi = _mm_unpackhi_epi8(s, zero);
+
+	__m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(sHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	if (kModulate) {
+		aLo = _mm_srli_epi16(_mm_mullo_epi16(aLo, c.alpha), 8);
+		aHi = _mm_srli_epi16(_mm_mullo_epi16(aHi, c.alpha), 8);
+	}
+
+	const __m128i lo = blendSSE2(sLo, _mm_unpacklo_epi8(d, zero), aLo, c);
+	const __m128i hi = blendSSE2(sHi, _mm_unpackhi_epi8(d, zero), aHi, c);
+	const __m128i result = _mm_or_si128(_mm_packus_epi16(lo, hi), c.opaque);
+
+	// Fully transparent pixels keep the destination
+	const __m128i transparent = _mm_packs_epi16(_mm_cmpeq_epi16(aLo, zero), _mm_cmpeq_epi16(aHi, zero));
+	return _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, result));
+}
+
+/**
+ * Draw four pixels at a time, like blitRow(). Returns the number of pixels
+ * drawn, the rest of the row is left to blitRow().
+ */
+template<bool kMirrorX, int kAlphaType, bool kModulate>
+int blitRowSSE2(uint32 *out, const uint32 *in, int width, const BlitColorSSE2 &c) {
+	// A plain copy is done by memcpy()
+	if (kAlphaType == kAlphaOpaque && !kModulate && !kMirrorX)
+		return 0;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i allSet = _mm_cmpeq_epi8(zero, zero);
+
+	int x = 0;
+	for (; x + 4 <= width; x += 4) {
+		__m128i s;
+		if (kMirrorX)
+			s = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - x - 3)), _MM_SHUFFLE(0, 1, 2, 3));
+		else
+			s = _mm_loadu_si128((const __m128i *)(in + x));
+
+		__m128i *dst = (__m128i *)(out + x);
+
+		if (kAlphaType == kAlphaOpaque) {
+			if (kModulate) {
+				const __m128i lo = modulateOpaqueSSE2(_mm_unpacklo_epi8(s, zero), c);
+				const __m128i hi = modulateOpaqueSSE2(_mm_unpackhi_epi8(s, zero), c);
+				s = _mm_or_si128(_mm_packus_epi16(lo, hi), c.opaque);
+			}
+		} else if (kAlphaType == kAlphaBinary && !kModulate) {
+			// The alpha of the pixels is either 0 or 255, the sign shifted
+			// in selects the opaque ones
+			const __m128i isOpaque = _mm_srai_epi32(s, 24);
+			s = _mm_or_si128(_mm_and_si128(isOpaque, s), _mm_andnot_si128(isOpaque, _mm_loadu_si128(dst)));
+		} else {
+			// Sprites mostly consist of runs of fully transparent or opaque
+			// pixels, which need no blending
+			const int alphaBits = 0x8888;
+			if ((_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) & alphaBits) == alphaBits)
+				continue;
+			if (kModulate || (_mm_movemask_epi8(_mm_cmpeq_epi8(s, allSet)) & alphaBits) != alphaBits)
+				s = blendPixelsSSE2<kModulate>(s, _mm_loadu_si128(dst), c);
+		}
+
+		_mm_storeu_si128(dst, s);
+	}
+
+	return x;
+}
+
+#endif
+
+template<bool kMirrorX, int kAlphaType, bool kModulate>
+void blitRows(byte *dst, int dstPitch, const byte *src, int srcPitch, int width, int height, const BlitColor &c) {
+#ifdef USE_ALPHA_BLIT_SSE2
+	const BlitColorSSE2 colorSSE2(c);
+#endif
+
+	for (int y = 0; y < height; y++) {
+		uint32 *out = (uint32 *)dst;
+		const uint32 *in = (const uint32 *)src + (kMirrorX ? width - 1 : 0);
+		int x = 0;
+
+#ifdef USE_ALPHA_BLIT_SSE2
+		if (gUseSSE2)
+			x = blitRowSSE2<kMirrorX, kAlphaType, kModulate>(out, in, width, colorSSE2);
+#endif
+
+		blitRow<kMirrorX, kAlphaType, kModulate>(out + x, kMirrorX ? in - x : in + x, width - x, c);
+
+		dst += dstPitch;
+		src += srcPitch;
+	}
+}
+
+template<bool kMirrorX>
+void blitWithAlphaType(byte *dst, int dstPitch, const byte *src, int srcPitch, int width, int height, AlphaType alphaType, bool modulate, const BlitColor &c) {
+	// Binary alpha only helps if the opaque pixels can be copied
+	if (alphaType == kAlphaBinary && modulate)
+		alphaType = kAlphaFull;
+
+	switch (alphaType) {
+	case kAlphaOpaque:
+		if (modulate)
+			blitRows<kMirrorX, kAlphaOpaque, true>(dst, dstPitch, src, srcPitch, width, height, c);
+		else
+			blitRows<kMirrorX, kAlphaOpaque, false>(dst, dstPitch, src, srcPitch, width, height, c);
+		break;
+	case kAlphaBinary:
+		blitRows<kMirrorX, kAlphaBinary, false>(dst, dstPitch, src, srcPitch, width, height, c);
+		break;
+	default:
+		if (modulate)
+			blitRows<kMirrorX, kAlphaFull, true>(dst, dstPitch, src, srcPitch, width, height, c);
+		else
+			blitRows<kMirrorX, kAlphaFull, false>(dst, dstPitch, src, srcPitch, width, height, c);
+		break;
+	}
+}
+
+} // End of anonymous namespace
+
+void alphaBlit(byte *dst, int dstPitch, const byte *src, int srcPitch, int width, int height, int mirror, uint32 color, AlphaType alphaType) {
+	const BlitColor c(color);
+
+	// Check if we need to draw anything at all
+	if (c.a == 0 || width <= 0 || height <= 0)
+		return;
+
+	// A transparent color turns opaque pixels into partially transparent ones
+	if (c.a != 255)
+		alphaType = kAlphaFull;
+
+	if (mirror & kBlitMirrorY) {
+		src += (height - 1) * srcPitch;
+		srcPitch = -srcPitch;
+	}
+
+	const bool modulate = (color != 0xFFFFFFFF);
+	if (mirror & kBlitMirrorX)
+		blitWithAlphaType<true>(dst, dstPitch, src, srcPitch, width, height, alphaType, modulate, c);
+	else
+		blitWithAlphaType<false>(dst, dstPitch, src, srcPitch, width, height, alphaType, modulate, c);
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,85 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+/**
+ * @file
+ * Alpha blending of 32 bit ARGB images used in engines:
+ * - sword25
+ */
+
+#ifndef GRAPHICS_ALPHA_BLIT_H
+#define GRAPHICS_ALPHA_BLIT_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * The kinds of alpha values found in an ARGB image. Images without
+ * partially transparent pixels can be drawn with cheaper kernels.
+ */
+enum AlphaType {
+	kAlphaOpaque,	///< all pixels are opaque
+	kAlphaBinary,	///< all pixels are either opaque or fully transparent
+	kAlphaFull		///< the image may contain partially transparent pixels
+};
+
+enum {
+	kBlitMirrorX = 1 << 0,	///< draw the columns of the source from right to left
+	kBlitMirrorY = 1 << 1	///< draw the rows of the source from bottom to top
+};
+
+/**
+ * Determine the alpha type of an ARGB image.
+ *
+ * @param src    the image, as native 32 bit 0xAARRGGBB pixels
+ * @param pitch  the pitch of the image in bytes
+ * @param width  the width of the image
+ * @param height the height of the image
+ */
+AlphaType getAlphaType(const byte *src, int pitch, int width, int height);
+
+/**
+ * Alpha blend an ARGB image onto another one.
+ *
+ * The components of the source are multiplied with those of the
+ * modulation color first, which makes the source transparent if the
+ * alpha of the color is 0. All pixels drawn become opaque.
+ *
+ * @param dst       the top left pixel of the destination area
+ * @param dstPitch  the pitch of the destination in bytes
+ * @param src       the top left pixel of the source, before mirroring
+ * @param srcPitch  the pitch of the source in bytes
+ * @param width     the width of the area to draw
+ * @param height    the height of the area to draw
+ * @param mirror    a combination of kBlitMirrorX and kBlitMirrorY
+ * @param color     the modulation color as 0xAARRGGBB, 0xFFFFFFFF to keep
+ *                  the source unchanged
+ * @param alphaType the alpha type of the source, kAlphaFull is always safe
+ */
+void alphaBlit(byte *dst, int dstPitch, const byte *src, int srcPitch, int width, int height, int mirror, uint32 color, AlphaType alphaType);
+
+} // End of namespace Graphics
+
+#endif
@@ -1,6 +1,7 @@
 MODULE := graphics
 
 MODULE_OBJS := \
+	alpha_blit.o \
 	conversion.o \
 	cursorman.o \
 	dither.o \
@@ -21,6 +22,7 @@ MODULE_OBJS := \
 	scaler.o \
 	scaler/thumbnail_intern.o \
 	sjis.o \
+	sse2.o \
 	surface.o \
 	thumbnail.o \
 	VectorRenderer.o \
@@ -47,7 +49,8 @@ endif
 ifdef USE_HQ_SCALERS
 MODULE_OBJS += \
 	scaler/hq2x.o \
-	scaler/hq3x.o
+	scaler/hq3x.o \
+	scaler/hqx_sse2.o
 
 ifdef USE_NASM
 MODULE_OBJS += \
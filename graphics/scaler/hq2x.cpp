@@ -21,6 +21,7 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/hqx_sse2.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ2x
@@ -122,7 +123,17 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+#ifdef USE_HQX_SSE2
+	HQxPatterns sse2Patterns(width);
+	const uint8 *patterns = 0;
+#endif
+
 	while (height--) {
+#ifdef USE_HQX_SSE2
+		if (Graphics::gUseSSE2)
+			patterns = sse2Patterns.computeRow(p, nextlineSrc);
+#endif
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -140,15 +151,22 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+#ifdef USE_HQX_SSE2
+			if (patterns) {
+				pattern = *patterns++;
+			} else
+#endif
+			{
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
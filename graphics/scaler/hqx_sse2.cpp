@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/hqx_sse2.h"
+
+#ifdef USE_HQX_SSE2
+
+#include <emmintrin.h>
+
+extern "C" uint32 *RGBtoYUV;
+
+// The YUV rows hold one pixel of padding on the left and enough on the right
+// for the last group of four pixels.
+HQxPatterns::HQxPatterns(int width) : _width(width), _nextSrc(0) {
+	const int rowSize = width + 8;
+	_yuvBuffer = (uint32 *)malloc(3 * rowSize * sizeof(uint32));
+	memset(_yuvBuffer, 0, 3 * rowSize * sizeof(uint32));
+	_yuvAbove = _yuvBuffer;
+	_yuv = _yuvAbove + rowSize;
+	_yuvBelow = _yuv + rowSize;
+	_patterns = (uint8 *)malloc(width + 4);
+}
+
+HQxPatterns::~HQxPatterns() {
+	free(_patterns);
+	free(_yuvBuffer);
+}
+
+void HQxPatterns::lookupRow(const uint16 *src, uint32 *yuv) {
+	for (int x = -1; x <= _width; ++x)
+		yuv[x + 1] = RGBtoYUV[src[x]];
+}
+
+const uint8 *HQxPatterns::computeRow(const uint16 *src, uint32 nextlineSrc) {
+	if (src == _nextSrc) {
+		// Moving down by one row: only the new row below has to be looked up
+		uint32 *tmp = _yuvAbove;
+		_yuvAbove = _yuv;
+		_yuv = _yuvBelow;
+		_yuvBelow = tmp;
+	} else {
+		lookupRow(src - nextlineSrc, _yuvAbove);
+		lookupRow(src, _yuv);
+	}
+	lookupRow(src + nextlineSrc, _yuvBelow);
+	_nextSrc = src + nextlineSrc;
+
+	// diffYUV() checks |dY| > 0x30, |dU| > 7 and |dV| > 6. All components are
+	// bytes, so this is a saturated byte subtraction of the thresholds from
+	// the absolute differences.
+	const __m128i thresholds = _mm_set1_epi32(0x00300706);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int x = 0; x < _width; x += 4) {
+		const __m128i w5 = _mm_loadu_si128((const __m128i *)(_yuv + x + 1));
+		const __m128i w[8] = {
+			_mm_loadu_si128((const __m128i *)(_yuvAbove + x)),
+			_mm_loadu_si128((const __m128i *)(_yuvAbove + x + 1)),
+			_mm_loadu_si128((const __m128i *)(_yuvAbove + x + 2)),
+			_mm_loadu_si128((const __m128i *)(_yuv + x)),
+			_mm_loadu_si128((const __m128i *)(_yuv + x + 2)),
+			_mm_loadu_si128((const __m128i *)(_yuvBelow + x)),
+			_mm_loadu_si128((const __m128i *)(_yuvBelow + x + 1)),
+			_mm_loadu_si128((const __m128i *)(_yuvBelow + x + 2))
+		};
+
+		__m128i pattern = zero;
+		for (int i = 0; i < 8; ++i) {
+			const __m128i absDiff = _mm_or_si128(_mm_subs_epu8(w5, w[i]), _mm_subs_epu8(w[i], w5));
+			const __m128i similar = _mm_cmpeq_epi32(_mm_subs_epu8(absDiff, thresholds), zero);
+			pattern = _mm_or_si128(pattern, _mm_andnot_si128(similar, _mm_set1_epi32(1 << i)));
+		}
+
+		// Each pattern fits into the low byte of its lane
+		pattern = _mm_packs_epi32(pattern, pattern);
+		pattern = _mm_packus_epi16(pattern, pattern);
+		*(uint32 *)(_patterns + x) = _mm_cvtsi128_si32(pattern);
+	}
+
+	return _patterns;
+}
+
+#endif
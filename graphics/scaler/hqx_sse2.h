@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_HQX_SSE2_H
+#define GRAPHICS_SCALER_HQX_SSE2_H
+
+#include "common/scummsys.h"
+#include "graphics/scaler.h"
+#include "graphics/sse2.h"
+
+#if !defined(USE_NASM) && (defined(__SSE2__) || defined(_M_X64))
+#define USE_HQX_SSE2
+
+/**
+ * Computes the HQ2x/HQ3x neighbourhood patterns of whole rows with SSE2.
+ *
+ * The YUV values of each source row are looked up only once and kept for
+ * the two following rows, and the eight diffYUV() checks are done for four
+ * pixels at once. The patterns are identical to those the C++ code
+ * computes per pixel.
+ */
+class HQxPatterns {
+public:
+	HQxPatterns(int width);
+	~HQxPatterns();
+
+	/**
+	 * Returns the patterns of the width pixels starting at src. The rows
+	 * above and below src are used as well, like the scalers do.
+	 */
+	const uint8 *computeRow(const uint16 *src, uint32 nextlineSrc);
+
+private:
+	int _width;
+	const uint16 *_nextSrc;
+
+	uint32 *_yuvBuffer;
+	uint32 *_yuvAbove, *_yuv, *_yuvBelow;
+	uint8 *_patterns;
+
+	void lookupRow(const uint16 *src, uint32 *yuv);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#include "graphics/sse2.h"
+
+#if defined(_MSC_VER) && defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__GNUC__) && defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace Graphics {
+
+static bool detectSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+	// SSE2 is part of the x86-64 base instruction set
+	return true;
+#elif defined(_MSC_VER) && defined(_M_IX86)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#elif defined(__GNUC__) && defined(__i386__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return false;
+	return (edx & (1 << 26)) != 0;
+#else
+	return false;
+#endif
+}
+
+bool gUseSSE2 = detectSSE2();
+
+} // End of namespace Graphics
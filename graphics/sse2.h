@@ -0,0 +1,44 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * $URL$
+ * $Id$
+ *
+ */
+
+#ifndef GRAPHICS_SSE2_H
+#define GRAPHICS_SSE2_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * Whether the graphics code uses SSE2, in builds which support it. This
+ * covers alphaBlit(), convertYUV420ToRGB() and the HQ2x and HQ3x scalers.
+ * It is set if the CPU supports SSE2. The output is the same either way,
+ * so it can be cleared to select the plain C++ code, e.g. for comparing
+ * the two.
+ */
+extern bool gUseSSE2;
+
+} // End of namespace Graphics
+
+#endif
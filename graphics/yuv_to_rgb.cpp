@@ -89,7 +89,14 @@
 #include "common/scummsys.h"
 #include "common/singleton.h"
 
+#include "graphics/sse2.h"
 #include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define USE_YUV_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace Graphics {
 
@@ -233,13 +240,184 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
 	}
 }
 
+#ifdef USE_YUV_SSE2
+
+/**
+ * The shifts and the alpha bits of a pixel format, to assemble the pixels
+ * of sixteen clamped RGB values at once.
+ */
+struct SSE2PixelFormat {
+	SSE2PixelFormat(const Graphics::PixelFormat &format) {
+		const uint32 alpha = format.RGBToColor(0, 0, 0);
+		alpha16 = _mm_set1_epi16((int16)alpha);
+		alpha32 = _mm_set1_epi32((int32)alpha);
+		rLoss = _mm_cvtsi32_si128(format.rLoss);
+		gLoss = _mm_cvtsi32_si128(format.gLoss);
+		bLoss = _mm_cvtsi32_si128(format.bLoss);
+		rShift = _mm_cvtsi32_si128(format.rShift);
+		gShift = _mm_cvtsi32_si128(format.gShift);
+		bShift = _mm_cvtsi32_si128(format.bShift);
+
+		// Most 32 bit formats keep every component in a byte of its own.
+		// Their pixels are simply the interleaved component bytes.
+		byteAligned = format.bytesPerPixel == 4 &&
+		              !format.rLoss && !format.gLoss && !format.bLoss &&
+		              !(format.rShift & 7) && !(format.gShift & 7) && !(format.bShift & 7);
+		for (int i = 0; i < 4; i++)
+			fillBytes[i] = _mm_set1_epi8((char)(alpha >> (i * 8)));
+		rByte = format.rShift >> 3;
+		gByte = format.gShift >> 3;
+		bByte = format.bShift >> 3;
+	}
+
+	__m128i alpha16, alpha32;
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift, gShift, bShift;
+
+	bool byteAligned;
+	__m128i fillBytes[4];
+	int rByte, gByte, bByte;
+};
+
+static inline __m128i assemblePixels16(__m128i r, __m128i g, __m128i b, const SSE2PixelFormat &format) {
+	__m128i pixels = format.alpha16;
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(r, format.rLoss), format.rShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(g, format.gLoss), format.gShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(b, format.bLoss), format.bShift));
+	return pixels;
+}
+
+static inline __m128i assemblePixels32(__m128i r, __m128i g, __m128i b, const SSE2PixelFormat &format) {
+	__m128i pixels = format.alpha32;
+	pixels = _mm_or_si128(pixels, _mm_sll_epi32(_mm_srl_epi32(r, format.rLoss), format.rShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi32(_mm_srl_epi32(g, format.gLoss), format.gShift));
+	pixels = _mm_or_si128(pixels, _mm_sll_epi32(_mm_srl_epi32(b, format.bLoss), format.bShift));
+	return pixels;
+}
+
+/**
+ * Stores the sixteen pixels of the given component bytes.
+ */
+static inline void storePixels(uint16 *dst, __m128i r, __m128i g, __m128i b, const SSE2PixelFormat &format) {
+	const __m128i zero = _mm_setzero_si128();
+	_mm_storeu_si128((__m128i *)dst, assemblePixels16(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(b, zero), format));
+	_mm_storeu_si128((__m128i *)(dst + 8), assemblePixels16(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(b, zero), format));
+}
+
+static inline void storePixels(uint32 *dst, __m128i r, __m128i g, __m128i b, const SSE2PixelFormat &format) {
+	const __m128i zero = _mm_setzero_si128();
+
+	if (format.byteAligned) {
+		__m128i bytes[4] = { format.fillBytes[0], format.fillBytes[1], format.fillBytes[2], format.fillBytes[3] };
+		bytes[format.rByte] = r;
+		bytes[format.gByte] = g;
+		bytes[format.bByte] = b;
+
+		const __m128i low01 = _mm_unpacklo_epi8(bytes[0], bytes[1]);
+		const __m128i high01 = _mm_unpackhi_epi8(bytes[0], bytes[1]);
+		const __m128i low23 = _mm_unpacklo_epi8(bytes[2], bytes[3]);
+		const __m128i high23 = _mm_unpackhi_epi8(bytes[2], bytes[3]);
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low01, low23));
+		_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(low01, low23));
+		_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpacklo_epi16(high01, high23));
+		_mm_storeu_si128((__m128i *)(dst + 12), _mm_unpackhi_epi16(high01, high23));
+		return;
+	}
+
+	for (int half = 0; half < 2; half++) {
+		const __m128i r16 = half ? _mm_unpackhi_epi8(r, zero) : _mm_unpacklo_epi8(r, zero);
+		const __m128i g16 = half ? _mm_unpackhi_epi8(g, zero) : _mm_unpacklo_epi8(g, zero);
+		const __m128i b16 = half ? _mm_unpackhi_epi8(b, zero) : _mm_unpacklo_epi8(b, zero);
+		_mm_storeu_si128((__m128i *)(dst + half * 8), assemblePixels32(_mm_unpacklo_epi16(r16, zero), _mm_unpacklo_epi16(g16, zero), _mm_unpacklo_epi16(b16, zero), format));
+		_mm_storeu_si128((__m128i *)(dst + half * 8 + 4), assemblePixels32(_mm_unpackhi_epi16(r16, zero), _mm_unpackhi_epi16(g16, zero), _mm_unpackhi_epi16(b16, zero), format));
+	}
+}
+
+/**
+ * Computes the chroma term (int16)(coefficient * (c - 128)) of eight chroma
+ * values, like the lookup tables do. The magnitude is multiplied in fixed
+ * point: with factor = (int)(|coefficient| * 16384), the high word of
+ * (|c - 128| << 2) * factor is exactly the truncated product for all 256
+ * values of the four coefficients used.
+ */
+static inline __m128i chromaTerm(__m128i c, __m128i factor, bool negative) {
+	const __m128i sign = _mm_srai_epi16(c, 15);
+	const __m128i magnitude = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+	const __m128i product = _mm_mulhi_epu16(_mm_slli_epi16(magnitude, 2), factor);
+	const __m128i term = _mm_sub_epi16(_mm_xor_si128(product, sign), sign);
+	return negative ? _mm_sub_epi16(_mm_setzero_si128(), term) : term;
+}
+
+/**
+ * Converts the columns of the image up to the last multiple of sixteen with
+ * SSE2, and returns their number. The remaining columns are left to the
+ * lookup table code.
+ *
+ * Each step converts two rows of sixteen pixels, which share eight U and V
+ * values. The chroma terms are computed with the same truncation as the
+ * lookup tables and the sums are clamped to the same range, so the result
+ * is exactly the one of the tables.
+ */
+template<typename PixelInt>
+int convertYUV420ToRGBSSE2(byte *dstPtr, int dstPitch, const Graphics::PixelFormat &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const int width = yWidth & ~15;
+	if (!width)
+		return 0;
+
+	const SSE2PixelFormat sse2Format(format);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i chromaOffset = _mm_set1_epi16(128);
+	const __m128i crRFactor = _mm_set1_epi16((int16)(uint16)((0.419 / 0.299) * 16384));
+	const __m128i crGFactor = _mm_set1_epi16((int16)(uint16)((0.299 / 0.419) * 16384));
+	const __m128i cbGFactor = _mm_set1_epi16((int16)(uint16)((0.114 / 0.331) * 16384));
+	const __m128i cbBFactor = _mm_set1_epi16((int16)(uint16)((0.587 / 0.331) * 16384));
+
+	for (int h = 0; h < yHeight; h += 2) {
+		for (int x = 0; x < width; x += 16) {
+			const __m128i cr = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(vSrc + (x >> 1))), zero), chromaOffset);
+			const __m128i cb = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(uSrc + (x >> 1))), zero), chromaOffset);
+
+			const __m128i crR = chromaTerm(cr, crRFactor, false);
+			const __m128i crbG = _mm_add_epi16(chromaTerm(cr, crGFactor, true), chromaTerm(cb, cbGFactor, true));
+			const __m128i cbB = chromaTerm(cb, cbBFactor, false);
+
+			// Every chroma term applies to two neighbouring pixels
+			const __m128i r[2] = { _mm_unpacklo_epi16(crR, crR), _mm_unpackhi_epi16(crR, crR) };
+			const __m128i g[2] = { _mm_unpacklo_epi16(crbG, crbG), _mm_unpackhi_epi16(crbG, crbG) };
+			const __m128i b[2] = { _mm_unpacklo_epi16(cbB, cbB), _mm_unpackhi_epi16(cbB, cbB) };
+
+			for (int row = 0; row < 2; row++) {
+				const __m128i luma = _mm_loadu_si128((const __m128i *)(ySrc + row * yPitch + x));
+				const __m128i yLow = _mm_unpacklo_epi8(luma, zero);
+				const __m128i yHigh = _mm_unpackhi_epi8(luma, zero);
+
+				// Packing with unsigned saturation clamps the sums to 0-255
+				storePixels((PixelInt *)(dstPtr + row * dstPitch) + x,
+				            _mm_packus_epi16(_mm_add_epi16(yLow, r[0]), _mm_add_epi16(yHigh, r[1])),
+				            _mm_packus_epi16(_mm_add_epi16(yLow, g[0]), _mm_add_epi16(yHigh, g[1])),
+				            _mm_packus_epi16(_mm_add_epi16(yLow, b[0]), _mm_add_epi16(yHigh, b[1])),
+				            sse2Format);
+			}
+		}
+
+		dstPtr += dstPitch << 1;
+		ySrc += yPitch << 1;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+#endif
+
 void convertYUV420ToRGB(Graphics::Surface *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->pixels);
@@ -250,11 +428,33 @@ void convertYUV420ToRGB(Graphics::Surface *dst, const byte *ySrc, const byte *uS
 
 	const YUVToRGBLookup *lookup = YUVToRGBMan.getLookup(dst->format);
 
+	byte *dstPtr = (byte *)dst->pixels;
+	const int bytesPerPixel = dst->format.bytesPerPixel;
+
+#ifdef USE_YUV_SSE2
+	if (gUseSSE2) {
+		int done;
+		if (bytesPerPixel == 2)
+			done = convertYUV420ToRGBSSE2<uint16>(dstPtr, dst->pitch, dst->format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			done = convertYUV420ToRGBSSE2<uint32>(dstPtr, dst->pitch, dst->format, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+
+		dstPtr += done * bytesPerPixel;
+		ySrc += done;
+		uSrc += done >> 1;
+		vSrc += done >> 1;
+		yWidth -= done;
+	}
+#endif
+
+	if (!yWidth)
+		return;
+
 	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->pixels, dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	if (bytesPerPixel == 2)
+		convertYUV420ToRGB<uint16>(dstPtr, dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->pixels, dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>(dstPtr, dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
@@ -43,6 +43,13 @@ struct Surface;
 /**
  * Convert a YUV420 image to an RGB surface
  *
+ * The conversion runs on the calling thread; it does not split the frame
+ * up by itself. Nothing outside of the yWidth x yHeight area of dst is
+ * written, so a caller may convert bands of an even number of rows from
+ * several threads, with dst and the sources offset to each band. The
+ * lookup tables of a new pixel format are built on its first conversion,
+ * which has to be done by a single thread.
+ *
  * @param dst     the destination surface
  * @param ySrc    the source of the y component
  * @param uSrc    the source of the u component
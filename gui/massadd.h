@@ -36,6 +36,7 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::String> StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog();
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data);
@@ -61,6 +62,7 @@ private:
 	int _dirsScanned;
 	int _oldGamesCount;
 	int _dirTotal;
+	uint32 _scanStartTime;
 
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
@@ -31,6 +31,7 @@
 #include "graphics/scaler.h"
 
 #include "engines/metaengine.h"
+#include "engines/saveindex.h"
 
 namespace GUI {
 
@@ -41,7 +42,7 @@ enum {
 };
 
 SaveLoadChooser::SaveLoadChooser(const String &title, const String &buttonLabel)
-	: Dialog("SaveLoadChooser"), _delSupport(0), _list(0), _chooseButton(0), _deleteButton(0), _gfxWidget(0)  {
+	: Dialog("SaveLoadChooser"), _delSupport(0), _list(0), _chooseButton(0), _deleteButton(0), _gfxWidget(0), _saveIndex(0)  {
 	_delSupport = _metaInfoSupport = _thumbnailSupport = _saveDateSupport = _playTimeSupport = false;
 
 	_backgroundType = ThemeEngine::kDialogBackgroundSpecial;
@@ -74,6 +75,7 @@ SaveLoadChooser::SaveLoadChooser(const String &title, const String &buttonLabel)
 }
 
 SaveLoadChooser::~SaveLoadChooser() {
+	delete _saveIndex;
 }
 
 int SaveLoadChooser::runModalWithPluginAndTarget(const EnginePlugin *plugin, const String &target) {
@@ -93,6 +95,14 @@ int SaveLoadChooser::runModalWithPluginAndTarget(const EnginePlugin *plugin, con
 	_saveDateSupport = _metaInfoSupport && (*_plugin)->hasFeature(MetaEngine::kSavesSupportCreationDate);
 	_playTimeSupport = _metaInfoSupport && (*_plugin)->hasFeature(MetaEngine::kSavesSupportPlayTime);
 	_resultString = "";
+
+	// Engines which support it keep the meta infos of their save states in
+	// an index, so that not every save file has to be read here
+	delete _saveIndex;
+	_saveIndex = 0;
+	if (SaveStateIndex::isSupported(_plugin, _target))
+		_saveIndex = new SaveStateIndex(_plugin, _target);
+
 	reflowLayout();
 	updateSaveList();
 
@@ -241,7 +251,8 @@ void SaveLoadChooser::updateSelection(bool redraw) {
 	_playtime->setLabel(_("No playtime saved"));
 
 	if (selItem >= 0 && !_list->getSelectedString().empty() && _metaInfoSupport) {
-		SaveStateDescriptor desc = (*_plugin)->querySaveMetaInfos(_target.c_str(), _saveList[selItem].getSaveSlot());
+		const int slot = _saveList[selItem].getSaveSlot();
+		SaveStateDescriptor desc = _saveIndex ? _saveIndex->querySaveMetaInfos(slot) : (*_plugin)->querySaveMetaInfos(_target.c_str(), slot);
 
 		isDeletable = desc.getDeletableFlag() && _delSupport;
 		isWriteProtected = desc.getWriteProtectedFlag();
@@ -312,6 +323,8 @@ void SaveLoadChooser::updateSelection(bool redraw) {
 }
 
 void SaveLoadChooser::close() {
+	delete _saveIndex;
+	_saveIndex = 0;
 	_plugin = 0;
 	_target.clear();
 	_saveList.clear();
@@ -321,7 +334,7 @@ void SaveLoadChooser::close() {
 }
 
 void SaveLoadChooser::updateSaveList() {
-	_saveList = (*_plugin)->listSaves(_target.c_str());
+	_saveList = _saveIndex ? _saveIndex->listSaves() : (*_plugin)->listSaves(_target.c_str());
 
 	int curSlot = 0;
 	int saveSlot = 0;
@@ -25,6 +25,8 @@
 #include "gui/dialog.h"
 #include "engines/metaengine.h"
 
+class SaveStateIndex;
+
 namespace GUI {
 
 class ListWidget;
@@ -54,6 +56,7 @@ protected:
 	bool					_saveDateSupport;
 	bool					_playTimeSupport;
 	String					_target;
+	SaveStateIndex			*_saveIndex;
 	SaveStateList			_saveList;
 	String					_resultString;
 
@@ -0,0 +1,431 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "common/list.h"
+#include "graphics/pixelformat.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+
+#ifdef POSIX
+#include <pthread.h>
+#endif
+
+/**
+ * Minimal OSystem which only provides what the mixer needs: time,
+ * delays and (on POSIX) real mutexes.
+ */
+class MixerTestSystem : public OSystem {
+public:
+	virtual const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return false; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(OverlayColor *buf, int pitch) {}
+	virtual void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale, const Graphics::PixelFormat *format) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+
+	// The mixer only uses these for bookkeeping and while waiting for
+	// the callback, so a fake clock which just yields is good enough.
+	MixerTestSystem() : _millis(0) {}
+	virtual uint32 getMillis() { return _millis; }
+
+#ifdef POSIX
+	virtual void delayMillis(uint msecs) {
+		_millis += msecs;
+		sched_yield();
+	}
+
+	virtual MutexRef createMutex() {
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_t *mutex = new pthread_mutex_t;
+		pthread_mutex_init(mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+		return (MutexRef)mutex;
+	}
+
+	virtual void lockMutex(MutexRef mutex) { pthread_mutex_lock((pthread_mutex_t *)mutex); }
+	virtual void unlockMutex(MutexRef mutex) { pthread_mutex_unlock((pthread_mutex_t *)mutex); }
+
+	virtual void deleteMutex(MutexRef mutex) {
+		pthread_mutex_destroy((pthread_mutex_t *)mutex);
+		delete (pthread_mutex_t *)mutex;
+	}
+#else
+	virtual void delayMillis(uint msecs) { _millis += msecs; }
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+#endif
+
+private:
+	volatile uint32 _millis;
+};
+
+/**
+ * Audio stream producing a constant value, which keeps track of how many
+ * instances are alive so that leaked or doubly freed channels show up.
+ */
+class CountingStream : public Audio::AudioStream {
+public:
+	static volatile int _alive;
+
+	CountingStream(int length, int16 value = 100) : _left(length), _value(value) {
+#ifdef __GNUC__
+		__sync_fetch_and_add(&_alive, 1);
+#endif
+	}
+
+	~CountingStream() {
+#ifdef __GNUC__
+		__sync_fetch_and_sub(&_alive, 1);
+#endif
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		int samples = numSamples;
+		if (_left >= 0 && samples > _left)
+			samples = _left;
+		for (int i = 0; i < samples; ++i)
+			buffer[i] = _value;
+		if (_left >= 0)
+			_left -= samples;
+		return samples;
+	}
+
+	bool isStereo() const { return true; }
+	int getRate() const { return 22050; }
+	bool endOfData() const { return _left == 0; }
+
+private:
+	int _left;
+	int16 _value;
+};
+
+volatile int CountingStream::_alive = 0;
+
+/**
+ * Stream which stops a channel, possibly its own, the first time it is
+ * read, like engines do from their stream callbacks.
+ */
+class StoppingStream : public CountingStream {
+public:
+	StoppingStream(Audio::Mixer *mixer, int16 value) : CountingStream(-1, value), _mixer(mixer), _stopAll(false), _stopped(false) {}
+
+	Audio::SoundHandle _victim;
+	bool _stopAll;
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		if (!_stopped) {
+			_stopped = true;
+			if (_stopAll)
+				_mixer->stopAll();
+			else
+				_mixer->stopHandle(_victim);
+		}
+		return CountingStream::readBuffer(buffer, numSamples);
+	}
+
+private:
+	Audio::Mixer *_mixer;
+	bool _stopped;
+};
+
+#ifdef POSIX
+struct MixerStressState {
+	Audio::MixerImpl *mixer;
+	volatile bool done;
+	volatile int mixPasses;
+};
+
+static void *mixerStressCallback(void *arg) {
+	MixerStressState *state = (MixerStressState *)arg;
+	byte buffer[512 * 4];
+
+	while (!state->done) {
+		state->mixer->mixCallback(buffer, sizeof(buffer));
+		state->mixPasses++;
+	}
+
+	return 0;
+}
+
+static void *mixerStressEngine(void *arg) {
+	MixerStressState *state = (MixerStressState *)arg;
+	Audio::Mixer *mixer = state->mixer;
+	Audio::SoundHandle handles[4];
+	uint32 seed = (uint32)(size_t)&handles;
+
+	for (int i = 0; i < 2000; ++i) {
+		seed = seed * 1103515245 + 12345;
+		const int slot = (seed >> 16) % 4;
+
+		switch ((seed >> 8) % 5) {
+		case 0:
+			// Some of the streams end by themselves while being mixed
+			mixer->playStream(Audio::Mixer::kSFXSoundType, &handles[slot], new CountingStream((seed & 1) ? -1 : 1024));
+			break;
+		case 1:
+			mixer->stopHandle(handles[slot]);
+			break;
+		case 2:
+			mixer->setChannelVolume(handles[slot], seed & 0xFF);
+			break;
+		case 3:
+			mixer->pauseHandle(handles[slot], (seed & 2) != 0);
+			break;
+		default:
+			mixer->isSoundHandleActive(handles[slot]);
+			break;
+		}
+	}
+
+	return 0;
+}
+#endif
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		g_system = &_system;
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+	}
+
+	void test_play_stop_without_callback() {
+		Audio::MixerImpl *mixerImpl = new Audio::MixerImpl(&_system, 44100);
+		mixerImpl->setReady(true);
+		Audio::Mixer *mixer = mixerImpl;
+
+		Audio::SoundHandle handle;
+		mixer->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(-1));
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+		mixer->setChannelVolume(handle, 100);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 100);
+
+		mixer->stopHandle(handle);
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+
+		// Nothing has been mixed, so the channel is only released by the
+		// next callback pass or the destructor.
+		delete mixerImpl;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+	}
+
+	void test_command_queue_overflow_without_callback() {
+		Audio::MixerImpl *mixerImpl = new Audio::MixerImpl(&_system, 22050);
+		mixerImpl->setReady(true);
+		Audio::Mixer *mixer = mixerImpl;
+
+		// With no callback running, the queue has to be drained by the
+		// engine side once it is full.
+		Audio::SoundHandle handle;
+		mixer->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(-1));
+		for (int i = 0; i < 1000; ++i)
+			mixer->setChannelVolume(handle, i & 0xFF);
+		TS_ASSERT_EQUALS(mixer->getChannelVolume(handle), 999 & 0xFF);
+
+		for (int i = 0; i < 1000; ++i) {
+			mixer->stopHandle(handle);
+			mixer->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(-1));
+		}
+		TS_ASSERT(mixer->isSoundHandleActive(handle));
+
+		delete mixerImpl;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+	}
+
+	void test_finished_channel_is_released() {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(&_system, 22050);
+		mixer->setReady(true);
+
+		Audio::SoundHandle handle;
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(64));
+
+		byte buffer[128 * 4];
+		TS_ASSERT_EQUALS(mixer->mixCallback(buffer, sizeof(buffer)), 32);
+		mixer->mixCallback(buffer, sizeof(buffer));
+
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+
+		delete mixer;
+	}
+
+	void test_paused_channel_is_not_mixed() {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(&_system, 22050);
+		mixer->setReady(true);
+
+		Audio::SoundHandle handle;
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(-1));
+		mixer->pauseHandle(handle, true);
+
+		byte buffer[128 * 4];
+		TS_ASSERT_EQUALS(mixer->mixCallback(buffer, sizeof(buffer)), 0);
+
+		mixer->pauseHandle(handle, false);
+		TS_ASSERT_EQUALS(mixer->mixCallback(buffer, sizeof(buffer)), 128);
+
+		delete mixer;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+	}
+
+	void test_elapsed_time_stops_while_paused() {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(&_system, 22050);
+		mixer->setReady(true);
+
+		Audio::SoundHandle handle;
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(-1));
+
+		// A time stamp of 0 means that nothing was mixed yet
+		_system.delayMillis(1);
+
+		// The time stamp is taken before each block of 256 frames
+		byte buffer[256 * 4];
+		mixer->mixCallback(buffer, sizeof(buffer));
+		mixer->mixCallback(buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(mixer->getSoundElapsedTime(handle), 256u * 1000 / 22050);
+
+		mixer->pauseHandle(handle, true);
+		const uint32 pausedTime = mixer->getSoundElapsedTime(handle);
+		_system.delayMillis(100);
+		TS_ASSERT_EQUALS(mixer->getSoundElapsedTime(handle), pausedTime);
+
+		// The pause does not count once the channel is resumed
+		mixer->pauseHandle(handle, false);
+		TS_ASSERT_EQUALS(mixer->getSoundElapsedTime(handle), pausedTime);
+
+		delete mixer;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+	}
+
+	void test_clipping_happens_after_mixing() {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(&_system, 22050);
+		mixer->setReady(true);
+
+		// Clipping the running sum after each channel would end up at
+		// 32767 - 20000; the 32 bit bus only clips the final sum.
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, new CountingStream(-1, 20000));
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, new CountingStream(-1, 20000));
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, new CountingStream(-1, -20000));
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, new CountingStream(-1, -20000));
+
+		int16 buffer[300 * 2];
+		TS_ASSERT_EQUALS(mixer->mixCallback((byte *)buffer, sizeof(buffer)), 300);
+		for (int i = 0; i < ARRAYSIZE(buffer); ++i)
+			TS_ASSERT_EQUALS(buffer[i], 0);
+
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, new CountingStream(-1, 20000));
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		for (int i = 0; i < ARRAYSIZE(buffer); ++i)
+			TS_ASSERT_EQUALS(buffer[i], 20000);
+
+		delete mixer;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+	}
+
+	void test_stop_from_stream_callback() {
+		Audio::MixerImpl *mixer = new Audio::MixerImpl(&_system, 22050);
+		mixer->setReady(true);
+
+		StoppingStream *stopper = new StoppingStream(mixer, 1000);
+		Audio::SoundHandle handle;
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, stopper);
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, &handle, new CountingStream(-1, 2000));
+		stopper->_victim = handle;
+
+		// The stopped channel must not be mixed after the stream returned
+		int16 buffer[128 * 2];
+		TS_ASSERT_EQUALS(mixer->mixCallback((byte *)buffer, sizeof(buffer)), 128);
+		TS_ASSERT_EQUALS(buffer[0], 1000);
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(CountingStream::_alive, 1);
+
+		// A stream which stops its own channel
+		stopper = new StoppingStream(mixer, 1000);
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, &handle, stopper);
+		stopper->_victim = handle;
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(!mixer->isSoundHandleActive(handle));
+
+		stopper = new StoppingStream(mixer, 1000);
+		stopper->_stopAll = true;
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, stopper);
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT(!mixer->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+
+		mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+
+		delete mixer;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+	}
+
+	void test_concurrent_stress() {
+#ifdef POSIX
+		MixerStressState state;
+		state.mixer = new Audio::MixerImpl(&_system, 22050);
+		state.mixer->setReady(true);
+		state.done = false;
+		state.mixPasses = 0;
+
+		pthread_t callbackThread;
+		pthread_t engineThreads[3];
+
+		pthread_create(&callbackThread, 0, mixerStressCallback, &state);
+		for (int i = 0; i < ARRAYSIZE(engineThreads); ++i)
+			pthread_create(&engineThreads[i], 0, mixerStressEngine, &state);
+
+		for (int i = 0; i < ARRAYSIZE(engineThreads); ++i)
+			pthread_join(engineThreads[i], 0);
+
+		state.mixer->stopAll();
+		TS_ASSERT(!state.mixer->hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+
+		state.done = true;
+		pthread_join(callbackThread, 0);
+		TS_ASSERT(state.mixPasses > 0);
+
+		delete state.mixer;
+		TS_ASSERT_EQUALS(CountingStream::_alive, 0);
+#endif
+	}
+
+private:
+	MixerTestSystem _system;
+	OSystem *_oldSystem;
+};
@@ -0,0 +1,153 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+namespace {
+
+/**
+ * Audio stream producing a constant value for a given number of frames.
+ */
+class ConstantStream : public Audio::AudioStream {
+public:
+	ConstantStream(int rate, bool stereo, int16 left, int16 right, int frames)
+		: _rate(rate), _stereo(stereo), _left(left), _right(right), _samplesLeft(frames * (stereo ? 2 : 1)) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const int samples = MIN(numSamples, _samplesLeft);
+		for (int i = 0; i < samples; ++i)
+			buffer[i] = (_stereo && ((_samplesLeft - i) & 1)) ? _right : _left;
+		_samplesLeft -= samples;
+		return samples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return _samplesLeft == 0; }
+
+private:
+	int _rate;
+	bool _stereo;
+	int16 _left, _right;
+	int _samplesLeft;
+};
+
+} // End of anonymous namespace
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_sinc_constant_mono() {
+		testConstant("sinc", 22050, 48000, false, false);
+		testConstant("sinc", 44100, 22050, false, false);
+	}
+
+	void test_sinc_constant_stereo() {
+		testConstant("sinc", 22050, 48000, true, false);
+		testConstant("sinc", 48000, 44100, true, false);
+		testConstant("sinc", 11025, 44100, true, true);
+	}
+
+	void test_sinc_flushes_tail() {
+		// Every input frame has to reach the output, including the last
+		// ones which are still in the filter at the end of the stream.
+		const int inFrames = 1000;
+		Audio::RateConverter *converter = makeConverter("sinc", 22050, 44100, true, false);
+		ConstantStream input(22050, true, 1000, -2000, inFrames);
+
+		int16 buffer[256 * 2];
+		int total = 0, res;
+		do {
+			memset(buffer, 0, sizeof(buffer));
+			res = converter->flow(input, buffer, 256, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+			total += res;
+		} while (res == 256);
+
+		TS_ASSERT_EQUALS(total, inFrames * 2);
+		TS_ASSERT_EQUALS(converter->flow(input, buffer, 256, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 0);
+
+		delete converter;
+	}
+
+	void test_linear_constant() {
+		testConstant("linear", 22050, 48000, true, false);
+	}
+
+	void test_copy_constant() {
+		testConstant("linear", 22050, 22050, false, false);
+		testConstant("linear", 44100, 44100, true, true);
+	}
+
+	void test_flow_to_bus() {
+		testBus("linear", 22050, 22050, false, false);
+		testBus("linear", 44100, 44100, true, true);
+		testBus("linear", 11025, 22050, true, false);
+		testBus("linear", 22050, 48000, false, false);
+		testBus("sinc", 22050, 48000, true, true);
+		testBus("sinc", 44100, 22050, false, false);
+	}
+
+private:
+	static Audio::RateConverter *makeConverter(const char *resampler, int inRate, int outRate, bool stereo, bool reverseStereo) {
+		const Audio::ResamplerType type = strcmp(resampler, "sinc") ? Audio::kResamplerLinear : Audio::kResamplerSinc;
+		return Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo, type);
+	}
+
+	/**
+	 * Checks that mixing into the 32 bit bus yields exactly the same
+	 * samples as mixing into a silent 16 bit buffer.
+	 */
+	void testBus(const char *resampler, int inRate, int outRate, bool stereo, bool reverseStereo) {
+		const int inFrames = 4096;
+		const int outFrames = 1021;
+		const Audio::st_volume_t volL = 201, volR = 77;
+
+		Audio::RateConverter *converter = makeConverter(resampler, inRate, outRate, stereo, reverseStereo);
+		Audio::RateConverter *busConverter = makeConverter(resampler, inRate, outRate, stereo, reverseStereo);
+
+		ConstantStream input(inRate, stereo, 1001, -2003, inFrames);
+		ConstantStream busInput(inRate, stereo, 1001, -2003, inFrames);
+
+		int16 *buffer = new int16[outFrames * 2];
+		Audio::st_mix_t *bus = new Audio::st_mix_t[outFrames * 2];
+		memset(buffer, 0, outFrames * 2 * sizeof(int16));
+		memset(bus, 0, outFrames * 2 * sizeof(Audio::st_mix_t));
+
+		TS_ASSERT_EQUALS(converter->flow(input, buffer, outFrames, volL, volR), outFrames);
+		TS_ASSERT_EQUALS(busConverter->flowToBus(busInput, bus, outFrames, volL, volR), outFrames);
+
+		for (int i = 0; i < outFrames * 2; ++i)
+			TS_ASSERT_EQUALS(buffer[i], bus[i]);
+
+		delete[] bus;
+		delete[] buffer;
+		delete busConverter;
+		delete converter;
+	}
+
+	void testConstant(const char *resampler, int inRate, int outRate, bool stereo, bool reverseStereo) {
+		const int inFrames = 4096;
+		const int outFrames = 1024;
+		const int16 left = 1000, right = -2000;
+
+		Audio::RateConverter *converter = makeConverter(resampler, inRate, outRate, stereo, reverseStereo);
+
+		ConstantStream input(inRate, stereo, left, right, inFrames);
+		int16 *buffer = new int16[outFrames * 2];
+		memset(buffer, 0, outFrames * 2 * sizeof(int16));
+
+		// Full volume on both channels: the output must simply be the input
+		// signal, except for the filter warming up at the start.
+		TS_ASSERT_EQUALS(converter->flow(input, buffer, outFrames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outFrames);
+
+		const int16 expectedRight = stereo ? right : left;
+		for (int i = 32; i < outFrames; ++i) {
+			TS_ASSERT_DELTA(buffer[i * 2 + (reverseStereo ? 1 : 0)], left, 2);
+			TS_ASSERT_DELTA(buffer[i * 2 + (reverseStereo ? 0 : 1)], expectedRight, 2);
+		}
+
+		delete[] buffer;
+		delete converter;
+	}
+};
@@ -0,0 +1,122 @@
+#include "benchmark.h"
+
+#include "common/str.h"
+#include "common/util.h"
+#include "graphics/alpha_blit.h"
+#include "graphics/sse2.h"
+
+namespace {
+
+enum {
+	kScreenWidth = 800,
+	kScreenHeight = 600
+};
+
+/**
+ * A synthetic sprite, roughly like the images of Broken Sword 2.5: noisy
+ * colors, and an ellipse shaped outline whose edge is either cut hard or
+ * antialiased over a few pixels.
+ */
+struct Sprite {
+	int width, height;
+	uint32 *pixels;
+
+	Sprite(int w, int h, bool outline, bool antialiased, uint32 seed) : width(w), height(h) {
+		pixels = new uint32[w * h];
+
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				seed = seed * 1103515245 + 12345;
+				uint32 pix = 0x404040 + ((x * 64 / w) << 16) + ((y * 64 / h) << 8) + ((seed >> 16) & 0x3F3F3F);
+
+				int alpha = 255;
+				if (outline) {
+					// Distance from the ellipse edge, in about 1/16 pixels
+					const int dx = (2 * x + 1 - w) * 16 / w;
+					const int dy = (2 * y + 1 - h) * 16 / h;
+					const int dist = (256 - dx * dx - dy * dy) * MIN(w, h) / 512;
+					if (antialiased)
+						alpha = CLIP(dist * 64, 0, 255);
+					else
+						alpha = (dist > 0) ? 255 : 0;
+				}
+
+				pixels[y * w + x] = ((uint32)alpha << 24) | pix;
+			}
+		}
+	}
+
+	~Sprite() {
+		delete[] pixels;
+	}
+};
+
+/**
+ * Draws the sprite count times at positions spread over the screen, and
+ * reports the best of five runs.
+ */
+void runBlit(const char *name, const Sprite &sprite, int count, int mirror, uint32 color, bool detectAlpha, bool sse2) {
+	uint32 *screen = new uint32[kScreenWidth * kScreenHeight];
+	for (int i = 0; i < kScreenWidth * kScreenHeight; ++i)
+		screen[i] = 0xFF000000 | (i * 2654435761U >> 8);
+
+	const Graphics::AlphaType alphaType = detectAlpha ?
+		Graphics::getAlphaType((const byte *)sprite.pixels, sprite.width * 4, sprite.width, sprite.height) :
+		Graphics::kAlphaFull;
+
+	const bool haveSSE2 = Graphics::gUseSSE2;
+	Graphics::gUseSSE2 = sse2 && haveSSE2;
+
+	double best = 0;
+	for (int run = 0; run < 5; ++run) {
+		uint32 seed = 1;
+		const double start = getBenchmarkTime();
+		for (int i = 0; i < count; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const int x = (seed >> 8) % (kScreenWidth - sprite.width + 1);
+			const int y = (seed >> 16) % (kScreenHeight - sprite.height + 1);
+			Graphics::alphaBlit((byte *)&screen[y * kScreenWidth + x], kScreenWidth * 4,
+			                    (const byte *)sprite.pixels, sprite.width * 4,
+			                    sprite.width, sprite.height, mirror, color, alphaType);
+		}
+		const double time = getBenchmarkTime() - start;
+		if (run == 0 || time < best)
+			best = time;
+	}
+
+	const Common::String fullName = Common::String::format("blit: %s, %s%s", name,
+		detectAlpha ? "" : "full alpha, ", Graphics::gUseSSE2 ? "SSE2" : "C++");
+	Graphics::gUseSSE2 = haveSSE2;
+	reportBenchmark(fullName.c_str(), best, count, "blit");
+
+	delete[] screen;
+}
+
+/** Compare the plain code, the SSE2 code and the code for the alpha type. */
+void runBlits(const char *name, const Sprite &sprite, int count, int mirror, uint32 color) {
+	runBlit(name, sprite, count, mirror, color, false, false);
+	runBlit(name, sprite, count, mirror, color, false, true);
+	runBlit(name, sprite, count, mirror, color, true, false);
+	runBlit(name, sprite, count, mirror, color, true, true);
+}
+
+} // End of anonymous namespace
+
+void benchmarkAlphaBlit() {
+	// The backgrounds fill the screen
+	const Sprite background(kScreenWidth, kScreenHeight, false, false, 1);
+	runBlits("800x600 background", background, 50, 0, 0xFFFFFFFF);
+	runBlits("800x600 background, faded", background, 50, 0, 0x80FFFFFF);
+
+	// Objects and the hero, who is mirrored when walking to the left
+	const Sprite object(160, 120, true, false, 2);
+	runBlits("160x120 object, hard edge", object, 1000, 0, 0xFFFFFFFF);
+	const Sprite hero(180, 400, true, true, 3);
+	runBlits("180x400 hero", hero, 200, 0, 0xFFFFFFFF);
+	runBlits("180x400 hero, mirrored", hero, 200, Graphics::kBlitMirrorX, 0xFFFFFFFF);
+	runBlits("180x400 hero, shaded", hero, 200, 0, 0xFFC0B0A0);
+
+	// Antialiased glyphs of the subtitles
+	const Sprite glyph(14, 20, true, true, 4);
+	runBlits("14x20 glyph", glyph, 50000, 0, 0xFFFFFFFF);
+}
@@ -0,0 +1,31 @@
+#ifndef TEST_BENCHMARK_H
+#define TEST_BENCHMARK_H
+
+#include "common/scummsys.h"
+
+/**
+ * Returns the current time of a monotonic clock, in seconds.
+ */
+double getBenchmarkTime();
+
+/**
+ * Prints the result of a benchmark run: the time it took to process
+ * the given number of items, and the time per item.
+ *
+ * @param name    name of the benchmark
+ * @param seconds time spent, as measured with getBenchmarkTime()
+ * @param items   number of items (frames, lookups, ...) processed
+ * @param unit    name of a single item
+ */
+void reportBenchmark(const char *name, double seconds, uint32 items, const char *unit);
+
+// The benchmarks, see main.cpp
+void benchmarkRateConverters();
+void benchmarkMixer();
+void benchmarkHQx();
+void benchmarkHashMap();
+void benchmarkHuffman();
+void benchmarkYUVToRGB();
+void benchmarkAlphaBlit();
+
+#endif
@@ -0,0 +1,74 @@
+#include "benchmark.h"
+
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/str.h"
+
+namespace {
+
+/**
+ * Inserts, looks up and erases integer keys in the given map type, the
+ * way the SCI engine uses its object and address maps.
+ */
+template<class Map>
+void runIntMap(const char *name) {
+	const uint32 count = 20000;
+	const int rounds = 20;
+
+	uint32 *keys = new uint32[count];
+	uint32 seed = 1;
+	for (uint32 i = 0; i < count; ++i) {
+		seed = seed * 1103515245 + 12345;
+		keys[i] = seed >> 8;
+	}
+
+	double bestInsert = 0, bestLookup = 0, bestErase = 0;
+	uint32 found = 0;
+	for (int run = 0; run < 5; ++run) {
+		double insertTime = 0, lookupTime = 0, eraseTime = 0;
+		for (int round = 0; round < rounds; ++round) {
+			Map map;
+
+			double start = getBenchmarkTime();
+			for (uint32 i = 0; i < count; ++i)
+				map[keys[i]] = i;
+			insertTime += getBenchmarkTime() - start;
+
+			start = getBenchmarkTime();
+			for (uint32 i = 0; i < count; ++i) {
+				found += map.contains(keys[i]);
+				found += map.contains(keys[i] ^ 0x1000000);
+			}
+			lookupTime += getBenchmarkTime() - start;
+
+			start = getBenchmarkTime();
+			for (uint32 i = 0; i < count; ++i)
+				map.erase(keys[i]);
+			eraseTime += getBenchmarkTime() - start;
+		}
+
+		if (run == 0 || insertTime < bestInsert)
+			bestInsert = insertTime;
+		if (run == 0 || lookupTime < bestLookup)
+			bestLookup = lookupTime;
+		if (run == 0 || eraseTime < bestErase)
+			bestErase = eraseTime;
+	}
+
+	reportBenchmark(Common::String::format("hashmap: %s insert", name).c_str(), bestInsert, count * rounds, "insert");
+	reportBenchmark(Common::String::format("hashmap: %s lookup", name).c_str(), bestLookup, count * rounds * 2, "lookup");
+	reportBenchmark(Common::String::format("hashmap: %s erase", name).c_str(), bestErase, count * rounds, "erase");
+
+	// Keeps the lookups from being optimized away
+	if (found == 0)
+		reportBenchmark("hashmap: nothing found", 0, 1, "lookup");
+
+	delete[] keys;
+}
+
+} // End of anonymous namespace
+
+void benchmarkHashMap() {
+	runIntMap<Common::HashMap<uint32, uint32> >("HashMap");
+	runIntMap<Common::FlatHashMap<uint32, uint32> >("FlatHashMap");
+}
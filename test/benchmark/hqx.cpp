@@ -0,0 +1,74 @@
+#include "benchmark.h"
+
+#include "common/str.h"
+#include "graphics/scaler.h"
+#include "graphics/sse2.h"
+
+namespace {
+
+#ifdef USE_HQ_SCALERS
+/**
+ * Fills a 320x200 frame (plus border) with flat areas, dithering and
+ * gradients, roughly like a game screen.
+ */
+void fillFrame(uint16 *frame, int pitch, int width, int height) {
+	uint32 seed = 1;
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			seed = seed * 1103515245 + 12345;
+			uint16 pixel;
+			if (y < height / 3)
+				pixel = (uint16)((x / 40) * 0x1234);
+			else if (y < 2 * height / 3)
+				pixel = ((x + y) & 1) ? 0x7BEF : 0x39E7;
+			else if ((seed >> 16) % 8 == 0)
+				pixel = (uint16)(seed >> 8);
+			else
+				pixel = (uint16)(((x * 31 / width) << 11) | ((y & 63) << 5));
+			frame[y * pitch + x] = pixel;
+		}
+	}
+}
+
+void runScaler(const char *name, ScalerProc *scaler, int scale, bool sse2) {
+	const int width = 320, height = 200, pitch = width + 2;
+	const int frames = 200;
+
+	uint16 *src = new uint16[(height + 2) * pitch];
+	uint16 *dst = new uint16[width * scale * height * scale];
+	fillFrame(src, pitch, pitch, height + 2);
+
+	const bool haveSSE2 = Graphics::gUseSSE2;
+	Graphics::gUseSSE2 = sse2 && haveSSE2;
+
+	double best = 0;
+	for (int run = 0; run < 5; ++run) {
+		const double start = getBenchmarkTime();
+		for (int i = 0; i < frames; ++i)
+			scaler((const uint8 *)(src + pitch + 1), pitch * sizeof(uint16), (uint8 *)dst, width * scale * sizeof(uint16), width, height);
+		const double time = getBenchmarkTime() - start;
+		if (run == 0 || time < best)
+			best = time;
+	}
+
+	const Common::String fullName = Common::String::format("hqx: %s 320x200 %s", name, Graphics::gUseSSE2 ? "SSE2" : "C++");
+	reportBenchmark(fullName.c_str(), best, frames, "frame");
+
+	Graphics::gUseSSE2 = haveSSE2;
+	delete[] dst;
+	delete[] src;
+}
+#endif
+
+} // End of anonymous namespace
+
+void benchmarkHQx() {
+#ifdef USE_HQ_SCALERS
+	InitScalers(565);
+	runScaler("HQ2x", HQ2x, 2, false);
+	runScaler("HQ2x", HQ2x, 2, true);
+	runScaler("HQ3x", HQ3x, 3, false);
+	runScaler("HQ3x", HQ3x, 3, true);
+	DestroyScalers();
+#endif
+}
@@ -0,0 +1,198 @@
+#include "benchmark.h"
+
+#include "common/array.h"
+#include "common/bitstream.h"
+#include "common/huffman.h"
+#include "common/str.h"
+
+namespace {
+
+/**
+ * A synthetic Huffman code: optimal code lengths for random symbol
+ * weights, with canonical codes.
+ */
+struct CodeSet {
+	Common::Array<uint32> weights;
+	Common::Array<uint32> codes;
+	Common::Array<uint8> lengths;
+	uint8 maxLength;
+
+	CodeSet(uint32 count, uint32 weightRange, bool cubed, uint32 seed) {
+		weights.resize(count);
+		for (uint32 i = 0; i < count; ++i) {
+			seed = seed * 1103515245 + 12345;
+			uint32 w = (seed >> 8) % weightRange + 1;
+			weights[i] = cubed ? w * w * w : w;
+		}
+
+		buildLengths();
+		buildCodes();
+	}
+
+	/** Classic Huffman construction, merging the two lightest nodes. */
+	void buildLengths() {
+		const uint32 count = weights.size();
+		Common::Array<uint32> nodeWeight(weights);
+		Common::Array<int> parent;
+		Common::Array<bool> used;
+		parent.resize(2 * count);
+		used.resize(2 * count);
+		for (uint32 i = 0; i < 2 * count; ++i) {
+			parent[i] = -1;
+			used[i] = false;
+		}
+
+		for (uint32 merge = 0; merge + 1 < count; ++merge) {
+			int a = -1, b = -1;
+			for (uint32 i = 0; i < nodeWeight.size(); ++i) {
+				if (used[i])
+					continue;
+				if (a < 0 || nodeWeight[i] < nodeWeight[a]) {
+					b = a;
+					a = i;
+				} else if (b < 0 || nodeWeight[i] < nodeWeight[b]) {
+					b = i;
+				}
+			}
+
+			const int node = nodeWeight.size();
+			nodeWeight.push_back(nodeWeight[a] + nodeWeight[b]);
+			used[a] = used[b] = true;
+			parent[a] = parent[b] = node;
+		}
+
+		lengths.resize(count);
+		maxLength = 0;
+		for (uint32 i = 0; i < count; ++i) {
+			uint8 length = 0;
+			for (int node = i; parent[node] >= 0; node = parent[node])
+				++length;
+			lengths[i] = MAX<uint8>(length, 1);
+			maxLength = MAX(maxLength, lengths[i]);
+		}
+	}
+
+	void buildCodes() {
+		codes.resize(weights.size());
+		uint32 code = 0;
+		for (uint8 length = 1; length <= maxLength; ++length) {
+			for (uint32 i = 0; i < weights.size(); ++i)
+				if (lengths[i] == length)
+					codes[i] = code++;
+			code <<= 1;
+		}
+	}
+};
+
+uint32 reverseBits(uint32 value, uint8 count) {
+	uint32 result = 0;
+	for (uint8 i = 0; i < count; ++i)
+		result |= ((value >> i) & 1) << (count - 1 - i);
+	return result;
+}
+
+/** Returns the time it takes to decode the symbols from the given bit stream. */
+template<class BITSTREAM>
+double decodeSymbols(const Common::Huffman &huffman, BITSTREAM &bits, const uint32 *symbols, uint32 symbolCount, uint32 &errors) {
+	const double start = getBenchmarkTime();
+	for (uint32 i = 0; i < symbolCount; ++i)
+		errors += huffman.getSymbol(bits) != symbols[i];
+	return getBenchmarkTime() - start;
+}
+
+/**
+ * Decodes a stream of random symbols, drawn with the weights of the code
+ * set, through all bit stream types.
+ */
+void runCodeSet(const char *name, const CodeSet &set) {
+	const uint32 symbolCount = 200000;
+	const uint32 codeCount = set.weights.size();
+
+	uint32 totalWeight = 0;
+	for (uint32 i = 0; i < codeCount; ++i)
+		totalWeight += set.weights[i];
+
+	uint32 *symbols = new uint32[symbolCount];
+	uint32 seed = 1;
+	uint32 totalBits = 0;
+	for (uint32 i = 0; i < symbolCount; ++i) {
+		seed = seed * 1103515245 + 12345;
+		uint32 r = (seed >> 4) % totalWeight;
+		uint32 s = 0;
+		while (r >= set.weights[s])
+			r -= set.weights[s++];
+		symbols[i] = s;
+		totalBits += set.lengths[s];
+	}
+
+	// Room for a full 32 bit word of padding
+	const uint32 byteSize = ((totalBits + 31) / 32 + 1) * 4;
+	byte *dataBE = new byte[byteSize];
+	byte *dataLE = new byte[byteSize];
+	memset(dataBE, 0, byteSize);
+	memset(dataLE, 0, byteSize);
+
+	Common::Array<uint32> codesLE;
+	codesLE.resize(codeCount);
+	for (uint32 i = 0; i < codeCount; ++i)
+		codesLE[i] = reverseBits(set.codes[i], set.lengths[i]);
+
+	uint32 bitPos = 0;
+	for (uint32 i = 0; i < symbolCount; ++i) {
+		const uint32 code = set.codes[symbols[i]];
+		const uint8 length = set.lengths[symbols[i]];
+		for (uint8 j = 0; j < length; ++j, ++bitPos) {
+			if ((code >> (length - 1 - j)) & 1) {
+				dataBE[bitPos / 8] |= 0x80 >> (bitPos % 8);
+				dataLE[bitPos / 8] |= 1 << (bitPos % 8);
+			}
+		}
+	}
+
+	Common::Huffman huffmanBE(0, codeCount, &set.codes[0], &set.lengths[0]);
+	Common::Huffman huffmanLE(0, codeCount, &codesLE[0], &set.lengths[0]);
+
+	double best[4] = { 0, 0, 0, 0 };
+	uint32 errors = 0;
+	for (int run = 0; run < 5; ++run) {
+		double times[4];
+
+		Common::BitStreamBE bitsBE(dataBE, byteSize * 8);
+		times[0] = decodeSymbols(huffmanBE, bitsBE, symbols, symbolCount, errors);
+
+		Common::BitStream32LE bitsLE(dataLE, byteSize * 8);
+		times[1] = decodeSymbols(huffmanLE, bitsLE, symbols, symbolCount, errors);
+
+		Common::BitStreamMemoryMSB bitsMSB(dataBE, byteSize * 8);
+		times[2] = decodeSymbols(huffmanBE, bitsMSB, symbols, symbolCount, errors);
+
+		Common::BitStreamMemoryLSB bitsLSB(dataLE, byteSize * 8);
+		times[3] = decodeSymbols(huffmanLE, bitsLSB, symbols, symbolCount, errors);
+
+		for (int i = 0; i < 4; ++i)
+			if (run == 0 || times[i] < best[i])
+				best[i] = times[i];
+	}
+
+	reportBenchmark(Common::String::format("huffman: %s, BE", name).c_str(), best[0], symbolCount, "symbol");
+	reportBenchmark(Common::String::format("huffman: %s, 32LE", name).c_str(), best[1], symbolCount, "symbol");
+	reportBenchmark(Common::String::format("huffman: %s, memory MSB", name).c_str(), best[2], symbolCount, "symbol");
+	reportBenchmark(Common::String::format("huffman: %s, memory LSB", name).c_str(), best[3], symbolCount, "symbol");
+	if (errors)
+		reportBenchmark("huffman: decoding errors", 0, errors, "symbol");
+
+	delete[] dataLE;
+	delete[] dataBE;
+	delete[] symbols;
+}
+
+} // End of anonymous namespace
+
+void benchmarkHuffman() {
+	// Like the Bink codebooks
+	CodeSet small(16, 100, false, 1);
+	runCodeSet(Common::String::format("16 codes, max %d bits", small.maxLength).c_str(), small);
+
+	CodeSet large(256, 100, true, 2);
+	runCodeSet(Common::String::format("256 codes, max %d bits", large.maxLength).c_str(), large);
+}
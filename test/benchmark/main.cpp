@@ -0,0 +1,111 @@
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "benchmark.h"
+
+#include "common/list.h"
+#include "common/str.h"
+#include "common/system.h"
+#include "graphics/pixelformat.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#ifdef POSIX
+#include <sys/time.h>
+#endif
+
+double getBenchmarkTime() {
+#ifdef POSIX
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+void reportBenchmark(const char *name, double seconds, uint32 items, const char *unit) {
+	printf("%-48s %10u %-8s %9.3f ms %10.2f ns/%s\n", name, items, unit,
+	       seconds * 1000.0, seconds * 1000000000.0 / items, unit);
+}
+
+/**
+ * Minimal single threaded OSystem, for benchmarks of code which needs
+ * g_system for timing or mutexes.
+ */
+class BenchmarkSystem : public OSystem {
+public:
+	virtual const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return false; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(OverlayColor *buf, int pitch) {}
+	virtual void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale, const Graphics::PixelFormat *format) {}
+	virtual uint32 getMillis() { return (uint32)(getBenchmarkTime() * 1000); }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) { fputs(message, stdout); }
+};
+
+static const struct {
+	const char *name;
+	void (*run)();
+} benchmarks[] = {
+	{ "rate", benchmarkRateConverters },
+	{ "mixer", benchmarkMixer },
+	{ "hqx", benchmarkHQx },
+	{ "hashmap", benchmarkHashMap },
+	{ "huffman", benchmarkHuffman },
+	{ "yuv", benchmarkYUVToRGB },
+	{ "blit", benchmarkAlphaBlit },
+	{ 0, 0 }
+};
+
+/**
+ * Runs all benchmarks, or only those whose names are given on the
+ * command line.
+ */
+int main(int argc, char *argv[]) {
+	BenchmarkSystem system;
+	g_system = &system;
+
+	for (int i = 0; benchmarks[i].name; ++i) {
+		bool selected = (argc < 2);
+		for (int j = 1; j < argc; ++j)
+			selected |= !scumm_stricmp(argv[j], benchmarks[i].name);
+
+		if (selected)
+			benchmarks[i].run();
+	}
+
+	g_system = 0;
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "benchmark.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "common/system.h"
+#include "common/util.h"
+
+#include <math.h>
+
+namespace {
+
+/**
+ * Endless square wave. Loud enough that a few of them clip when mixed.
+ */
+class SquareStream : public Audio::AudioStream {
+public:
+	SquareStream(int rate, bool stereo, int period) : _rate(rate), _stereo(stereo), _period(period), _pos(0) {}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i, ++_pos)
+			buffer[i] = ((_pos / _period) & 1) ? 8000 : -8000;
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	int _rate;
+	bool _stereo;
+	int _period;
+	uint32 _pos;
+};
+
+void runMixer(uint outRate, int channels) {
+	// Five seconds of output, in the buffer size of the SDL backend
+	const uint32 chunk = 1024;
+	const uint32 frames = outRate * 5;
+
+	Audio::MixerImpl *mixer = new Audio::MixerImpl(g_system, outRate);
+	mixer->setReady(true);
+
+	// Mix of stereo/mono, matching/non-matching rates and volumes
+	static const int rates[] = { 22050, 11025, 44100, 48000 };
+	for (int i = 0; i < channels; ++i) {
+		Audio::AudioStream *stream = new SquareStream(rates[i % ARRAYSIZE(rates)], (i & 1) != 0, 50 + i);
+		((Audio::Mixer *)mixer)->playStream(Audio::Mixer::kSFXSoundType, 0, stream, -1, 128 + (i * 8) % 128, (i * 37) % 255 - 127);
+	}
+
+	byte *output = new byte[chunk * 4];
+
+	double best = 0;
+	for (int run = 0; run < 3; ++run) {
+		const double start = getBenchmarkTime();
+		for (uint32 done = 0; done < frames; done += chunk)
+			mixer->mixCallback(output, chunk * 4);
+		const double time = getBenchmarkTime() - start;
+		if (run == 0 || time < best)
+			best = time;
+	}
+
+	const Common::String name = Common::String::format("mixer: %d streams -> %d", channels, outRate);
+	reportBenchmark(name.c_str(), best, frames, "frame");
+
+	delete[] output;
+	delete mixer;
+}
+
+} // End of anonymous namespace
+
+void benchmarkMixer() {
+	static const int channels[] = { 1, 4, 8, 16 };
+
+	for (int i = 0; i < ARRAYSIZE(channels); ++i) {
+		runMixer(44100, channels[i]);
+		runMixer(48000, channels[i]);
+	}
+}
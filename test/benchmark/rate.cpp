@@ -0,0 +1,89 @@
+#include "benchmark.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include <math.h>
+
+namespace {
+
+/**
+ * Endless sine wave, so that the converters never run out of input.
+ */
+class SineStream : public Audio::AudioStream {
+public:
+	SineStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _pos(0) {
+		for (int i = 0; i < ARRAYSIZE(_table); ++i)
+			_table[i] = (int16)(sin(2 * M_PI * i / ARRAYSIZE(_table)) * 16000);
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i)
+			buffer[i] = _table[(_pos++ >> (_stereo ? 1 : 0)) % ARRAYSIZE(_table)];
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	int16 _table[100];
+	int _rate;
+	bool _stereo;
+	uint32 _pos;
+};
+
+void runConverter(const char *resampler, int inRate, int outRate, bool stereo) {
+	// Ten seconds of output, mixed in chunks like the mixer does
+	const uint32 chunk = 1024;
+	const uint32 frames = outRate * 10;
+
+	const Audio::ResamplerType type = strcmp(resampler, "sinc") ? Audio::kResamplerLinear : Audio::kResamplerSinc;
+
+	SineStream input(inRate, stereo);
+	Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, type);
+	int16 *output = new int16[chunk * 2];
+
+	// Report the best of a few runs to filter out noise
+	double best = 0;
+	for (int run = 0; run < 5; ++run) {
+		const double start = getBenchmarkTime();
+		for (uint32 done = 0; done < frames; done += chunk) {
+			memset(output, 0, chunk * 2 * sizeof(int16));
+			converter->flow(input, output, chunk, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		}
+		const double time = getBenchmarkTime() - start;
+		if (run == 0 || time < best)
+			best = time;
+	}
+
+	const Common::String name = Common::String::format("rate: %s %d->%d %s", resampler, inRate, outRate, stereo ? "stereo" : "mono");
+	reportBenchmark(name.c_str(), best, frames, "frame");
+
+	delete[] output;
+	delete converter;
+}
+
+} // End of anonymous namespace
+
+void benchmarkRateConverters() {
+	static const struct {
+		int inRate, outRate;
+	} rates[] = {
+		{ 22050, 48000 },
+		{ 11025, 44100 },
+		{ 44100, 22050 },
+		{ 48000, 44100 },
+		{ 44100, 44100 }
+	};
+
+	for (int i = 0; i < ARRAYSIZE(rates); ++i) {
+		for (int stereo = 0; stereo < 2; ++stereo) {
+			runConverter("linear", rates[i].inRate, rates[i].outRate, stereo != 0);
+			runConverter("sinc", rates[i].inRate, rates[i].outRate, stereo != 0);
+		}
+	}
+
+}
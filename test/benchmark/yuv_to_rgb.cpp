@@ -0,0 +1,72 @@
+#include "benchmark.h"
+
+#include "common/str.h"
+#include "graphics/pixelformat.h"
+#include "graphics/sse2.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+namespace {
+
+/**
+ * Fills a plane with smooth gradients and some noise, roughly like a
+ * decoded video frame.
+ */
+void fillPlane(byte *plane, int width, int height, uint32 seed) {
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			seed = seed * 1103515245 + 12345;
+			plane[y * width + x] = (byte)((x + y) / 4 + ((seed >> 16) & 15));
+		}
+	}
+}
+
+void runConversion(int width, int height, const Graphics::PixelFormat &format, bool sse2) {
+	const int frames = 100;
+
+	byte *y = new byte[width * height];
+	byte *u = new byte[width * height / 4];
+	byte *v = new byte[width * height / 4];
+	fillPlane(y, width, height, 1);
+	fillPlane(u, width / 2, height / 2, 2);
+	fillPlane(v, width / 2, height / 2, 3);
+
+	Graphics::Surface surface;
+	surface.create(width, height, format);
+
+	const bool haveSSE2 = Graphics::gUseSSE2;
+	Graphics::gUseSSE2 = sse2 && haveSSE2;
+
+	double best = 0;
+	for (int run = 0; run < 5; ++run) {
+		const double start = getBenchmarkTime();
+		for (int i = 0; i < frames; ++i)
+			Graphics::convertYUV420ToRGB(&surface, y, u, v, width, height, width, width / 2);
+		const double time = getBenchmarkTime() - start;
+		if (run == 0 || time < best)
+			best = time;
+	}
+
+	const Common::String name = Common::String::format("yuv: %dx%d to %d bit %s", width, height, format.bytesPerPixel * 8, Graphics::gUseSSE2 ? "SSE2" : "lookup");
+	Graphics::gUseSSE2 = haveSSE2;
+	reportBenchmark(name.c_str(), best, frames, "frame");
+
+	surface.free();
+	delete[] v;
+	delete[] u;
+	delete[] y;
+}
+
+} // End of anonymous namespace
+
+void benchmarkYUVToRGB() {
+	const Graphics::PixelFormat format16(2, 5, 6, 5, 0, 11, 5, 0, 0);
+	const Graphics::PixelFormat format32(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+	runConversion(640, 480, format16, false);
+	runConversion(640, 480, format16, true);
+	runConversion(640, 480, format32, false);
+	runConversion(640, 480, format32, true);
+	runConversion(1280, 720, format32, false);
+	runConversion(1280, 720, format32, true);
+}
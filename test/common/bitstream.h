@@ -0,0 +1,117 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitstream.h"
+#include "common/huffman.h"
+
+class BitStreamTestSuite : public CxxTest::TestSuite {
+	enum {
+		kDataSize = 64
+	};
+
+	byte _data[kDataSize];
+
+	void fillData() {
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kDataSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			_data[i] = seed >> 16;
+		}
+	}
+
+	/**
+	 * Run the same random mix of reads on both streams, up to the point
+	 * where the bits past the end would be reached.
+	 */
+	template<class REFERENCE, class MEMORY>
+	void compareStreams(REFERENCE &reference, MEMORY &memory) {
+		uint32 seed = 7;
+		while (true) {
+			seed = seed * 1103515245 + 12345;
+			const uint32 op = (seed >> 16) % 5;
+			const uint32 n = (seed >> 8) % 33;
+
+			if (reference.pos() + n > reference.size())
+				break;
+
+			switch (op) {
+			case 0:
+				TS_ASSERT_EQUALS(reference.getBit(), memory.getBit());
+				break;
+			case 1:
+				TS_ASSERT_EQUALS(reference.getBits(n), memory.getBits(n));
+				break;
+			case 2:
+				TS_ASSERT_EQUALS(reference.peekBits(n), memory.peekBits(n));
+				break;
+			case 3:
+				reference.skip(n);
+				memory.skip(n);
+				break;
+			case 4: {
+				uint32 x1 = seed, x2 = seed;
+				reference.addBit(x1, n % 32);
+				memory.addBit(x2, n % 32);
+				TS_ASSERT_EQUALS(x1, x2);
+				break;
+			}
+			}
+
+			TS_ASSERT_EQUALS(reference.pos(), memory.pos());
+		}
+
+		TS_ASSERT_EQUALS(reference.size(), memory.size());
+		TS_ASSERT_EQUALS(reference.isMSBFirst(), memory.isMSBFirst());
+	}
+
+	public:
+	void test_msb() {
+		fillData();
+
+		Common::BitStreamBE reference(_data, kDataSize * 8);
+		Common::BitStreamMemoryMSB memory(_data, kDataSize * 8);
+		compareStreams(reference, memory);
+	}
+
+	void test_lsb() {
+		fillData();
+
+		Common::BitStream32LE reference(_data, kDataSize * 8);
+		Common::BitStreamMemoryLSB memory(_data, kDataSize * 8);
+		compareStreams(reference, memory);
+	}
+
+	void test_past_end() {
+		const byte data[] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+		// Like the reference streams, the bits of one more byte or 32bit
+		// value can be read, and are 0.
+		Common::BitStreamMemoryMSB msb(data, 32);
+		msb.skip(32);
+		TS_ASSERT_EQUALS(msb.peekBits(16), (uint32)0);
+		TS_ASSERT_EQUALS(msb.getBits(8), (uint32)0);
+
+		Common::BitStreamMemoryLSB lsb(data, 32);
+		TS_ASSERT_EQUALS(lsb.peekBits(32), (uint32)0xFFFFFFFF);
+		lsb.skip(31);
+		TS_ASSERT_EQUALS(lsb.getBits(2), (uint32)1);
+		TS_ASSERT_EQUALS(lsb.getBits(31), (uint32)0);
+		TS_ASSERT_EQUALS(lsb.pos(), (uint32)64);
+	}
+
+	void test_huffman() {
+		const uint32 codes[] = { 0, 2, 6, 7 };
+		const uint8 lengths[] = { 1, 2, 3, 3 };
+		Common::Huffman huffman(0, 4, codes, lengths);
+
+		// 0 10 110 111 0, padded with zeros
+		const byte data[] = { 0x5B, 0x80 };
+		Common::BitStreamMemoryMSB bits(data, 16);
+
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)0);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)1);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)2);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)3);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)0);
+		TS_ASSERT_EQUALS(bits.pos(), (uint32)10);
+	}
+};
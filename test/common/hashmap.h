@@ -1,6 +1,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "common/hash-str.h"
 
 class HashMapTestSuite : public CxxTest::TestSuite
@@ -230,5 +231,124 @@ class HashMapTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(found == 16+8+4);
 }
 
+	void test_flat_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		TS_ASSERT_EQUALS(container.size(), 3u);
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		TS_ASSERT_EQUALS(container.size(), 2u);
+		container[1] = 42;
+		TS_ASSERT_EQUALS(container[1], 42);
+		container.erase(container.find(0));
+		container.erase(1);
+		container.erase(2);
+		TS_ASSERT(container.empty());
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+	}
+
+	void test_flat_lookup_with_default() {
+		Common::FlatHashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container;
+		container["foo"] = 17;
+		container.setVal("Bar", -1);
+
+		const Common::FlatHashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> &containerRef = container;
+		TS_ASSERT_EQUALS(containerRef.getVal("FOO"), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal("bar"), -1);
+		TS_ASSERT_EQUALS(containerRef.getVal("quux"), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal("quux", -10), -10);
+		TS_ASSERT_EQUALS(container.size(), 2u);
+	}
+
+	void test_flat_collision() {
+		// With the identity hash for integers, all of these would end up in
+		// the same slot without spreading the hash.
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 64; ++i)
+			h[i << 16] = i;
+		for (int i = 0; i < 64; i += 2)
+			h.erase(i << 16);
+		for (int i = 0; i < 64; ++i) {
+			TS_ASSERT_EQUALS(h.contains(i << 16), (i & 1) != 0);
+			TS_ASSERT_EQUALS(h.getVal(i << 16, -1), (i & 1) ? i : -1);
+		}
+	}
+
+	void test_flat_erase_while_iterating() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 100; ++i)
+			container[i] = i * 2;
+
+		// Erasing does not move other entries, so iterating can go on
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ++i) {
+			if (i->_key % 3)
+				container.erase(i);
+		}
+
+		int count = 0;
+		for (Common::FlatHashMap<int, int>::const_iterator i = container.begin(); i != container.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_key % 3, 0);
+			TS_ASSERT_EQUALS(i->_value, i->_key * 2);
+			count++;
+		}
+		TS_ASSERT_EQUALS(count, 34);
+		TS_ASSERT_EQUALS(container.size(), 34u);
+	}
+
+	void test_flat_copy_clear() {
+		Common::FlatHashMap<int, Common::String> map1;
+		for (int i = 0; i < 50; ++i)
+			map1[i] = Common::String::format("%d", i);
+		map1.erase(7);
+
+		Common::FlatHashMap<int, Common::String> map2(map1), map3;
+		map3 = map1;
+		map1.clear(true);
+		TS_ASSERT(map1.empty());
+		TS_ASSERT(!map1.contains(8));
+
+		TS_ASSERT_EQUALS(map2.size(), 49u);
+		TS_ASSERT_EQUALS(map3.size(), 49u);
+		TS_ASSERT(!map2.contains(7));
+		TS_ASSERT_EQUALS(map2[8], "8");
+		TS_ASSERT_EQUALS(map3[49], "49");
+	}
+
+	void test_flat_matches_hashmap() {
+		// Random inserts and erases, including many keys which are erased
+		// and added again, must give the same results as with HashMap.
+		Common::HashMap<uint, uint> reference;
+		Common::FlatHashMap<uint, uint> container;
+		uint32 seed = 1;
+
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 8) % 1500;
+
+			if ((seed >> 4) & 1) {
+				reference[key] = i;
+				container[key] = i;
+			} else {
+				reference.erase(key);
+				container.erase(key);
+			}
+
+			if ((i % 1000) == 0) {
+				TS_ASSERT_EQUALS(container.size(), reference.size());
+				for (uint k = 0; k < 1500; ++k)
+					TS_ASSERT_EQUALS(container.getVal(k, 0xFFFFFFFF), reference.getVal(k, 0xFFFFFFFF));
+			}
+		}
+
+		uint count = 0;
+		for (Common::FlatHashMap<uint, uint>::iterator i = container.begin(); i != container.end(); ++i, ++count)
+			TS_ASSERT_EQUALS(i->_value, reference[i->_key]);
+		TS_ASSERT_EQUALS(count, reference.size());
+	}
+
 	// TODO: Add test cases for iterators, find, ...
 };
@@ -0,0 +1,125 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/bitstream.h"
+#include "common/huffman.h"
+
+class HuffmanTestSuite : public CxxTest::TestSuite {
+	/**
+	 * Unary code: symbol i is coded as i ones followed by a zero, the last
+	 * symbol as ones only. The long codes need subtables.
+	 */
+	enum {
+		kUnaryCount = 20
+	};
+
+	uint32 _unaryCodes[kUnaryCount];
+	uint8 _unaryLengths[kUnaryCount];
+
+	void buildUnary() {
+		for (uint32 i = 0; i < kUnaryCount; i++) {
+			_unaryLengths[i] = (i == kUnaryCount - 1) ? i : i + 1;
+			_unaryCodes[i] = ((1 << i) - 1) << (_unaryLengths[i] - i);
+		}
+	}
+
+	/** Write the given symbols of the unary code, MSB or LSB first. */
+	static void writeUnary(byte *data, uint32 size, const uint32 *symbols, uint32 count, bool msbFirst) {
+		memset(data, 0, size);
+
+		uint32 pos = 0;
+		for (uint32 i = 0; i < count; i++) {
+			for (uint32 j = 0; j < symbols[i]; j++, pos++)
+				data[pos / 8] |= msbFirst ? (0x80 >> (pos % 8)) : (1 << (pos % 8));
+			if (symbols[i] != kUnaryCount - 1)
+				pos++;
+		}
+	}
+
+	public:
+	void test_short_codes() {
+		const uint32 codes[] = { 0, 2, 6, 7 };
+		const uint8 lengths[] = { 1, 2, 3, 3 };
+		const uint32 symbols[] = { 10, 20, 30, 40 };
+		Common::Huffman huffman(0, 4, codes, lengths, symbols);
+
+		// 0 10 110 111 0, padded with zeros
+		const byte data[] = { 0x5B, 0x80 };
+		Common::BitStreamBE bits(data, 16);
+
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)10);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)20);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)30);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)40);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)10);
+		TS_ASSERT_EQUALS(bits.pos(), (uint32)10);
+
+		huffman.setSymbols();
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)0);
+	}
+
+	void test_short_codes_le() {
+		// The codes of LSB first streams start with their lowest bit
+		const uint32 codes[] = { 0, 1, 3, 7 };
+		const uint8 lengths[] = { 1, 2, 3, 3 };
+		Common::Huffman huffman(0, 4, codes, lengths);
+
+		// 0 10 110 111 0, LSB first
+		const byte data[] = { 0xDA, 0x01, 0x00, 0x00 };
+		Common::BitStream32LE bits(data, 32);
+
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)0);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)1);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)2);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)3);
+		TS_ASSERT_EQUALS(huffman.getSymbol(bits), (uint32)0);
+		TS_ASSERT_EQUALS(bits.pos(), (uint32)10);
+	}
+
+	void test_long_codes() {
+		buildUnary();
+
+		const uint32 symbols[] = { 0, 19, 5, 9, 10, 18, 1, 12, 0, 17, 3 };
+		const uint32 count = ARRAYSIZE(symbols);
+		byte data[32];
+
+		Common::Huffman huffmanBE(0, kUnaryCount, _unaryCodes, _unaryLengths);
+		writeUnary(data, sizeof(data), symbols, count, true);
+		Common::BitStreamBE bitsBE(data, sizeof(data) * 8);
+		for (uint32 i = 0; i < count; i++)
+			TS_ASSERT_EQUALS(huffmanBE.getSymbol(bitsBE), symbols[i]);
+
+		// Reverse the codes for the LSB first stream
+		uint32 codesLE[kUnaryCount];
+		for (uint32 i = 0; i < kUnaryCount; i++) {
+			codesLE[i] = 0;
+			for (uint32 j = 0; j < _unaryLengths[i]; j++)
+				codesLE[i] |= ((_unaryCodes[i] >> j) & 1) << (_unaryLengths[i] - 1 - j);
+		}
+
+		Common::Huffman huffmanLE(0, kUnaryCount, codesLE, _unaryLengths);
+		writeUnary(data, sizeof(data), symbols, count, false);
+		Common::BitStream32LE bitsLE(data, sizeof(data) * 8);
+		for (uint32 i = 0; i < count; i++)
+			TS_ASSERT_EQUALS(huffmanLE.getSymbol(bitsLE), symbols[i]);
+	}
+
+	void test_peek_bits() {
+		const byte data[] = { 0x12, 0x34, 0x56, 0x78, 0x9A };
+
+		Common::BitStreamBE bitsBE(data, 40);
+		bitsBE.skip(4);
+		TS_ASSERT_EQUALS(bitsBE.peekBits(12), (uint32)0x234);
+		TS_ASSERT_EQUALS(bitsBE.peekBits(32), (uint32)0x23456789);
+		TS_ASSERT_EQUALS(bitsBE.getBits(12), (uint32)0x234);
+		bitsBE.skip(20);
+		// Past the end, zeros are read
+		TS_ASSERT_EQUALS(bitsBE.peekBits(8), (uint32)0xA0);
+
+		Common::BitStream32LE bitsLE(data, 32);
+		bitsLE.skip(4);
+		TS_ASSERT_EQUALS(bitsLE.peekBits(12), (uint32)0x341);
+		TS_ASSERT_EQUALS(bitsLE.peekBits(32), (uint32)0x07856341);
+		TS_ASSERT_EQUALS(bitsLE.getBits(12), (uint32)0x341);
+		TS_ASSERT_EQUALS(bitsLE.pos(), (uint32)16);
+	}
+};
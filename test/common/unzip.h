@@ -0,0 +1,268 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+/**
+ * A ZIP file with two members: "stored.bin", holding the bytes 0 to 31
+ * uncompressed, and "deflated.bin", holding 20000 bytes of pattern() data
+ * compressed with deflate.
+ */
+static const byte zipData[] = {
+		0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x3e, 0x8a, 0x7e,
+		0x26, 0x91, 0x20, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x73, 0x74,
+		0x6f, 0x72, 0x65, 0x64, 0x2e, 0x62, 0x69, 0x6e, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+		0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+		0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00,
+		0x08, 0x00, 0x00, 0x00, 0x21, 0x3e, 0x76, 0x4f, 0x43, 0xdb, 0xf4, 0x01, 0x00, 0x00, 0x20, 0x4e,
+		0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x64, 0x2e, 0x62,
+		0x69, 0x6e, 0xed, 0xdb, 0x57, 0x6e, 0x83, 0x00, 0x10, 0x84, 0x61, 0x6c, 0x83, 0xb1, 0x01, 0x83,
+		0x7b, 0xc5, 0xf4, 0x5e, 0x5d, 0x52, 0xee, 0x7f, 0xb3, 0x78, 0xa3, 0xac, 0xa2, 0x70, 0x84, 0xcd,
+		0xbc, 0x7f, 0x17, 0xf8, 0x35, 0x1a, 0x65, 0x34, 0x9e, 0xa8, 0xda, 0x54, 0x9f, 0xcd, 0x0d, 0xd3,
+		0x5a, 0xd8, 0xce, 0x72, 0xb5, 0xde, 0x6c, 0x77, 0xfb, 0xc3, 0xf1, 0x74, 0xbe, 0xb8, 0x57, 0xcf,
+		0x0f, 0xc2, 0x28, 0x4e, 0x14, 0x20, 0x20, 0x20, 0x89, 0xe8, 0x78, 0x39, 0x5f, 0x5d, 0xdf, 0x0b,
+		0x83, 0x38, 0x4a, 0x47, 0xca, 0x64, 0xac, 0xa9, 0xfa, 0x74, 0x3e, 0x33, 0x8d, 0x85, 0xe5, 0xd8,
+		0xab, 0xe5, 0x66, 0xbd, 0xdb, 0x1e, 0xf6, 0x27, 0x20, 0x20, 0x20, 0x91, 0xc8, 0xb1, 0x16, 0xeb,
+		0xcd, 0x72, 0xb5, 0x3f, 0x6c, 0x77, 0xe7, 0xcb, 0xf1, 0xe4, 0xf9, 0xee, 0x35, 0x8a, 0x83, 0x30,
+		0x1b, 0x4f, 0x94, 0xd1, 0x54, 0x57, 0x35, 0xc3, 0x9c, 0xcd, 0x6d, 0x20, 0x20, 0x20, 0x91, 0x68,
+		0x3c, 0x52, 0xf4, 0xa9, 0xa6, 0x9a, 0xc6, 0x7c, 0xe6, 0xd8, 0x0b, 0x6b, 0xb3, 0x5e, 0x2d, 0x0f,
+		0xfb, 0xdd, 0xf6, 0x72, 0x3e, 0x1d, 0x7d, 0xef, 0xea, 0xc6, 0x51, 0x18, 0xe4, 0x13, 0x20, 0x20,
+		0x20, 0x91, 0xc8, 0xf3, 0xa9, 0x13, 0x92, 0x34, 0xcb, 0x03, 0xea, 0x03, 0xea, 0x04, 0xea, 0x03,
+		0xea, 0x04, 0xea, 0x03, 0xea, 0x04, 0x8a, 0x08, 0x20, 0x20, 0x20, 0x81, 0xc8, 0x34, 0xa8, 0x0f,
+		0xa8, 0x13, 0xa8, 0x0f, 0xa8, 0x13, 0xd2, 0x24, 0xcf, 0x42, 0xea, 0x03, 0xea, 0x04, 0x8a, 0x08,
+		0xea, 0x04, 0x20, 0x20, 0x20, 0x81, 0x48, 0xd5, 0xa8, 0x13, 0xa8, 0x0f, 0xa8, 0x13, 0xa8, 0x0f,
+		0xa8, 0x13, 0xa8, 0x0f, 0xa8, 0x13, 0xb2, 0x3c, 0x49, 0x23, 0x8a, 0x08, 0x20, 0x20, 0x20, 0x81,
+		0xc8, 0xa5, 0x4e, 0xc8, 0xb3, 0x34, 0x89, 0xa9, 0x0f, 0xa8, 0x13, 0xa8, 0x0f, 0xa8, 0x13, 0xa8,
+		0x0f, 0xa8, 0x13, 0x28, 0x22, 0x80, 0x80, 0x80, 0x24, 0x22, 0x9d, 0x67, 0x42, 0x5e, 0x04, 0x8b,
+		0xb2, 0xaa, 0x1b, 0x9e, 0x09, 0x79, 0x36, 0x04, 0x02, 0x02, 0x92, 0x88, 0xbe, 0x67, 0x42, 0x5e,
+		0x04, 0x79, 0x26, 0xe4, 0xd9, 0xb0, 0x2c, 0xea, 0xaa, 0xe5, 0x2d, 0x11, 0x08, 0x08, 0x48, 0x1a,
+		0xa2, 0x14, 0xa8, 0xea, 0xa2, 0xec, 0x78, 0x26, 0xe4, 0xd9, 0x90, 0x67, 0x42, 0x9e, 0x0d, 0x81,
+		0x80, 0x80, 0xc4, 0x21, 0x9e, 0x09, 0x79, 0x11, 0xac, 0xab, 0xb2, 0xe8, 0x79, 0x26, 0xe4, 0xd9,
+		0x10, 0x08, 0x08, 0x48, 0x24, 0xa2, 0x4e, 0xe0, 0x45, 0x90, 0x67, 0x42, 0x9e, 0x0d, 0x9b, 0xb6,
+		0xeb, 0x0b, 0xde, 0x12, 0x81, 0x80, 0x80, 0xc4, 0xa1, 0x57, 0x02, 0xb4, 0x4d, 0xdf, 0x95, 0x3c,
+		0x13, 0xf2, 0x6c, 0xc8, 0x33, 0x21, 0xcf, 0x86, 0x40, 0x40, 0x40, 0xf2, 0xd0, 0xcf, 0x4c, 0xc8,
+		0x8b, 0x60, 0xd7, 0x37, 0x6d, 0xc5, 0x33, 0x21, 0xcf, 0x86, 0x1e, 0x10, 0x10, 0x90, 0x48, 0xf4,
+		0x4a, 0x00, 0x5e, 0x04, 0x79, 0x26, 0xe4, 0xd9, 0xb0, 0xef, 0xda, 0xa6, 0xe6, 0x2d, 0x11, 0x08,
+		0x08, 0x48, 0x1e, 0xb2, 0x9d, 0xdb, 0xfd, 0xf1, 0x7c, 0x1b, 0x9e, 0x86, 0x87, 0x7f, 0x61, 0x20,
+		0x20, 0x20, 0x81, 0xe8, 0xef, 0x5f, 0xf8, 0x7e, 0x7b, 0x3e, 0xde, 0x87, 0xa7, 0xe1, 0xe1, 0xa9,
+		0x18, 0x08, 0x08, 0x48, 0x08, 0xfa, 0xfd, 0x03, 0x0f, 0xff, 0xc2, 0x8f, 0xe7, 0xed, 0xfe, 0x31,
+		0x3c, 0x0d, 0x03, 0x01, 0x01, 0x09, 0x42, 0xd6, 0xf3, 0x71, 0xbf, 0x7d, 0x0e, 0x4f, 0xc3, 0xc3,
+		0xbf, 0x30, 0xd0, 0x7f, 0x45, 0x5f, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x21, 0x3e, 0x8a, 0x7e, 0x26, 0x91, 0x20, 0x00, 0x00, 0x00, 0x20, 0x00,
+		0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01,
+		0x00, 0x00, 0x00, 0x00, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x64, 0x2e, 0x62, 0x69, 0x6e, 0x50, 0x4b,
+		0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x3e, 0x76, 0x4f,
+		0x43, 0xdb, 0xf4, 0x01, 0x00, 0x00, 0x20, 0x4e, 0x00, 0x00, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x48, 0x00, 0x00, 0x00, 0x64, 0x65, 0x66, 0x6c,
+		0x61, 0x74, 0x65, 0x64, 0x2e, 0x62, 0x69, 0x6e, 0x50, 0x4b, 0x05, 0x06, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x02, 0x00, 0x72, 0x00, 0x00, 0x00, 0x66, 0x02, 0x00, 0x00, 0x00, 0x00,
+};
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+	static byte pattern(uint32 i) {
+		return (i % 37) ^ ((i >> 10) & 0xFF);
+	}
+
+	Common::Archive *openArchive() {
+		return Common::makeZipArchive(new Common::MemoryReadStream(zipData, sizeof(zipData)));
+	}
+
+	/**
+	 * Creates an archive with a single deflated member "large.bin" of the
+	 * given size, big enough to get restart points.
+	 */
+	Common::Archive *openLargeArchive(uint32 size) {
+		// Take the raw deflate data and the CRC out of a gzip stream
+		Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic();
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(gzip);
+		for (uint32 i = 0; i < size; ++i)
+			compressor->writeByte(pattern(i));
+		compressor->finalize();
+		TS_ASSERT(!compressor->err());
+
+		byte *gzipData = gzip->getData();
+		const uint32 gzipSize = gzip->size();
+		delete compressor;
+
+		const byte *compressed = gzipData + 10;
+		const uint32 compressedSize = gzipSize - 10 - 8;
+		const uint32 crc = READ_LE_UINT32(gzipData + gzipSize - 8);
+		TS_ASSERT_EQUALS(READ_LE_UINT32(gzipData + gzipSize - 4), size);
+
+		Common::MemoryWriteStreamDynamic zip;
+		zip.writeUint32LE(0x04034b50);	// local file header
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(8);	// deflated
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(crc);
+		zip.writeUint32LE(compressedSize);
+		zip.writeUint32LE(size);
+		zip.writeUint16LE(9);
+		zip.writeUint16LE(0);
+		zip.write("large.bin", 9);
+		zip.write(compressed, compressedSize);
+		free(gzipData);
+
+		const uint32 centralDir = zip.size();
+		zip.writeUint32LE(0x02014b50);	// central directory entry
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(8);	// deflated
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(crc);
+		zip.writeUint32LE(compressedSize);
+		zip.writeUint32LE(size);
+		zip.writeUint16LE(9);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(0);
+		zip.write("large.bin", 9);
+
+		const uint32 centralDirSize = zip.size() - centralDir;
+		zip.writeUint32LE(0x06054b50);	// end of central directory
+		zip.writeUint32LE(0);
+		zip.writeUint16LE(1);
+		zip.writeUint16LE(1);
+		zip.writeUint32LE(centralDirSize);
+		zip.writeUint32LE(centralDir);
+		zip.writeUint16LE(0);
+
+		return Common::makeZipArchive(new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES));
+	}
+
+	public:
+	void test_stored() {
+		Common::Archive *archive = openArchive();
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("stored.bin");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 32);
+
+		for (int i = 0; i < 32; ++i)
+			TS_ASSERT_EQUALS(stream->readByte(), i);
+		TS_ASSERT(!stream->eos());
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+
+		stream->seek(-4, SEEK_END);
+		TS_ASSERT_EQUALS(stream->readByte(), 28);
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_deflated() {
+		Common::Archive *archive = openArchive();
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("deflated.bin");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 20000);
+
+		byte buf[20000];
+		TS_ASSERT_EQUALS(stream->read(buf, sizeof(buf)), (uint32)sizeof(buf));
+		for (uint32 i = 0; i < sizeof(buf); ++i) {
+			if (buf[i] != pattern(i)) {
+				TS_ASSERT_EQUALS(buf[i], pattern(i));
+				break;
+			}
+		}
+		TS_ASSERT(!stream->err());
+		TS_ASSERT(!stream->eos());
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_deflated_seek() {
+		Common::Archive *archive = openArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("deflated.bin");
+		TS_ASSERT(stream);
+
+		// Forward
+		TS_ASSERT(stream->seek(12345));
+		TS_ASSERT_EQUALS(stream->pos(), 12345);
+		TS_ASSERT_EQUALS(stream->readByte(), pattern(12345));
+
+		// Backward
+		TS_ASSERT(stream->seek(100));
+		TS_ASSERT_EQUALS(stream->readByte(), pattern(100));
+
+		TS_ASSERT(stream->seek(-1, SEEK_END));
+		TS_ASSERT_EQUALS(stream->readByte(), pattern(19999));
+
+		TS_ASSERT(stream->seek(-20, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->readByte(), pattern(19980));
+
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_deflated_restart_points() {
+		const uint32 size = 1500 * 1024;
+		Common::Archive *archive = openLargeArchive(size);
+		TS_ASSERT(archive);
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("large.bin");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+
+		// Read everything once, which leaves restart points behind
+		byte buf[4096];
+		uint32 pos = 0;
+		while (pos < size) {
+			const uint32 readSize = stream->read(buf, sizeof(buf));
+			TS_ASSERT_EQUALS(readSize, MIN<uint32>(sizeof(buf), size - pos));
+			if (!readSize)
+				break;
+			pos += readSize;
+		}
+		TS_ASSERT(!stream->err());
+
+		const uint32 positions[] = { 1000000, 300000, 299999, 1400000, 5, size - 1, 600000 };
+		for (uint i = 0; i < ARRAYSIZE(positions); ++i) {
+			TS_ASSERT(stream->seek(positions[i]));
+			TS_ASSERT_EQUALS(stream->readByte(), pattern(positions[i]));
+		}
+
+		// The CRC is still checked when reading to the end after a restart
+		TS_ASSERT(stream->seek(700000));
+		while (stream->read(buf, sizeof(buf)) > 0)
+			;
+		TS_ASSERT(!stream->err());
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_independent_members() {
+		Common::Archive *archive = openArchive();
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.bin");
+		Common::SeekableReadStream *deflated1 = archive->createReadStreamForMember("deflated.bin");
+		Common::SeekableReadStream *deflated2 = archive->createReadStreamForMember("deflated.bin");
+
+		// Members stay readable after the archive is gone
+		delete archive;
+
+		deflated2->seek(5000);
+		for (uint32 i = 0; i < 32; ++i) {
+			TS_ASSERT_EQUALS(stored->readByte(), i);
+			TS_ASSERT_EQUALS(deflated1->readByte(), pattern(i));
+			TS_ASSERT_EQUALS(deflated2->readByte(), pattern(5000 + i));
+		}
+
+		delete stored;
+		delete deflated1;
+		delete deflated2;
+	}
+};
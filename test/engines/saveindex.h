@@ -0,0 +1,405 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+
+#include "engines/metaengine.h"
+#include "engines/saveindex.h"
+
+/**
+ * Savefile manager keeping the files in memory. Every write advances the
+ * modification time, so rewrites are always noticed.
+ */
+class IndexTestSaveFileManager : public Common::SaveFileManager {
+public:
+	typedef Common::Array<byte> Data;
+
+	IndexTestSaveFileManager() : _hasFileInfo(true), _infoQueries(0), _clock(0) {}
+
+	/** Whether getSavefileInfo() provides the size and time of files */
+	bool _hasFileInfo;
+	/** How often getSavefileInfo() was called */
+	int _infoQueries;
+
+	void setFile(const Common::String &name, const Data &data) {
+		File &file = _files[name];
+		file.data = data;
+		file.timestamp = ++_clock;
+	}
+
+	void setFile(const Common::String &name, const char *contents) {
+		Data data;
+		for (const char *c = contents; *c; ++c)
+			data.push_back(*c);
+		setFile(name, data);
+	}
+
+	Data &getData(const Common::String &name) { return _files[name].data; }
+
+	virtual Common::OutSaveFile *openForSaving(const Common::String &name) {
+		return new OutFile(this, name);
+	}
+
+	virtual Common::InSaveFile *openForLoading(const Common::String &name) {
+		if (!_files.contains(name))
+			return 0;
+
+		const Data &data = _files[name].data;
+		byte *copy = (byte *)malloc(data.size() + 1);
+		for (uint i = 0; i < data.size(); ++i)
+			copy[i] = data[i];
+		return new Common::MemoryReadStream(copy, data.size(), DisposeAfterUse::YES);
+	}
+
+	virtual bool removeSavefile(const Common::String &name) {
+		if (!_files.contains(name))
+			return false;
+		_files.erase(name);
+		return true;
+	}
+
+	virtual Common::StringArray listSavefiles(const Common::String &pattern) {
+		Common::StringArray names;
+		for (FileMap::const_iterator file = _files.begin(); file != _files.end(); ++file) {
+			if (file->_key.matchString(pattern))
+				names.push_back(file->_key);
+		}
+		return names;
+	}
+
+	virtual bool getSavefileInfo(const Common::String &name, uint32 &size, uint32 &timestamp) {
+		_infoQueries++;
+		if (!_hasFileInfo || !_files.contains(name))
+			return false;
+
+		size = _files[name].data.size();
+		timestamp = _files[name].timestamp;
+		return true;
+	}
+
+	virtual bool hasSavefileInfo() const { return _hasFileInfo; }
+
+private:
+	struct File {
+		Data data;
+		uint32 timestamp;
+	};
+
+	typedef Common::HashMap<Common::String, File> FileMap;
+
+	/** Stores its data in the manager when it is deleted. */
+	class OutFile : public Common::WriteStream {
+	public:
+		OutFile(IndexTestSaveFileManager *manager, const Common::String &name) : _manager(manager), _name(name) {}
+		~OutFile() { _manager->setFile(_name, _data); }
+
+		uint32 write(const void *dataPtr, uint32 dataSize) {
+			for (uint32 i = 0; i < dataSize; ++i)
+				_data.push_back(((const byte *)dataPtr)[i]);
+			return dataSize;
+		}
+
+	private:
+		IndexTestSaveFileManager *_manager;
+		Common::String _name;
+		Data _data;
+	};
+
+	FileMap _files;
+	uint32 _clock;
+};
+
+/**
+ * Minimal OSystem which only provides what the index needs: the savefile
+ * manager and the overlay format.
+ */
+class IndexTestSystem : public OSystem {
+public:
+	IndexTestSystem() {
+		_saveFileMan = new IndexTestSaveFileManager();
+		_savefileManager = _saveFileMan;
+	}
+
+	~IndexTestSystem() {
+		delete _savefileManager;
+		_savefileManager = 0;
+	}
+
+	IndexTestSaveFileManager *_saveFileMan;
+
+	virtual const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return false; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const byte *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(OverlayColor *buf, int pitch) {}
+	virtual void copyRectToOverlay(const OverlayColor *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const byte *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, int cursorTargetScale, const Graphics::PixelFormat *format) {}
+	virtual uint32 getMillis() { return 0; }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+};
+
+/**
+ * MetaEngine whose save files only hold the description. It derives the
+ * other meta infos from the slot number, and counts how often it is asked
+ * for them.
+ */
+class IndexTestMetaEngine : public MetaEngine {
+public:
+	IndexTestMetaEngine() : _queries(0), _thumbnailWidth(7) {}
+
+	mutable int _queries;
+	uint16 _thumbnailWidth;
+
+	virtual const char *getName() const { return "Index test"; }
+	virtual const char *getOriginalCopyright() const { return ""; }
+	virtual GameList getSupportedGames() const { return GameList(); }
+	virtual GameDescriptor findGame(const char *gameid) const { return GameDescriptor(); }
+	virtual GameList detectGames(const Common::FSList &fslist) const { return GameList(); }
+	virtual Common::Error createInstance(OSystem *syst, Engine **engine) const { return Common::kUnsupportedGameidError; }
+
+	virtual bool hasFeature(MetaEngineFeature f) const {
+		return f == kSupportsListSaves || f == kSavesSupportMetaInfo;
+	}
+
+	virtual int getMaximumSaveSlot() const { return 9; }
+
+	virtual Common::String getSavegameFile(const char *target, int slot) const {
+		return Common::String::format("%s.s%02d", target, slot);
+	}
+
+	virtual SaveStateDescriptor querySaveMetaInfos(const char *target, int slot) const {
+		_queries++;
+
+		Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(getSavegameFile(target, slot));
+		if (!in)
+			return SaveStateDescriptor();
+
+		Common::String description;
+		for (int32 i = 0; i < in->size(); ++i)
+			description += (char)in->readByte();
+		delete in;
+
+		SaveStateDescriptor desc(slot, description);
+		desc.setSaveDate(2011, 10, slot + 1);
+		desc.setSaveTime(12, slot);
+		desc.setPlayTime(slot * 60 * 60000 + 5 * 60000);
+		desc.setDeletableFlag(slot != 2);
+		desc.setWriteProtectedFlag(slot == 2);
+
+		Graphics::Surface *thumbnail = new Graphics::Surface();
+		thumbnail->create(_thumbnailWidth, 2, g_system->getOverlayFormat());
+		uint16 *pixels = (uint16 *)thumbnail->pixels;
+		for (int i = 0; i < _thumbnailWidth * 2; ++i)
+			pixels[i] = slot * 1000 + i;
+		desc.setThumbnail(thumbnail);
+
+		return desc;
+	}
+};
+
+class IndexTestPlugin : public EnginePlugin {
+public:
+	IndexTestPlugin(MetaEngine *metaEngine) {
+		_pluginObject = metaEngine;
+		_type = PLUGIN_TYPE_ENGINE;
+	}
+
+	virtual bool loadPlugin() { return true; }
+	virtual void unloadPlugin() {}
+};
+
+class SaveStateIndexTestSuite : public CxxTest::TestSuite
+{
+public:
+	void setUp() {
+		_oldSystem = g_system;
+		_system = new IndexTestSystem();
+		g_system = _system;
+		_metaEngine = new IndexTestMetaEngine();
+		_plugin = new IndexTestPlugin(_metaEngine);
+	}
+
+	void tearDown() {
+		g_system = _oldSystem;
+		delete _plugin;
+		delete _metaEngine;
+		delete _system;
+	}
+
+	void test_is_supported() {
+		TS_ASSERT(SaveStateIndex::isSupported(_plugin, "test"));
+		TS_ASSERT(!SaveStateIndex::isSupported(0, "test"));
+
+		_system->_saveFileMan->_hasFileInfo = false;
+		TS_ASSERT(!SaveStateIndex::isSupported(_plugin, "test"));
+	}
+
+	void test_only_existing_save_files_are_checked() {
+		_system->_saveFileMan->setFile("test.s01", "one");
+		_system->_saveFileMan->setFile("test.s07", "seven");
+
+		SaveStateIndex index(_plugin, "test");
+		TS_ASSERT_EQUALS(index.listSaves().size(), 2u);
+		TS_ASSERT_EQUALS(_system->_saveFileMan->_infoQueries, 2);
+
+		_system->_saveFileMan->removeSavefile("test.s07");
+		TS_ASSERT_EQUALS(index.listSaves().size(), 1u);
+		TS_ASSERT_EQUALS(_system->_saveFileMan->_infoQueries, 3);
+	}
+
+	void test_only_new_and_changed_saves_are_read() {
+		_system->_saveFileMan->setFile("test.s00", "one");
+		_system->_saveFileMan->setFile("test.s01", "two");
+		_system->_saveFileMan->setFile("test.s05", "three");
+
+		SaveStateList saves = SaveStateIndex(_plugin, "test").listSaves();
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 3);
+		TS_ASSERT_EQUALS(saves.size(), 3u);
+		TS_ASSERT_EQUALS(saves[2].getSaveSlot(), 5);
+		TS_ASSERT_EQUALS(saves[2].getDescription(), "three");
+
+		// A new index object reads everything from the index file
+		saves = SaveStateIndex(_plugin, "test").listSaves();
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 3);
+		TS_ASSERT_EQUALS(saves.size(), 3u);
+		TS_ASSERT_EQUALS(saves[1].getDescription(), "two");
+
+		_system->_saveFileMan->setFile("test.s01", "second");
+		_system->_saveFileMan->removeSavefile("test.s05");
+		saves = SaveStateIndex(_plugin, "test").listSaves();
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 4);
+		TS_ASSERT_EQUALS(saves.size(), 2u);
+		TS_ASSERT_EQUALS(saves[1].getDescription(), "second");
+	}
+
+	void test_meta_infos_are_restored() {
+		_system->_saveFileMan->setFile("test.s02", "two");
+		SaveStateIndex(_plugin, "test").listSaves();
+		const SaveStateDescriptor expected = _metaEngine->querySaveMetaInfos("test", 2);
+
+		SaveStateIndex index(_plugin, "test");
+		index.listSaves();
+		const SaveStateDescriptor desc = index.querySaveMetaInfos(2);
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 2);
+
+		TS_ASSERT_EQUALS(desc.getSaveSlot(), 2);
+		TS_ASSERT_EQUALS(desc.getDescription(), "two");
+		TS_ASSERT_EQUALS(desc.getSaveDate(), expected.getSaveDate());
+		TS_ASSERT_EQUALS(desc.getSaveTime(), expected.getSaveTime());
+		TS_ASSERT_EQUALS(desc.getPlayTime(), expected.getPlayTime());
+		TS_ASSERT(!desc.getDeletableFlag());
+		TS_ASSERT(desc.getWriteProtectedFlag());
+
+		const Graphics::Surface *thumbnail = desc.getThumbnail();
+		TS_ASSERT(thumbnail != 0);
+		if (thumbnail) {
+			TS_ASSERT_EQUALS(thumbnail->w, 7);
+			TS_ASSERT_EQUALS(thumbnail->h, 2);
+			TS_ASSERT(thumbnail->format == g_system->getOverlayFormat());
+			TS_ASSERT_EQUALS(memcmp(thumbnail->pixels, expected.getThumbnail()->pixels, 7 * 2 * 2), 0);
+		}
+	}
+
+	void test_damaged_thumbnail_rebuilds_index() {
+		_system->_saveFileMan->setFile("test.s00", "one");
+		SaveStateIndex(_plugin, "test").listSaves();
+
+		// Make the thumbnail of the entry huge
+		IndexTestSaveFileManager::Data &data = _system->_saveFileMan->getData("test.index");
+		bool found = false;
+		for (uint i = 0; i + 5 <= data.size() && !found; ++i) {
+			if (data[i] == 7 && data[i + 1] == 0 && data[i + 2] == 2 && data[i + 3] == 0 && data[i + 4] == 2) {
+				data[i] = data[i + 1] = 0xFF;
+				found = true;
+			}
+		}
+		TS_ASSERT(found);
+
+		SaveStateIndex index(_plugin, "test");
+		TS_ASSERT_EQUALS(index.listSaves().size(), 1u);
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 2);
+		TS_ASSERT_EQUALS(index.querySaveMetaInfos(0).getThumbnail()->w, 7);
+	}
+
+	void test_truncated_index_is_rebuilt() {
+		_system->_saveFileMan->setFile("test.s00", "one");
+		SaveStateIndex(_plugin, "test").listSaves();
+
+		IndexTestSaveFileManager::Data &data = _system->_saveFileMan->getData("test.index");
+		data.resize(data.size() - 10);
+
+		SaveStateIndex index(_plugin, "test");
+		TS_ASSERT_EQUALS(index.listSaves().size(), 1u);
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 2);
+		TS_ASSERT_EQUALS(index.querySaveMetaInfos(0).getDescription(), "one");
+	}
+
+	void test_failing_file_info_asks_the_engine() {
+		_system->_saveFileMan->_hasFileInfo = false;
+		_system->_saveFileMan->setFile("test.s00", "one");
+		_system->_saveFileMan->setFile("test.s03", "two");
+
+		SaveStateIndex index(_plugin, "test");
+		TS_ASSERT_EQUALS(index.listSaves().size(), 2u);
+		TS_ASSERT_EQUALS(index.listSaves().size(), 2u);
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 4);
+
+		_system->_saveFileMan->setFile("test.s03", "changed");
+		_system->_saveFileMan->removeSavefile("test.s00");
+		const SaveStateList saves = index.listSaves();
+		TS_ASSERT_EQUALS(saves.size(), 1u);
+		TS_ASSERT_EQUALS(saves[0].getDescription(), "changed");
+	}
+
+	void test_oversized_thumbnail_is_not_indexed() {
+		_metaEngine->_thumbnailWidth = 320;
+		_system->_saveFileMan->setFile("test.s00", "one");
+
+		SaveStateIndex(_plugin, "test").listSaves();
+		SaveStateIndex index(_plugin, "test");
+		index.listSaves();
+		TS_ASSERT_EQUALS(_metaEngine->_queries, 2);
+		TS_ASSERT_EQUALS(index.querySaveMetaInfos(0).getThumbnail()->w, 320);
+	}
+
+private:
+	IndexTestSystem *_system;
+	OSystem *_oldSystem;
+	IndexTestMetaEngine *_metaEngine;
+	IndexTestPlugin *_plugin;
+};
@@ -0,0 +1,164 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/alpha_blit.h"
+#include "graphics/sse2.h"
+
+/**
+ * Checks alphaBlit() against a straightforward implementation of the
+ * blending, for all alpha types and mirrorings, with and without SSE2.
+ */
+class AlphaBlitTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_alpha_type() {
+		uint32 pixels[kWidth * kHeight];
+
+		fillImage(pixels, Graphics::kAlphaOpaque, 1);
+		TS_ASSERT_EQUALS(getAlphaType(pixels), Graphics::kAlphaOpaque);
+		fillImage(pixels, Graphics::kAlphaBinary, 2);
+		TS_ASSERT_EQUALS(getAlphaType(pixels), Graphics::kAlphaBinary);
+		fillImage(pixels, Graphics::kAlphaFull, 3);
+		TS_ASSERT_EQUALS(getAlphaType(pixels), Graphics::kAlphaFull);
+
+		// Only the given area is looked at
+		fillImage(pixels, Graphics::kAlphaOpaque, 4);
+		pixels[kWidth * kHeight - 1] = 0x80808080;
+		TS_ASSERT_EQUALS(Graphics::getAlphaType((const byte *)pixels, kWidth * 4, kWidth, kHeight - 1), Graphics::kAlphaOpaque);
+	}
+
+	void test_opaque() {
+		testAlphaType(Graphics::kAlphaOpaque);
+	}
+
+	void test_binary() {
+		testAlphaType(Graphics::kAlphaBinary);
+	}
+
+	void test_full() {
+		testAlphaType(Graphics::kAlphaFull);
+	}
+
+private:
+	enum {
+		// Not a multiple of the four pixels the SSE2 code blends at once
+		kWidth = 23,
+		kHeight = 9,
+		kDstPitch = kWidth + 5
+	};
+
+	static uint32 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return (seed >> 16) | (seed << 16);
+	}
+
+	static void fillImage(uint32 *pixels, Graphics::AlphaType type, uint32 seed) {
+		for (int i = 0; i < kWidth * kHeight; ++i) {
+			uint32 pix = nextRandom(seed);
+			if (type == Graphics::kAlphaOpaque)
+				pix |= 0xFF000000;
+			else if (type == Graphics::kAlphaBinary)
+				pix = (pix & 0x01000000) ? pix | 0xFF000000 : pix & 0x00FFFFFF;
+			pixels[i] = pix;
+		}
+
+		// Include the extremes of the alpha and the components
+		pixels[0] = 0xFFFFFFFF;
+		pixels[1] = 0xFF000000;
+		if (type != Graphics::kAlphaOpaque)
+			pixels[2] = 0x00FFFFFF;
+		if (type == Graphics::kAlphaFull) {
+			pixels[3] = 0x01FFFFFF;
+			pixels[4] = 0xFE000000;
+		}
+	}
+
+	static Graphics::AlphaType getAlphaType(const uint32 *pixels) {
+		return Graphics::getAlphaType((const byte *)pixels, kWidth * 4, kWidth, kHeight);
+	}
+
+	static int blendChannel(int d, int s, int a, int c) {
+		if (c == 0)
+			return 0;
+		else if (c != 255)
+			return d + (((s - d) * a * c) >> 16);
+		else
+			return d + (((s - d) * a) >> 8);
+	}
+
+	/** Blend like alphaBlit(), one pixel at a time */
+	static void referenceBlit(uint32 *dst, const uint32 *src, int mirror, uint32 color) {
+		int ca = color >> 24;
+		int cr = (color >> 16) & 0xff;
+		int cg = (color >> 8) & 0xff;
+		int cb = color & 0xff;
+		if (ca == 0)
+			return;
+		if (ca != 255) {
+			cr = cr * ca >> 8;
+			cg = cg * ca >> 8;
+			cb = cb * ca >> 8;
+		}
+
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x) {
+				const int srcX = (mirror & Graphics::kBlitMirrorX) ? kWidth - 1 - x : x;
+				const int srcY = (mirror & Graphics::kBlitMirrorY) ? kHeight - 1 - y : y;
+				const uint32 pix = src[srcY * kWidth + srcX];
+				uint32 &out = dst[y * kDstPitch + x];
+
+				const int r = (pix >> 16) & 0xff;
+				const int g = (pix >> 8) & 0xff;
+				const int b = pix & 0xff;
+				int a = pix >> 24;
+				if (ca != 255)
+					a = a * ca >> 8;
+
+				if (a == 255) {
+					out = 0xFF000000 |
+					      ((cr != 255 ? (r * cr) >> 8 : r) << 16) |
+					      ((cg != 255 ? (g * cg) >> 8 : g) << 8) |
+					      (cb != 255 ? (b * cb) >> 8 : b);
+				} else if (a != 0) {
+					out = 0xFF000000 |
+					      (blendChannel((out >> 16) & 0xff, r, a, cr) << 16) |
+					      (blendChannel((out >> 8) & 0xff, g, a, cg) << 8) |
+					      blendChannel(out & 0xff, b, a, cb);
+				}
+			}
+		}
+	}
+
+	void testAlphaType(Graphics::AlphaType type) {
+		static const uint32 colors[] = {
+			0xFFFFFFFF, 0xFF808080, 0xFFFF0000, 0xFF00FF7F, 0x80FFFFFF, 0x7F20C0FF, 0x01FFFFFF, 0x00FFFFFF
+		};
+
+		uint32 src[kWidth * kHeight];
+		uint32 background[kDstPitch * kHeight];
+		uint32 expected[kDstPitch * kHeight];
+		uint32 result[kDstPitch * kHeight];
+
+		fillImage(src, type, 5);
+		uint32 seed = 6;
+		for (int i = 0; i < kDstPitch * kHeight; ++i)
+			background[i] = nextRandom(seed);
+
+		for (int c = 0; c < ARRAYSIZE(colors); ++c) {
+			for (int mirror = 0; mirror < 4; ++mirror) {
+				memcpy(expected, background, sizeof(background));
+				referenceBlit(expected, src, mirror, colors[c]);
+
+				for (int sse2 = 0; sse2 < 2; ++sse2) {
+					memcpy(result, background, sizeof(background));
+					const bool haveSSE2 = Graphics::gUseSSE2;
+					Graphics::gUseSSE2 = sse2 && haveSSE2;
+					Graphics::alphaBlit((byte *)result, kDstPitch * 4, (const byte *)src, kWidth * 4,
+					                    kWidth, kHeight, mirror, colors[c], type);
+					Graphics::gUseSSE2 = haveSSE2;
+
+					TS_ASSERT_EQUALS(memcmp(expected, result, sizeof(result)), 0);
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,110 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/sse2.h"
+
+/**
+ * Checks that the SSE2 code paths of the HQ scalers produce exactly the
+ * same output as the plain C++ code.
+ */
+class HQxTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_hq2x_random() {
+		testScaler(HQ2x, 2, 565, kRandomFrame);
+		testScaler(HQ2x, 2, 555, kRandomFrame);
+	}
+
+	void test_hq2x_game_frame() {
+		testScaler(HQ2x, 2, 565, kGameFrame);
+		testScaler(HQ2x, 2, 555, kGameFrame);
+	}
+
+	void test_hq3x_random() {
+		testScaler(HQ3x, 3, 565, kRandomFrame);
+		testScaler(HQ3x, 3, 555, kRandomFrame);
+	}
+
+	void test_hq3x_game_frame() {
+		testScaler(HQ3x, 3, 565, kGameFrame);
+		testScaler(HQ3x, 3, 555, kGameFrame);
+	}
+
+private:
+	enum FrameType {
+		kRandomFrame,
+		kGameFrame
+	};
+
+	enum {
+		// Odd sizes, to cover the rows which are not a multiple of the
+		// SSE2 block size.
+		kWidth = 157,
+		kHeight = 101,
+		kSrcPitch = kWidth + 2
+	};
+
+	static uint16 nextRandom(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return (uint16)(seed >> 16);
+	}
+
+	/**
+	 * Fills the frame, including its one pixel border. Game frames
+	 * consist of flat areas and gradients drawn from a small palette,
+	 * plus some dithering, which is where most HQ patterns come from.
+	 */
+	static void fillFrame(uint16 *frame, FrameType type, uint32 seed) {
+		uint16 palette[16];
+		for (int i = 0; i < 16; ++i)
+			palette[i] = nextRandom(seed);
+
+		for (int y = 0; y < kHeight + 2; ++y) {
+			for (int x = 0; x < kSrcPitch; ++x) {
+				uint16 &pixel = frame[y * kSrcPitch + x];
+				if (type == kRandomFrame)
+					pixel = nextRandom(seed);
+				else if (y < 30)
+					pixel = palette[(x / 20) & 15];
+				else if (y < 60)
+					pixel = palette[((x + y) & 1) ? 3 : 9];
+				else
+					pixel = (uint16)(((x * 31 / kSrcPitch) << 11) | ((y & 63) << 5) | (x & 31));
+			}
+		}
+	}
+
+	void testScaler(ScalerProc *scaler, int scale, int bitFormat, FrameType type) {
+#ifdef USE_HQ_SCALERS
+		InitScalers(bitFormat);
+		const bool haveSSE2 = Graphics::gUseSSE2;
+
+		uint16 *src = new uint16[(kHeight + 2) * kSrcPitch];
+		uint16 *expected = new uint16[kWidth * scale * kHeight * scale];
+		uint16 *result = new uint16[kWidth * scale * kHeight * scale];
+
+		fillFrame(src, type, bitFormat + type);
+
+		const uint8 *srcPtr = (const uint8 *)(src + kSrcPitch + 1);
+		const uint32 dstPitch = kWidth * scale * sizeof(uint16);
+
+		Graphics::gUseSSE2 = false;
+		scaler(srcPtr, kSrcPitch * sizeof(uint16), (uint8 *)expected, dstPitch, kWidth, kHeight);
+
+		Graphics::gUseSSE2 = haveSSE2;
+		scaler(srcPtr, kSrcPitch * sizeof(uint16), (uint8 *)result, dstPitch, kWidth, kHeight);
+
+		for (int i = 0; i < kWidth * scale * kHeight * scale; ++i) {
+			if (expected[i] != result[i]) {
+				TS_ASSERT_EQUALS(expected[i], result[i]);
+				break;
+			}
+		}
+
+		delete[] result;
+		delete[] expected;
+		delete[] src;
+		DestroyScalers();
+#endif
+	}
+};
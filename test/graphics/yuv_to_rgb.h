@@ -0,0 +1,80 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/sse2.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+/**
+ * Checks that the SSE2 code path of the YUV420 conversion produces exactly
+ * the same output as the lookup tables.
+ */
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_16bit() {
+		testFormat(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		testFormat(Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
+		testFormat(Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0));
+	}
+
+	void test_32bit() {
+		testFormat(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+		testFormat(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+		testFormat(Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0));
+		// Components which are not whole bytes
+		testFormat(Graphics::PixelFormat(4, 5, 6, 5, 0, 21, 10, 0, 0));
+	}
+
+private:
+	enum {
+		// Not a multiple of the sixteen pixels the SSE2 code converts at once
+		kWidth = 78,
+		kHeight = 22,
+		kYPitch = kWidth + 6,
+		kUVPitch = kWidth / 2 + 5
+	};
+
+	static void fillPlane(byte *plane, int size, uint32 seed) {
+		for (int i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			plane[i] = (byte)(seed >> 16);
+		}
+
+		// Include the extremes, which need clamping
+		plane[0] = 0;
+		plane[1] = 255;
+	}
+
+	static void convert(Graphics::Surface &surface, const byte *y, const byte *u, const byte *v, bool sse2) {
+		memset(surface.pixels, 0, surface.pitch * surface.h);
+		const bool haveSSE2 = Graphics::gUseSSE2;
+		Graphics::gUseSSE2 = sse2 && haveSSE2;
+		Graphics::convertYUV420ToRGB(&surface, y, u, v, kWidth, kHeight, kYPitch, kUVPitch);
+		Graphics::gUseSSE2 = haveSSE2;
+	}
+
+	void testFormat(const Graphics::PixelFormat &format) {
+		byte *y = new byte[kYPitch * kHeight];
+		byte *u = new byte[kUVPitch * kHeight / 2];
+		byte *v = new byte[kUVPitch * kHeight / 2];
+		fillPlane(y, kYPitch * kHeight, 1);
+		fillPlane(u, kUVPitch * kHeight / 2, 2);
+		fillPlane(v, kUVPitch * kHeight / 2, 3);
+
+		Graphics::Surface expected, result;
+		expected.create(kWidth, kHeight, format);
+		result.create(kWidth, kHeight, format);
+
+		convert(expected, y, u, v, false);
+		convert(result, y, u, v, true);
+
+		TS_ASSERT_EQUALS(memcmp(expected.pixels, result.pixels, expected.pitch * kHeight), 0);
+
+		result.free();
+		expected.free();
+		delete[] v;
+		delete[] u;
+		delete[] y;
+	}
+};
@@ -5,8 +5,8 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/engines/*.h
+TEST_LIBS    := engines/libengines.a backends/libbackends.a audio/libaudio.a graphics/libgraphics.a common/libcommon.a
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh
@@ -34,9 +34,25 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+######################################################################
+# Micro benchmarks.
+# Use the 'benchmark' target to run them all, or run
+# test/benchmark/runner with the names of the benchmarks to run.
+# New benchmarks have to be added to test/benchmark/main.cpp.
+######################################################################
+
+BENCHMARKS      := $(wildcard $(srcdir)/test/benchmark/*.cpp)
+BENCHMARK_LIBS  := audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+
+benchmark: test/benchmark/runner
+	./test/benchmark/runner
+test/benchmark/runner: $(BENCHMARKS) $(BENCHMARK_LIBS)
+	@mkdir -p test/benchmark
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark/runner
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
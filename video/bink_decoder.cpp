@@ -205,7 +205,7 @@ const Graphics::Surface *BinkDecoder::decodeNextFrame() {
 				//                  Number of samples in bytes
 				audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
 
-				audio.bits = new Common::BitStream32LE(*_bink, (audioPacketLength - 4) * 8);
+				audio.bits = new Common::BitStreamMemoryLSB(*_bink, (audioPacketLength - 4) * 8);
 
 				audioPacket(audio);
 
@@ -220,7 +220,7 @@ const Graphics::Surface *BinkDecoder::decodeNextFrame() {
 		}
 	}
 
-	frame.bits = new Common::BitStream32LE(*_bink, frameSize * 8);
+	frame.bits = new Common::BitStreamMemoryLSB(*_bink, frameSize * 8);
 
 	videoPacket(frame);
 
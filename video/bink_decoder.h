@@ -34,13 +34,13 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h"
 #include "common/array.h"
+#include "common/bitstream.h"
 #include "common/rational.h"
 
 #include "video/video_decoder.h"
 
 namespace Common {
 	class SeekableReadStream;
-	class BitStream;
 	class Huffman;
 
 	class RDFT;
@@ -146,7 +146,7 @@ private:
 
 		uint32 sampleCount;
 
-		Common::BitStream *bits;
+		Common::BitStreamMemoryLSB *bits;
 
 		bool first;
 
@@ -179,7 +179,7 @@ private:
 		uint32 offset;
 		uint32 size;
 
-		Common::BitStream *bits;
+		Common::BitStreamMemoryLSB *bits;
 
 		VideoFrame();
 		~VideoFrame();